@@ -17,10 +17,66 @@
 #define RESET_GPIO_PIN   DT_GPIO_PIN(RESET_NODE, gpios)
 #define RESET_GPIO_FLAGS DT_GPIO_FLAGS(RESET_NODE, gpios)
 
+/* The line is drained once nothing was received for DRAIN_QUIET_US, or after
+ * DRAIN_TIMEOUT_MS at most. At 1 Mbaud the quiet time is about 200 bytes.
+ */
+#define DRAIN_QUIET_US   2000
+#define DRAIN_TIMEOUT_MS 50
+#define DRAIN_CHUNK      32
+
+static K_SEM_DEFINE(drain_activity, 0, 1);
+static size_t drained;
+
+/* With CONFIG_UART_ASYNC_TO_INT_DRIVEN_API the interrupt driven API used by
+ * H4 runs on top of EasyDMA double buffering, so this is called once per
+ * received buffer rather than once per byte.
+ */
+static void drain_isr(const struct device *h4, void *user_data)
+{
+	uint8_t buf[DRAIN_CHUNK];
+	int len;
+
+	ARG_UNUSED(user_data);
+
+	while (uart_irq_update(h4) && uart_irq_rx_ready(h4)) {
+		len = uart_fifo_read(h4, buf, sizeof(buf));
+		if (len <= 0) {
+			break;
+		}
+		drained += len;
+		k_sem_give(&drain_activity);
+	}
+}
+
+static int drain(const struct device *h4)
+{
+	int64_t deadline = k_uptime_get() + DRAIN_TIMEOUT_MS;
+	int err;
+
+	drained = 0;
+	k_sem_reset(&drain_activity);
+	err = uart_irq_callback_user_data_set(h4, drain_isr, NULL);
+	if (err) {
+		return err;
+	}
+	uart_irq_rx_enable(h4);
+
+	/* Wait for the line to go quiet instead of sleeping a fixed time. */
+	while (k_sem_take(&drain_activity, K_USEC(DRAIN_QUIET_US)) == 0) {
+		if (k_uptime_get() >= deadline) {
+			err = -ETIMEDOUT;
+			break;
+		}
+	}
+
+	uart_irq_rx_disable(h4);
+	(void)uart_irq_callback_user_data_set(h4, NULL, NULL);
+	return err;
+}
+
 int bt_hci_transport_setup(const struct device *h4)
 {
 	int err;
-	char c;
 	const struct device *port = DEVICE_DT_GET(RESET_GPIO_CTRL);
 
 	if (!device_is_ready(port)) {
@@ -45,14 +101,18 @@ int bt_hci_transport_setup(const struct device *h4)
 
 	/* Wait for the nRF52840 peripheral to stop sending data.
 	 *
-	 * It is critical (!) to wait here, so that all bytes
-	 * on the lines are received and drained correctly.
+	 * It is critical (!) to drain here, so that all bytes
+	 * on the lines are received and discarded before H4 starts.
 	 */
-	k_sleep(K_MSEC(10));
-
-	/* Drain bytes */
-	while (uart_fifo_read(h4, &c, 1)) {
-		continue;
+	err = drain(h4);
+	if (err == -ETIMEDOUT) {
+		/* The nRF52840 kept sending while held in reset, the line is
+		 * noisy. Go on, H4 resynchronizes on the next packet.
+		 */
+		err = 0;
+	}
+	if (err) {
+		return err;
 	}
 
 	/* We are ready, let the nRF52840 run to main */
@@ -0,0 +1,360 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Emulator of the ADXL362 accelerometer for the upstream adi,adxl362 driver.
+ *
+ * Models the register file, the activity/inactivity detection and the INT1
+ * line, so motion handling can run on native_sim. The activity timer is not
+ * modelled: activity is reported on the first sample above the threshold.
+ * Detection always follows the linked/loop state machine, looking for
+ * activity while asleep and for inactivity while awake.
+ */
+
+#define DT_DRV_COMPAT adi_adxl362
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+#include "our_drivers/emul_adxl362.h"
+
+LOG_MODULE_REGISTER(emul_adxl362, CONFIG_SENSOR_LOG_LEVEL);
+
+#define ADXL362_CMD_WRITE_REG       0x0A
+#define ADXL362_CMD_READ_REG        0x0B
+
+#define ADXL362_REG_DEVID_AD        0x00
+#define ADXL362_REG_DEVID_MST       0x01
+#define ADXL362_REG_PARTID          0x02
+#define ADXL362_REG_REVID           0x03
+#define ADXL362_REG_STATUS          0x0B
+#define ADXL362_REG_XDATA_L         0x0E
+#define ADXL362_REG_SOFT_RESET      0x1F
+#define ADXL362_REG_THRESH_ACT_L    0x20
+#define ADXL362_REG_THRESH_INACT_L  0x23
+#define ADXL362_REG_TIME_INACT_L    0x25
+#define ADXL362_REG_ACT_INACT_CTL   0x27
+#define ADXL362_REG_INTMAP1         0x2A
+#define ADXL362_REG_FILTER_CTL      0x2C
+#define ADXL362_REG_POWER_CTL       0x2D
+#define ADXL362_REG_COUNT           0x2F
+
+#define ADXL362_STATUS_DATA_READY   BIT(0)
+#define ADXL362_STATUS_ACT          BIT(4)
+#define ADXL362_STATUS_INACT        BIT(5)
+#define ADXL362_STATUS_AWAKE        BIT(6)
+
+#define ADXL362_ACT_INACT_CTL_ACT_EN    BIT(0)
+#define ADXL362_ACT_INACT_CTL_ACT_REF   BIT(1)
+#define ADXL362_ACT_INACT_CTL_INACT_EN  BIT(2)
+#define ADXL362_ACT_INACT_CTL_INACT_REF BIT(3)
+
+#define ADXL362_INTMAP_INT_LOW      BIT(7)
+#define ADXL362_RESET_KEY           0x52
+#define ADXL362_AXES                3
+
+struct adxl362_emul_cfg {
+	struct gpio_dt_spec int1;
+};
+
+struct adxl362_emul_data {
+	const struct adxl362_emul_cfg *cfg;
+	struct k_mutex lock;
+	struct k_work_delayable inactivity_work;
+	uint8_t regs[ADXL362_REG_COUNT];
+	int16_t accel[ADXL362_AXES];     /* LSB of the current range */
+	int16_t reference[ADXL362_AXES]; /* sample at the last state change */
+	bool inactivity_pending;
+};
+
+static void adxl362_emul_reset(struct adxl362_emul_data *data)
+{
+	memset(data->regs, 0, sizeof(data->regs));
+	data->regs[ADXL362_REG_DEVID_AD] = 0xAD;
+	data->regs[ADXL362_REG_DEVID_MST] = 0x1D;
+	data->regs[ADXL362_REG_PARTID] = 0xF2;
+	data->regs[ADXL362_REG_REVID] = 0x01;
+	data->regs[ADXL362_REG_STATUS] = ADXL362_STATUS_AWAKE | ADXL362_STATUS_DATA_READY;
+	data->regs[ADXL362_REG_FILTER_CTL] = 0x13;
+	data->inactivity_pending = false;
+	(void)k_work_cancel_delayable(&data->inactivity_work);
+}
+
+static uint16_t adxl362_emul_reg16(const struct adxl362_emul_data *data, uint8_t reg, uint16_t mask)
+{
+	return sys_get_le16(&data->regs[reg]) & mask;
+}
+
+/* Drive INT1 from the status bits mapped to it. Called with the lock held. */
+static bool adxl362_emul_int1_level(const struct adxl362_emul_data *data)
+{
+	uint8_t intmap = data->regs[ADXL362_REG_INTMAP1];
+	bool asserted = (data->regs[ADXL362_REG_STATUS] & intmap & ~ADXL362_INTMAP_INT_LOW &
+			 (ADXL362_STATUS_ACT | ADXL362_STATUS_INACT | ADXL362_STATUS_AWAKE)) != 0;
+
+	return asserted != ((intmap & ADXL362_INTMAP_INT_LOW) != 0);
+}
+
+static void adxl362_emul_update_int1(struct adxl362_emul_data *data, bool level)
+{
+	if (data->cfg->int1.port != NULL) {
+		(void)gpio_emul_input_set(data->cfg->int1.port, data->cfg->int1.pin, level);
+	}
+}
+
+/* Largest per-axis deviation, from the reference sample in referenced mode. */
+static uint16_t adxl362_emul_deviation(const struct adxl362_emul_data *data, bool referenced)
+{
+	uint16_t deviation = 0;
+
+	for (int axis = 0; axis < ADXL362_AXES; axis++) {
+		int32_t value = data->accel[axis];
+
+		if (referenced) {
+			value -= data->reference[axis];
+		}
+		deviation = MAX(deviation, (uint16_t)abs(value));
+	}
+	return deviation;
+}
+
+static uint32_t adxl362_emul_sample_period_us(const struct adxl362_emul_data *data)
+{
+	/* ODR field 0 is 12.5 Hz, every step doubles the rate. */
+	return 80000U >> MIN(data->regs[ADXL362_REG_FILTER_CTL] & 0x07, 5);
+}
+
+/* Run the detection state machine on the current sample. Called with the lock held. */
+static void adxl362_emul_evaluate(struct adxl362_emul_data *data)
+{
+	uint8_t ctl = data->regs[ADXL362_REG_ACT_INACT_CTL];
+	uint8_t *status = &data->regs[ADXL362_REG_STATUS];
+
+	if (!(*status & ADXL362_STATUS_AWAKE)) {
+		uint16_t threshold = adxl362_emul_reg16(data, ADXL362_REG_THRESH_ACT_L, 0x7FF);
+
+		if ((ctl & ADXL362_ACT_INACT_CTL_ACT_EN) &&
+		    adxl362_emul_deviation(data, ctl & ADXL362_ACT_INACT_CTL_ACT_REF) > threshold) {
+			*status |= ADXL362_STATUS_ACT | ADXL362_STATUS_AWAKE;
+			memcpy(data->reference, data->accel, sizeof(data->reference));
+		}
+		return;
+	}
+
+	uint16_t threshold = adxl362_emul_reg16(data, ADXL362_REG_THRESH_INACT_L, 0x7FF);
+	bool below = adxl362_emul_deviation(data, ctl & ADXL362_ACT_INACT_CTL_INACT_REF) < threshold;
+
+	if (!(ctl & ADXL362_ACT_INACT_CTL_INACT_EN) || !below) {
+		data->inactivity_pending = false;
+		(void)k_work_cancel_delayable(&data->inactivity_work);
+		return;
+	}
+	if (!data->inactivity_pending) {
+		uint32_t samples = MAX(adxl362_emul_reg16(data, ADXL362_REG_TIME_INACT_L, 0xFFFF), 1);
+
+		data->inactivity_pending = true;
+		k_work_schedule(&data->inactivity_work,
+				K_USEC((uint64_t)samples * adxl362_emul_sample_period_us(data)));
+	}
+}
+
+static void adxl362_emul_inactivity_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct adxl362_emul_data *data = CONTAINER_OF(dwork, struct adxl362_emul_data, inactivity_work);
+	bool level;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	if (data->inactivity_pending) {
+		data->inactivity_pending = false;
+		data->regs[ADXL362_REG_STATUS] &= ~ADXL362_STATUS_AWAKE;
+		data->regs[ADXL362_REG_STATUS] |= ADXL362_STATUS_INACT;
+		memcpy(data->reference, data->accel, sizeof(data->reference));
+	}
+	level = adxl362_emul_int1_level(data);
+	k_mutex_unlock(&data->lock);
+
+	adxl362_emul_update_int1(data, level);
+}
+
+static uint8_t adxl362_emul_reg_read(struct adxl362_emul_data *data, uint8_t reg)
+{
+	uint8_t value;
+
+	if (reg >= ADXL362_REG_COUNT) {
+		return 0;
+	}
+	value = data->regs[reg];
+	if (reg == ADXL362_REG_STATUS) {
+		/* Reading the status acknowledges the activity and inactivity events. */
+		data->regs[ADXL362_REG_STATUS] &= ~(ADXL362_STATUS_ACT | ADXL362_STATUS_INACT);
+	}
+	return value;
+}
+
+static void adxl362_emul_reg_write(struct adxl362_emul_data *data, uint8_t reg, uint8_t value)
+{
+	if (reg == ADXL362_REG_SOFT_RESET) {
+		if (value == ADXL362_RESET_KEY) {
+			adxl362_emul_reset(data);
+		}
+		return;
+	}
+	if (reg < ADXL362_REG_SOFT_RESET || reg >= ADXL362_REG_COUNT) {
+		/* Identification, status and data registers are read-only. */
+		return;
+	}
+	data->regs[reg] = value;
+}
+
+/* Byte at position pos of a scattered buffer set, NULL past its end or in a NULL buffer. */
+static uint8_t *adxl362_emul_buf_at(const struct spi_buf_set *set, size_t pos)
+{
+	if (set == NULL) {
+		return NULL;
+	}
+	for (size_t i = 0; i < set->count; i++) {
+		if (pos < set->buffers[i].len) {
+			return set->buffers[i].buf ? (uint8_t *)set->buffers[i].buf + pos : NULL;
+		}
+		pos -= set->buffers[i].len;
+	}
+	return NULL;
+}
+
+static size_t adxl362_emul_set_len(const struct spi_buf_set *set)
+{
+	size_t len = 0;
+
+	for (size_t i = 0; set != NULL && i < set->count; i++) {
+		len += set->buffers[i].len;
+	}
+	return len;
+}
+
+static int adxl362_emul_io(const struct emul *target, const struct spi_config *config,
+			   const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+	struct adxl362_emul_data *data = target->data;
+	size_t len = MAX(adxl362_emul_set_len(tx_bufs), adxl362_emul_set_len(rx_bufs));
+	uint8_t *cmd = adxl362_emul_buf_at(tx_bufs, 0);
+	uint8_t *addr = adxl362_emul_buf_at(tx_bufs, 1);
+	uint8_t reg;
+	bool level;
+
+	ARG_UNUSED(config);
+
+	if (cmd == NULL || addr == NULL) {
+		return -EIO;
+	}
+	if (*cmd != ADXL362_CMD_READ_REG && *cmd != ADXL362_CMD_WRITE_REG) {
+		LOG_WRN("Unsupported command 0x%02x", *cmd);
+		return -ENOTSUP;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	reg = *addr;
+	for (size_t pos = 2; pos < len; pos++, reg++) {
+		if (*cmd == ADXL362_CMD_WRITE_REG) {
+			uint8_t *value = adxl362_emul_buf_at(tx_bufs, pos);
+
+			adxl362_emul_reg_write(data, reg, value ? *value : 0);
+		} else {
+			uint8_t value = adxl362_emul_reg_read(data, reg);
+			uint8_t *out = adxl362_emul_buf_at(rx_bufs, pos);
+
+			if (out != NULL) {
+				*out = value;
+			}
+		}
+	}
+	level = adxl362_emul_int1_level(data);
+	k_mutex_unlock(&data->lock);
+
+	adxl362_emul_update_int1(data, level);
+	return 0;
+}
+
+int emul_adxl362_set_accel(const struct emul *target, int16_t x_mg, int16_t y_mg, int16_t z_mg)
+{
+	struct adxl362_emul_data *data = target->data;
+	const int16_t mg[ADXL362_AXES] = {x_mg, y_mg, z_mg};
+	bool level;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	/* 1 mg per LSB at +-2 g, halved for every range step. */
+	uint8_t range = data->regs[ADXL362_REG_FILTER_CTL] >> 6;
+
+	for (int axis = 0; axis < ADXL362_AXES; axis++) {
+		data->accel[axis] = CLAMP(mg[axis] >> range, -2048, 2047);
+		sys_put_le16((uint16_t)data->accel[axis], &data->regs[ADXL362_REG_XDATA_L + 2 * axis]);
+	}
+	adxl362_emul_evaluate(data);
+	level = adxl362_emul_int1_level(data);
+	k_mutex_unlock(&data->lock);
+
+	adxl362_emul_update_int1(data, level);
+	return 0;
+}
+
+static int adxl362_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct adxl362_emul_data *data = target->data;
+
+	ARG_UNUSED(parent);
+
+	data->cfg = target->cfg;
+	k_mutex_init(&data->lock);
+	k_work_init_delayable(&data->inactivity_work, adxl362_emul_inactivity_handler);
+	adxl362_emul_reset(data);
+	/* Resting flat, 1 g on Z. */
+	data->accel[2] = 1000;
+	sys_put_le16(1000, &data->regs[ADXL362_REG_XDATA_L + 4]);
+	return 0;
+}
+
+static struct spi_emul_api adxl362_emul_api = {
+	.io = adxl362_emul_io,
+};
+
+#define ADXL362_EMUL(n)                                                                            \
+	static struct adxl362_emul_data adxl362_emul_data_##n;                                     \
+	static const struct adxl362_emul_cfg adxl362_emul_cfg_##n = {                              \
+		.int1 = GPIO_DT_SPEC_INST_GET_OR(n, int1_gpios, {0}),                              \
+	};                                                                                         \
+	EMUL_DT_INST_DEFINE(n, adxl362_emul_init, &adxl362_emul_data_##n, &adxl362_emul_cfg_##n,   \
+			    &adxl362_emul_api, NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(ADXL362_EMUL)
+
+#ifdef CONFIG_SHELL
+static int cmd_adxl362_emul_accel(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct emul *target = EMUL_DT_GET(DT_DRV_INST(0));
+	int16_t mg[ADXL362_AXES];
+
+	for (int axis = 0; axis < ADXL362_AXES; axis++) {
+		mg[axis] = (int16_t)strtol(argv[axis + 1], NULL, 10);
+	}
+	shell_print(sh, "accel %d %d %d mg", mg[0], mg[1], mg[2]);
+	return emul_adxl362_set_accel(target, mg[0], mg[1], mg[2]);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_adxl362_emul,
+	SHELL_CMD_ARG(accel, NULL, "Set acceleration: accel <x_mg> <y_mg> <z_mg>",
+		      cmd_adxl362_emul_accel, 4, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(adxl362_emul, &sub_adxl362_emul, "Emulated ADXL362", NULL);
+#endif /* CONFIG_SHELL */
@@ -0,0 +1,503 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Emulator of the BME680 environmental sensor for the our,bme680 driver.
+ *
+ * Models the I2C register file and forced measurements. The calibration
+ * block is chosen so the driver's compensation formulas reduce to linear
+ * functions of the ADC values, which lets the emulator turn the environment
+ * set with emul_bme680_set_env() into raw readings without a solver. A
+ * forced measurement completes as soon as CTRL_MEAS is written.
+ *
+ * With CONFIG_EMUL_BME680_REPLAY the calibration and the data registers come from a capture file
+ * instead, read from the host one frame per measurement.
+ */
+
+#define DT_DRV_COMPAT our_bme680
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+#include <stdlib.h>
+#include <string.h>
+#include "our_drivers/emul_bme680.h"
+#ifdef CONFIG_EMUL_BME680_REPLAY
+#include <nsi_host_trampolines.h>
+#include "cmdline.h"
+#include "soc.h"
+#endif
+
+LOG_MODULE_REGISTER(emul_bme680, CONFIG_SENSOR_LOG_LEVEL);
+
+#define BME680_REG_COEFF3           0x00
+#define BME680_REG_MEAS_STATUS      0x1D
+#define BME680_REG_PRESS_MSB        0x1F
+#define BME680_REG_TEMP_MSB         0x22
+#define BME680_REG_HUM_MSB          0x25
+#define BME680_REG_GAS_R_MSB        0x2A
+#define BME680_REG_CONTROL_FIRST    0x50
+#define BME680_REG_CTRL_GAS_1       0x71
+#define BME680_REG_CTRL_MEAS        0x74
+#define BME680_REG_CONTROL_LAST     0x75
+#define BME680_REG_COEFF1           0x8A
+#define BME680_REG_CHIP_ID          0xD0
+#define BME680_REG_SOFT_RESET       0xE0
+#define BME680_REG_COEFF2           0xE1
+#define BME680_REG_COUNT            0x100
+#define BME680_LEN_COEFF1           23
+#define BME680_LEN_COEFF2           14
+#define BME680_LEN_COEFF3           5
+#define BME680_LEN_COEFF_ALL        (BME680_LEN_COEFF1 + BME680_LEN_COEFF2 + BME680_LEN_COEFF3)
+#define BME680_LEN_FIELD            13
+
+#define BME680_CHIP_ID              0x61
+#define BME680_RESET_KEY            0xB6
+#define BME680_MODE_MASK            0x03
+#define BME680_MODE_FORCED          0x01
+#define BME680_RUN_GAS              BIT(4)
+#define BME680_NEW_DATA             BIT(7)
+#define BME680_GAS_VALID            BIT(5)
+#define BME680_HEATR_STAB           BIT(4)
+
+/* Calibration: par_t1 = 12800 and par_t2 = 8192 give 12.8 ADC steps of adc_temp >> 3 per 0.01 degC,
+ * par_p1 = 37500 gives 6 ADC steps per Pa below 2^20 and par_h2 = 1024 gives 125 m%RH per 32 ADC
+ * steps. Every other parameter is zero.
+ */
+#define EMUL_PAR_T1                 12800
+#define EMUL_PAR_T2                 8192
+#define EMUL_PAR_P1                 37500
+#define EMUL_PAR_H2                 1024
+
+/* Ranges the ADC values of the calibration above can represent. */
+#define EMUL_TEMP_MIN               (-2000)
+#define EMUL_TEMP_MAX               8200
+#define EMUL_PRESS_MIN              30000
+#define EMUL_PRESS_MAX              114000
+#define EMUL_HUMIDITY_MAX           100000
+#define EMUL_GAS_ADC_MAX            1023
+#define EMUL_GAS_RANGES             16
+
+/* Gas range lookup tables of the BME680 datasheet, as used by the driver. */
+static const uint32_t gas_look_up1[EMUL_GAS_RANGES] = {
+	2147483647, 2147483647, 2147483647, 2147483647, 2147483647, 2126008810, 2147483647, 2130303777,
+	2147483647, 2147483647, 2143188679, 2136746228, 2147483647, 2126008810, 2147483647, 2147483647};
+static const uint32_t gas_look_up2[EMUL_GAS_RANGES] = {
+	4096000000, 2048000000, 1024000000, 512000000, 255744255, 127110228, 64000000, 32258064,
+	16016016,   8000000,    4000000,    2000000,   1000000,   500000,    250000,    125000};
+
+/* Capture file: the header, then frame_count frames. Little endian. */
+#define REPLAY_MAGIC                0x30383642 /* "B680" */
+#define REPLAY_VERSION              1
+
+struct replay_header {
+	uint32_t magic;
+	uint8_t version;
+	uint8_t frame_size;
+	uint8_t calibration_size;
+	uint8_t reserved;
+	uint32_t frame_count;
+	uint8_t calibration[BME680_LEN_COEFF_ALL]; /* COEFF1, COEFF2, COEFF3 */
+} __packed;
+
+struct replay_frame {
+	uint32_t timestamp; /* ms, as captured */
+	uint8_t regs[BME680_LEN_FIELD];
+} __packed;
+
+struct bme680_emul_data {
+	struct k_mutex lock;
+	uint8_t regs[BME680_REG_COUNT];
+	uint8_t pointer;
+	int32_t temperature; /* 0.01 degC */
+	uint32_t humidity;   /* 0.001 %RH */
+	uint32_t pressure;   /* Pa */
+	uint32_t gas;        /* ohm */
+#ifdef CONFIG_EMUL_BME680_REPLAY
+	int replay_fd;        /* -1 without a replay */
+	uint32_t replay_left; /* frames not read from the file yet */
+	uint8_t replay_calibration[BME680_LEN_COEFF_ALL];
+	struct replay_frame replay_frame; /* in the data registers */
+	struct replay_frame replay_ahead; /* read, not due yet, paced replays only */
+	bool replay_ahead_valid;
+	bool replay_started;
+	int64_t replay_start; /* uptime of the first replayed measurement */
+	uint32_t replay_base; /* timestamp of the first frame */
+#endif
+};
+
+#ifdef CONFIG_EMUL_BME680_REPLAY
+static char *replay_path;
+static bool replay_paced;
+
+static void bme680_emul_replay_options(void)
+{
+	static struct args_struct_t options[] = {
+		{.option = "bme680_replay",
+		 .name = "path",
+		 .type = 's',
+		 .dest = (void *)&replay_path,
+		 .descript = "Replay the BME680 frames captured in this file"},
+		{.is_switch = true,
+		 .option = "bme680_replay_paced",
+		 .type = 'b',
+		 .dest = (void *)&replay_paced,
+		 .descript = "Replay the frames at their recorded pace, not one per measurement"},
+		ARG_TABLE_ENDMARKER};
+
+	native_add_command_line_opts(options);
+}
+
+NATIVE_TASK(bme680_emul_replay_options, PRE_BOOT_1, 1);
+#endif /* CONFIG_EMUL_BME680_REPLAY */
+
+static void bme680_emul_load_calibration(struct bme680_emul_data *data)
+{
+	sys_put_le16(EMUL_PAR_T2, &data->regs[BME680_REG_COEFF1]);
+	sys_put_le16(EMUL_PAR_P1, &data->regs[BME680_REG_COEFF1 + 4]);
+	/* par_h2 is split in a MSB register and the upper nibble of the next one. */
+	data->regs[BME680_REG_COEFF2] = EMUL_PAR_H2 >> 4;
+	data->regs[BME680_REG_COEFF2 + 1] = (EMUL_PAR_H2 & 0x0F) << 4;
+	sys_put_le16(EMUL_PAR_T1, &data->regs[BME680_REG_COEFF2 + 8]);
+}
+
+#ifdef CONFIG_EMUL_BME680_REPLAY
+/* Same order as the driver reads the blocks in. */
+static void bme680_emul_load_replay_calibration(struct bme680_emul_data *data)
+{
+	const uint8_t *blob = data->replay_calibration;
+
+	memcpy(&data->regs[BME680_REG_COEFF1], blob, BME680_LEN_COEFF1);
+	memcpy(&data->regs[BME680_REG_COEFF2], blob + BME680_LEN_COEFF1, BME680_LEN_COEFF2);
+	memcpy(&data->regs[BME680_REG_COEFF3], blob + BME680_LEN_COEFF1 + BME680_LEN_COEFF2,
+	       BME680_LEN_COEFF3);
+}
+#endif
+
+static void bme680_emul_reset(struct bme680_emul_data *data)
+{
+	memset(data->regs, 0, sizeof(data->regs));
+	data->regs[BME680_REG_CHIP_ID] = BME680_CHIP_ID;
+#ifdef CONFIG_EMUL_BME680_REPLAY
+	if (data->replay_fd >= 0) {
+		bme680_emul_load_replay_calibration(data);
+	} else {
+		bme680_emul_load_calibration(data);
+	}
+#else
+	bme680_emul_load_calibration(data);
+#endif
+	data->pointer = 0;
+}
+
+static uint32_t bme680_emul_adc_temp(int32_t temperature)
+{
+	int32_t centi = CLAMP(temperature, EMUL_TEMP_MIN, EMUL_TEMP_MAX);
+
+	return (uint32_t)(centi * 64 / 5 + 2 * EMUL_PAR_T1) << 3;
+}
+
+static uint32_t bme680_emul_adc_press(uint32_t pressure)
+{
+	return BIT(20) - CLAMP(pressure, EMUL_PRESS_MIN, EMUL_PRESS_MAX) * 6;
+}
+
+static uint16_t bme680_emul_adc_humidity(uint32_t humidity)
+{
+	return (uint16_t)(MIN(humidity, EMUL_HUMIDITY_MAX) * 32 / 125);
+}
+
+/* Gas ADC value and range for a resistance, from the first range that can represent it. */
+static uint16_t bme680_emul_adc_gas(uint32_t gas, uint8_t *range)
+{
+	int64_t adc = 0;
+
+	gas = MAX(gas, 1);
+	for (uint8_t i = 0; i < EMUL_GAS_RANGES; i++) {
+		int64_t var1 = (1340 * (int64_t)gas_look_up1[i]) >> 16;
+		int64_t var3 = ((int64_t)gas_look_up2[i] * var1) >> 9;
+		int64_t var2 = var3 / gas;
+
+		adc = (var2 + 16777216 - var1 + BIT(14)) >> 15;
+		*range = i;
+		if (adc <= EMUL_GAS_ADC_MAX) {
+			break;
+		}
+	}
+	return (uint16_t)CLAMP(adc, 0, EMUL_GAS_ADC_MAX);
+}
+
+#ifdef CONFIG_EMUL_BME680_REPLAY
+static bool bme680_emul_replay_read(struct bme680_emul_data *data, struct replay_frame *frame)
+{
+	if (data->replay_ahead_valid) {
+		*frame = data->replay_ahead;
+		data->replay_ahead_valid = false;
+		return true;
+	}
+	if (data->replay_left == 0) {
+		return false;
+	}
+	if (nsi_host_read(data->replay_fd, frame, sizeof(*frame)) != sizeof(*frame)) {
+		LOG_WRN("Capture file truncated, %u frames missing", data->replay_left);
+		data->replay_left = 0;
+		return false;
+	}
+	data->replay_left--;
+	return true;
+}
+
+/* Latch the next recorded frame, false once the recording ended. Called with the lock held. */
+static bool bme680_emul_replay_measure(struct bme680_emul_data *data)
+{
+	struct replay_frame frame;
+
+	if (data->replay_fd < 0) {
+		return false;
+	}
+	if (!replay_paced) {
+		if (!bme680_emul_replay_read(data, &frame)) {
+			return false;
+		}
+		data->replay_frame = frame;
+	} else {
+		int64_t now = k_uptime_get();
+
+		if (!data->replay_started) {
+			if (!bme680_emul_replay_read(data, &data->replay_frame)) {
+				return false;
+			}
+			data->replay_started = true;
+			data->replay_start = now;
+			data->replay_base = data->replay_frame.timestamp;
+		}
+		/* The latest frame due: earlier ones are skipped, and a sensor read faster than it was
+		 * recorded sees the same frame again.
+		 */
+		uint32_t elapsed = (uint32_t)(now - data->replay_start);
+
+		while (bme680_emul_replay_read(data, &frame)) {
+			if (frame.timestamp - data->replay_base > elapsed) {
+				data->replay_ahead = frame;
+				data->replay_ahead_valid = true;
+				break;
+			}
+			data->replay_frame = frame;
+		}
+	}
+
+	memcpy(&data->regs[BME680_REG_PRESS_MSB], data->replay_frame.regs, BME680_LEN_FIELD);
+	data->regs[BME680_REG_MEAS_STATUS] = BME680_NEW_DATA;
+	data->regs[BME680_REG_CTRL_MEAS] &= ~BME680_MODE_MASK;
+	return true;
+}
+#endif /* CONFIG_EMUL_BME680_REPLAY */
+
+/* Latch the current environment into the data registers. Called with the lock held. */
+static void bme680_emul_measure(struct bme680_emul_data *data)
+{
+#ifdef CONFIG_EMUL_BME680_REPLAY
+	if (bme680_emul_replay_measure(data)) {
+		return;
+	}
+#endif
+	bool run_gas = data->regs[BME680_REG_CTRL_GAS_1] & BME680_RUN_GAS;
+	uint8_t range = 0;
+	uint16_t gas = bme680_emul_adc_gas(data->gas, &range);
+
+	sys_put_be24(bme680_emul_adc_press(data->pressure) << 4, &data->regs[BME680_REG_PRESS_MSB]);
+	sys_put_be24(bme680_emul_adc_temp(data->temperature) << 4, &data->regs[BME680_REG_TEMP_MSB]);
+	sys_put_be16(bme680_emul_adc_humidity(data->humidity), &data->regs[BME680_REG_HUM_MSB]);
+	data->regs[BME680_REG_GAS_R_MSB] = gas >> 2;
+	data->regs[BME680_REG_GAS_R_MSB + 1] =
+		((gas & 0x03) << 6) | (run_gas ? BME680_GAS_VALID | BME680_HEATR_STAB : 0) | range;
+	data->regs[BME680_REG_MEAS_STATUS] = BME680_NEW_DATA;
+	/* Back to sleep mode once the measurement is done. */
+	data->regs[BME680_REG_CTRL_MEAS] &= ~BME680_MODE_MASK;
+}
+
+static void bme680_emul_reg_write(struct bme680_emul_data *data, uint8_t reg, uint8_t value)
+{
+	if (reg == BME680_REG_SOFT_RESET) {
+		if (value == BME680_RESET_KEY) {
+			bme680_emul_reset(data);
+		}
+		return;
+	}
+	if (reg < BME680_REG_CONTROL_FIRST || reg > BME680_REG_CONTROL_LAST) {
+		/* Calibration, identification and data registers are read-only. */
+		return;
+	}
+	data->regs[reg] = value;
+	if (reg == BME680_REG_CTRL_MEAS && (value & BME680_MODE_MASK) == BME680_MODE_FORCED) {
+		bme680_emul_measure(data);
+	}
+}
+
+static int bme680_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+				int addr)
+{
+	struct bme680_emul_data *data = target->data;
+
+	ARG_UNUSED(addr);
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	for (int i = 0; i < num_msgs; i++) {
+		struct i2c_msg *msg = &msgs[i];
+
+		if (msg->flags & I2C_MSG_READ) {
+			for (uint32_t pos = 0; pos < msg->len; pos++) {
+				msg->buf[pos] = data->regs[data->pointer++];
+			}
+			continue;
+		}
+		/* A write sets the register pointer, then alternates data and register bytes. */
+		for (uint32_t pos = 0; pos < msg->len; pos++) {
+			if (pos % 2 == 0) {
+				data->pointer = msg->buf[pos];
+			} else {
+				bme680_emul_reg_write(data, data->pointer, msg->buf[pos]);
+			}
+		}
+	}
+	k_mutex_unlock(&data->lock);
+	return 0;
+}
+
+int emul_bme680_set_env(const struct emul *target, int32_t temperature, uint32_t humidity,
+			uint32_t pressure, uint32_t gas)
+{
+	struct bme680_emul_data *data = target->data;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	data->temperature = temperature;
+	data->humidity = humidity;
+	data->pressure = pressure;
+	data->gas = gas;
+	k_mutex_unlock(&data->lock);
+	return 0;
+}
+
+#ifdef CONFIG_EMUL_BME680_REPLAY
+/* Open the capture file given on the command line and take its calibration. */
+static void bme680_emul_replay_open(struct bme680_emul_data *data)
+{
+	struct replay_header header;
+
+	data->replay_fd = -1;
+	if (replay_path == NULL) {
+		return;
+	}
+
+	int fd = nsi_host_open(replay_path, 0 /* O_RDONLY */);
+
+	if (fd < 0) {
+		LOG_ERR("Failed to open capture %s", replay_path);
+		return;
+	}
+	if (nsi_host_read(fd, &header, sizeof(header)) != sizeof(header) || header.magic != REPLAY_MAGIC ||
+	    header.version != REPLAY_VERSION || header.frame_size != sizeof(struct replay_frame) ||
+	    header.calibration_size != BME680_LEN_COEFF_ALL) {
+		LOG_ERR("Not a BME680 capture: %s", replay_path);
+		nsi_host_close(fd);
+		return;
+	}
+
+	memcpy(data->replay_calibration, header.calibration, sizeof(data->replay_calibration));
+	data->replay_left = header.frame_count;
+	data->replay_fd = fd;
+	LOG_INF("Replaying %u frames from %s%s", header.frame_count, replay_path,
+		replay_paced ? " at the recorded pace" : "");
+}
+
+int emul_bme680_replay_remaining(const struct emul *target)
+{
+	struct bme680_emul_data *data = target->data;
+	int remaining;
+
+	if (data->replay_fd < 0) {
+		return -ENODATA;
+	}
+	k_mutex_lock(&data->lock, K_FOREVER);
+	remaining = (int)data->replay_left + (data->replay_ahead_valid ? 1 : 0);
+	k_mutex_unlock(&data->lock);
+	return remaining;
+}
+
+int emul_bme680_replay_timestamp(const struct emul *target, uint32_t *timestamp)
+{
+	struct bme680_emul_data *data = target->data;
+
+	if (data->replay_fd < 0) {
+		return -ENODATA;
+	}
+	k_mutex_lock(&data->lock, K_FOREVER);
+	*timestamp = data->replay_frame.timestamp;
+	k_mutex_unlock(&data->lock);
+	return 0;
+}
+
+bool emul_bme680_replay_paced(void)
+{
+	return replay_paced;
+}
+#endif /* CONFIG_EMUL_BME680_REPLAY */
+
+static int bme680_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct bme680_emul_data *data = target->data;
+
+	ARG_UNUSED(parent);
+
+	k_mutex_init(&data->lock);
+#ifdef CONFIG_EMUL_BME680_REPLAY
+	bme680_emul_replay_open(data);
+#endif
+	bme680_emul_reset(data);
+	/* A quiet room. */
+	data->temperature = 2150;
+	data->humidity = 45000;
+	data->pressure = 101325;
+	data->gas = 50000;
+	return 0;
+}
+
+static const struct i2c_emul_api bme680_emul_api = {
+	.transfer = bme680_emul_transfer,
+};
+
+#define BME680_EMUL(n)                                                                             \
+	static struct bme680_emul_data bme680_emul_data_##n;                                       \
+	EMUL_DT_INST_DEFINE(n, bme680_emul_init, &bme680_emul_data_##n, NULL, &bme680_emul_api,    \
+			    NULL)
+
+DT_INST_FOREACH_STATUS_OKAY(BME680_EMUL)
+
+#ifdef CONFIG_SHELL
+static int cmd_bme680_emul_env(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct emul *target = EMUL_DT_GET(DT_DRV_INST(0));
+	int32_t temperature = (int32_t)strtol(argv[1], NULL, 10);
+	uint32_t humidity = (uint32_t)strtoul(argv[2], NULL, 10);
+	uint32_t pressure = (uint32_t)strtoul(argv[3], NULL, 10);
+	uint32_t gas = (uint32_t)strtoul(argv[4], NULL, 10);
+
+	shell_print(sh, "env %d cdegC %u m%%RH %u Pa %u ohm", temperature, humidity, pressure, gas);
+	return emul_bme680_set_env(target, temperature, humidity, pressure, gas);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_bme680_emul,
+	SHELL_CMD_ARG(env, NULL,
+		      "Set environment: env <centi_degc> <milli_pct_rh> <pa> <ohm>",
+		      cmd_bme680_emul_env, 5, 0),
+	SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(bme680_emul, &sub_bme680_emul, "Emulated BME680", NULL);
+#endif /* CONFIG_SHELL */
@@ -0,0 +1,408 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * ADXL372 high-g accelerometer driver for impact capture.
+ *
+ * The FIFO runs in triggered mode: it keeps CONFIG_OUR_ADXL372_PRE_TRIGGER_SAMPLES
+ * samples from before an activity event and fills up with the samples after
+ * it. INT1 signals the activity event and the full FIFO, so the CPU sleeps
+ * while the window is recorded, and the FIFO is then drained with one SPI
+ * burst into one of two capture buffers that are lent to the application.
+ */
+
+#define DT_DRV_COMPAT our_adxl372
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+
+/* This include path comes from the module's 'include' directory */
+#include "our_drivers/our_adxl372.h"
+
+LOG_MODULE_REGISTER(our_adxl372, CONFIG_SENSOR_LOG_LEVEL);
+
+#define ADXL372_REG_DEVID_AD        0x00
+#define ADXL372_REG_PARTID          0x02
+#define ADXL372_REG_STATUS          0x04
+#define ADXL372_REG_X_DATA_H        0x08
+#define ADXL372_REG_THRESH_ACT_X_H  0x23
+#define ADXL372_REG_TIME_ACT        0x29
+#define ADXL372_REG_FIFO_SAMPLES    0x39
+#define ADXL372_REG_FIFO_CTL        0x3A
+#define ADXL372_REG_INT1_MAP        0x3B
+#define ADXL372_REG_TIMING          0x3D
+#define ADXL372_REG_MEASURE         0x3E
+#define ADXL372_REG_POWER_CTL       0x3F
+#define ADXL372_REG_RESET           0x41
+#define ADXL372_REG_FIFO_DATA       0x42
+
+#define ADXL372_DEVID_AD            0xAD
+#define ADXL372_PARTID              0xFA
+#define ADXL372_RESET_CODE          0x52
+
+#define ADXL372_STATUS_FIFO_FULL    BIT(2)
+#define ADXL372_STATUS_FIFO_OVR     BIT(3)
+#define ADXL372_STATUS2_ACTIVITY    BIT(5)
+
+#define ADXL372_INT1_MAP_FIFO_FULL  BIT(2)
+#define ADXL372_INT1_MAP_ACT        BIT(5)
+
+#define ADXL372_FIFO_CTL_BYPASSED   (0 << 1)
+#define ADXL372_FIFO_CTL_TRIGGERED  (2 << 1)
+#define ADXL372_FIFO_CTL_FORMAT_XYZ (0 << 3)
+
+#define ADXL372_THRESH_ACT_ENABLE   BIT(0)
+#define ADXL372_POWER_CTL_FULL_BW   0x03
+
+#define ADXL372_SPI_OPERATION (SPI_WORD_SET(8) | SPI_TRANSFER_MSB | SPI_OP_MODE_MASTER)
+
+#if defined CONFIG_OUR_ADXL372_ODR_400
+#define ADXL372_ODR 0
+#elif defined CONFIG_OUR_ADXL372_ODR_800
+#define ADXL372_ODR 1
+#elif defined CONFIG_OUR_ADXL372_ODR_1600
+#define ADXL372_ODR 2
+#elif defined CONFIG_OUR_ADXL372_ODR_3200
+#define ADXL372_ODR 3
+#elif defined CONFIG_OUR_ADXL372_ODR_6400
+#define ADXL372_ODR 4
+#endif
+
+#define ADXL372_PRE_TRIGGER_ENTRIES (CONFIG_OUR_ADXL372_PRE_TRIGGER_SAMPLES * OUR_ADXL372_AXES)
+#define ADXL372_THRESHOLD (CONFIG_OUR_ADXL372_ACTIVITY_THRESHOLD_MG / OUR_ADXL372_MG_PER_LSB)
+#define ADXL372_BUFFERS 2
+
+struct our_adxl372_config {
+	struct spi_dt_spec spi;
+	struct gpio_dt_spec int1;
+};
+
+struct our_adxl372_data {
+	const struct device *dev;
+	const struct our_adxl372_callbacks *callbacks;
+	struct gpio_callback gpio_cb;
+	struct k_work work;
+	atomic_t held;          /* bit per capture buffer lent to the application */
+	uint32_t dropped;
+	int64_t irq_time;
+	int64_t trigger_time;
+	int16_t accel[OUR_ADXL372_AXES];
+	uint8_t fifo[ADXL372_BUFFERS][2 * OUR_ADXL372_FIFO_ENTRIES];
+};
+
+K_THREAD_STACK_DEFINE(our_adxl372_stack, CONFIG_OUR_ADXL372_THREAD_STACK_SIZE);
+static struct k_work_q our_adxl372_work_q;
+
+static int our_adxl372_reg_read(const struct device *dev, uint8_t reg, void *buf, size_t len)
+{
+	const struct our_adxl372_config *config = dev->config;
+	uint8_t cmd = (reg << 1) | 1;
+	const struct spi_buf tx_buf = {.buf = &cmd, .len = 1};
+	const struct spi_buf_set tx = {.buffers = &tx_buf, .count = 1};
+	const struct spi_buf rx_buf[] = {
+		{.buf = NULL, .len = 1},
+		{.buf = buf, .len = len},
+	};
+	const struct spi_buf_set rx = {.buffers = rx_buf, .count = ARRAY_SIZE(rx_buf)};
+
+	return spi_transceive_dt(&config->spi, &tx, &rx);
+}
+
+static int our_adxl372_reg_write(const struct device *dev, uint8_t reg, uint8_t val)
+{
+	const struct our_adxl372_config *config = dev->config;
+	uint8_t buf[2] = {reg << 1, val};
+	const struct spi_buf tx_buf = {.buf = buf, .len = sizeof(buf)};
+	const struct spi_buf_set tx = {.buffers = &tx_buf, .count = 1};
+
+	return spi_write_dt(&config->spi, &tx);
+}
+
+/* Clear the FIFO and start recording the next window. */
+static int our_adxl372_fifo_rearm(const struct device *dev)
+{
+	uint8_t ctl = ADXL372_FIFO_CTL_FORMAT_XYZ | ((ADXL372_PRE_TRIGGER_ENTRIES >> 8) & 0x01);
+	int err;
+
+	err = our_adxl372_reg_write(dev, ADXL372_REG_FIFO_CTL, ctl | ADXL372_FIFO_CTL_BYPASSED);
+	if (err < 0) {
+		return err;
+	}
+	err = our_adxl372_reg_write(dev, ADXL372_REG_FIFO_SAMPLES, ADXL372_PRE_TRIGGER_ENTRIES & 0xFF);
+	if (err < 0) {
+		return err;
+	}
+	return our_adxl372_reg_write(dev, ADXL372_REG_FIFO_CTL, ctl | ADXL372_FIFO_CTL_TRIGGERED);
+}
+
+/* Drain the FIFO into a free capture buffer with one burst and lend it to the application. */
+static void our_adxl372_capture(const struct device *dev, uint16_t entries)
+{
+	struct our_adxl372_data *data = dev->data;
+	int buffer = -1;
+	int err;
+
+	for (int i = 0; i < ADXL372_BUFFERS; i++) {
+		if (!atomic_test_and_set_bit(&data->held, i)) {
+			buffer = i;
+			break;
+		}
+	}
+	if (buffer < 0) {
+		data->dropped++;
+		LOG_WRN("Both capture buffers held, impact window dropped");
+		return;
+	}
+
+	/* Only whole X, Y, Z samples. */
+	entries = MIN(entries, OUR_ADXL372_FIFO_ENTRIES);
+	entries -= entries % OUR_ADXL372_AXES;
+
+	err = our_adxl372_reg_read(dev, ADXL372_REG_FIFO_DATA, data->fifo[buffer], 2 * entries);
+	if (err < 0) {
+		LOG_ERR("Failed to read FIFO: %d", err);
+		atomic_clear_bit(&data->held, buffer);
+		return;
+	}
+
+	struct our_adxl372_capture capture = {
+		.fifo = data->fifo[buffer],
+		.entries = entries,
+		.pre_trigger = MIN(ADXL372_PRE_TRIGGER_ENTRIES, entries),
+		.trigger_time = data->trigger_time,
+		.buffer = (uint8_t)buffer,
+	};
+
+	if (data->callbacks && data->callbacks->capture) {
+		data->callbacks->capture(dev, &capture, data->callbacks->user_data);
+	} else {
+		atomic_clear_bit(&data->held, buffer);
+	}
+}
+
+static void our_adxl372_work_handler(struct k_work *work)
+{
+	struct our_adxl372_data *data = CONTAINER_OF(work, struct our_adxl372_data, work);
+	const struct device *dev = data->dev;
+	/* STATUS, STATUS2, FIFO_ENTRIES2 and FIFO_ENTRIES in one read. */
+	uint8_t status[4];
+	int err;
+
+	err = our_adxl372_reg_read(dev, ADXL372_REG_STATUS, status, sizeof(status));
+	if (err < 0) {
+		LOG_ERR("Failed to read status: %d", err);
+		return;
+	}
+
+	if (status[1] & ADXL372_STATUS2_ACTIVITY) {
+		data->trigger_time = data->irq_time;
+		if (data->callbacks && data->callbacks->impact) {
+			data->callbacks->impact(dev, data->trigger_time, data->callbacks->user_data);
+		}
+	}
+	if (status[0] & (ADXL372_STATUS_FIFO_FULL | ADXL372_STATUS_FIFO_OVR)) {
+		our_adxl372_capture(dev, ((status[2] & 0x03) << 8) | status[3]);
+		err = our_adxl372_fifo_rearm(dev);
+		if (err < 0) {
+			LOG_ERR("Failed to rearm FIFO: %d", err);
+		}
+	}
+}
+
+static void our_adxl372_gpio_callback(const struct device *port, struct gpio_callback *cb, uint32_t pins)
+{
+	struct our_adxl372_data *data = CONTAINER_OF(cb, struct our_adxl372_data, gpio_cb);
+
+	data->irq_time = k_uptime_get();
+	k_work_submit_to_queue(&our_adxl372_work_q, &data->work);
+}
+
+int our_adxl372_impact_arm(const struct device *dev, const struct our_adxl372_callbacks *callbacks)
+{
+	const struct our_adxl372_config *config = dev->config;
+	struct our_adxl372_data *data = dev->data;
+	int err;
+
+	data->callbacks = callbacks;
+
+	err = our_adxl372_fifo_rearm(dev);
+	if (err < 0) {
+		return err;
+	}
+	err = our_adxl372_reg_write(dev, ADXL372_REG_INT1_MAP,
+				    ADXL372_INT1_MAP_ACT | ADXL372_INT1_MAP_FIFO_FULL);
+	if (err < 0) {
+		return err;
+	}
+	return gpio_pin_interrupt_configure_dt(&config->int1, GPIO_INT_EDGE_TO_ACTIVE);
+}
+
+void our_adxl372_capture_release(const struct device *dev, const struct our_adxl372_capture *capture)
+{
+	struct our_adxl372_data *data = dev->data;
+
+	atomic_clear_bit(&data->held, capture->buffer);
+}
+
+uint32_t our_adxl372_captures_dropped(const struct device *dev)
+{
+	struct our_adxl372_data *data = dev->data;
+
+	return data->dropped;
+}
+
+static int our_adxl372_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+	struct our_adxl372_data *data = dev->data;
+	uint8_t buf[2 * OUR_ADXL372_AXES];
+	int err;
+
+	if (chan != SENSOR_CHAN_ALL && chan != SENSOR_CHAN_ACCEL_XYZ) {
+		return -ENOTSUP;
+	}
+
+	err = our_adxl372_reg_read(dev, ADXL372_REG_X_DATA_H, buf, sizeof(buf));
+	if (err < 0) {
+		return err;
+	}
+	for (int axis = 0; axis < OUR_ADXL372_AXES; axis++) {
+		data->accel[axis] = (int16_t)sys_get_be16(&buf[2 * axis]) >> 4;
+	}
+	return 0;
+}
+
+static int our_adxl372_channel_get(const struct device *dev, enum sensor_channel chan,
+				   struct sensor_value *val)
+{
+	struct our_adxl372_data *data = dev->data;
+
+	switch (chan) {
+	case SENSOR_CHAN_ACCEL_X:
+	case SENSOR_CHAN_ACCEL_Y:
+	case SENSOR_CHAN_ACCEL_Z:
+		sensor_ug_to_ms2(data->accel[chan - SENSOR_CHAN_ACCEL_X] * OUR_ADXL372_MG_PER_LSB * 1000, val);
+		return 0;
+	case SENSOR_CHAN_ACCEL_XYZ:
+		for (int axis = 0; axis < OUR_ADXL372_AXES; axis++) {
+			sensor_ug_to_ms2(data->accel[axis] * OUR_ADXL372_MG_PER_LSB * 1000, &val[axis]);
+		}
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+
+static int our_adxl372_chip_init(const struct device *dev)
+{
+	uint8_t id[3];
+	int err;
+
+	err = our_adxl372_reg_read(dev, ADXL372_REG_DEVID_AD, id, sizeof(id));
+	if (err < 0) {
+		return err;
+	}
+	if (id[0] != ADXL372_DEVID_AD || id[2] != ADXL372_PARTID) {
+		LOG_ERR("Bad ADXL372 id: 0x%x 0x%x", id[0], id[2]);
+		return -ENOTSUP;
+	}
+
+	err = our_adxl372_reg_write(dev, ADXL372_REG_RESET, ADXL372_RESET_CODE);
+	if (err < 0) {
+		return err;
+	}
+	k_msleep(1);
+
+	/* Same activity threshold on every axis, absolute: at high g gravity does not matter. */
+	for (int axis = 0; axis < OUR_ADXL372_AXES; axis++) {
+		uint8_t reg = ADXL372_REG_THRESH_ACT_X_H + 2 * axis;
+
+		err = our_adxl372_reg_write(dev, reg, (ADXL372_THRESHOLD >> 3) & 0xFF);
+		if (err == 0) {
+			err = our_adxl372_reg_write(dev, reg + 1,
+						    ((ADXL372_THRESHOLD & 0x07) << 5) | ADXL372_THRESH_ACT_ENABLE);
+		}
+		if (err < 0) {
+			return err;
+		}
+	}
+
+	err = our_adxl372_reg_write(dev, ADXL372_REG_TIME_ACT, 1);
+	if (err == 0) {
+		err = our_adxl372_reg_write(dev, ADXL372_REG_TIMING, ADXL372_ODR << 5);
+	}
+	if (err == 0) {
+		/* Bandwidth at half the data rate, same encoding. */
+		err = our_adxl372_reg_write(dev, ADXL372_REG_MEASURE, ADXL372_ODR);
+	}
+	if (err == 0) {
+		err = our_adxl372_reg_write(dev, ADXL372_REG_POWER_CTL, ADXL372_POWER_CTL_FULL_BW);
+	}
+	return err;
+}
+
+static int our_adxl372_init(const struct device *dev)
+{
+	const struct our_adxl372_config *config = dev->config;
+	struct our_adxl372_data *data = dev->data;
+	static bool work_q_started;
+	int err;
+
+	if (!spi_is_ready_dt(&config->spi) || !gpio_is_ready_dt(&config->int1)) {
+		LOG_ERR("Bus or INT1 not ready for '%s'", dev->name);
+		return -ENODEV;
+	}
+
+	if (!work_q_started) {
+		k_work_queue_start(&our_adxl372_work_q, our_adxl372_stack,
+				   K_THREAD_STACK_SIZEOF(our_adxl372_stack),
+				   CONFIG_OUR_ADXL372_THREAD_PRIORITY, NULL);
+		k_thread_name_set(&our_adxl372_work_q.thread, "adxl372");
+		work_q_started = true;
+	}
+
+	data->dev = dev;
+	k_work_init(&data->work, our_adxl372_work_handler);
+
+	err = our_adxl372_chip_init(dev);
+	if (err < 0) {
+		return err;
+	}
+
+	err = gpio_pin_configure_dt(&config->int1, GPIO_INPUT);
+	if (err < 0) {
+		return err;
+	}
+	gpio_init_callback(&data->gpio_cb, our_adxl372_gpio_callback, BIT(config->int1.pin));
+	return gpio_add_callback(config->int1.port, &data->gpio_cb);
+}
+
+/* This struct tells Zephyr which functions to call for the standard API */
+static DEVICE_API(sensor, our_adxl372_api_funcs) = {
+	.sample_fetch = our_adxl372_sample_fetch,
+	.channel_get = our_adxl372_channel_get,
+};
+
+#define OUR_ADXL372_DEFINE(inst)						\
+	static struct our_adxl372_data our_adxl372_data_##inst;			\
+	static const struct our_adxl372_config our_adxl372_config_##inst = {	\
+		.spi = SPI_DT_SPEC_INST_GET(inst, ADXL372_SPI_OPERATION, 0),	\
+		.int1 = GPIO_DT_SPEC_INST_GET(inst, int1_gpios),		\
+	};									\
+	SENSOR_DEVICE_DT_INST_DEFINE(inst,					\
+			 our_adxl372_init,					\
+			 NULL,							\
+			 &our_adxl372_data_##inst,				\
+			 &our_adxl372_config_##inst,				\
+			 POST_KERNEL,						\
+			 CONFIG_SENSOR_INIT_PRIORITY,				\
+			 &our_adxl372_api_funcs);
+
+/* Create the struct device for every status "okay" node in the devicetree. */
+DT_INST_FOREACH_STATUS_OKAY(OUR_ADXL372_DEFINE)
@@ -6,6 +6,7 @@
 #include <zephyr/drivers/sensor.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/pm/device.h>
+#include <string.h>
 
 /* This include path comes from the module's 'include' directory */
 #include "our_drivers/our_bme680.h"
@@ -196,9 +197,15 @@ static uint8_t our_bme680_calc_gas_wait(uint16_t dur)
 	return durval;
 }
 
-/* --- Standard Zephyr Sensor API Implementation --- */
+int our_bme680_start_measurement(const struct device *dev)
+{
+	int ret = our_bme680_reg_write(dev, BME680_REG_CTRL_MEAS, BME680_CTRL_MEAS_VAL);
 
-static int our_bme680_sample_fetch(const struct device *dev, enum sensor_channel chan) {
+	return ret < 0 ? ret : 0;
+}
+
+int our_bme680_finish_measurement(const struct device *dev)
+{
     struct our_bme680_data *data = dev->data;
 	struct our_bme680_data_regs data_regs;
 	uint8_t gas_range;
@@ -208,14 +215,6 @@ static int our_bme680_sample_fetch(const struct device *dev, enum sensor_channel
 	int cnt = 0;
 	int ret;
 
-	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL);
-
-	/* Trigger the measurement */
-	ret = our_bme680_reg_write(dev, BME680_REG_CTRL_MEAS, BME680_CTRL_MEAS_VAL);
-	if (ret < 0) {
-		return ret;
-	}
-
 	do {
 		/* Wait for a maximum of 250ms for data.
 		 * Initial delay after boot has been measured at 170ms.
@@ -237,6 +236,12 @@ static int our_bme680_sample_fetch(const struct device *dev, enum sensor_channel
 		return ret;
 	}
 
+#ifdef CONFIG_OUR_BME680_CAPTURE
+	if (data->capture != NULL) {
+		data->capture(dev, &data_regs, data->capture_user_data);
+	}
+#endif
+
 	adc_press = sys_get_be24(data_regs.pressure) >> 4;
 	adc_temp = sys_get_be24(data_regs.temperature) >> 4;
 	adc_hum = sys_get_be16(data_regs.humidity);
@@ -248,9 +253,24 @@ static int our_bme680_sample_fetch(const struct device *dev, enum sensor_channel
 	our_bme680_calc_press(data, adc_press);
 	our_bme680_calc_humidity(data, adc_hum);
 	our_bme680_calc_gas_resistance(data, gas_range, adc_gas_res);
+	data->has_fetched = true;
 	return 0;
+}
+
+/* --- Standard Zephyr Sensor API Implementation --- */
+
+static int our_bme680_sample_fetch(const struct device *dev, enum sensor_channel chan) {
+	int ret;
+
+	__ASSERT_NO_MSG(chan == SENSOR_CHAN_ALL);
+
+	/* Trigger the measurement */
+	ret = our_bme680_start_measurement(dev);
+	if (ret < 0) {
+		return ret;
+	}
 
-    return 0;
+	return our_bme680_finish_measurement(dev);
 }
 
 static int our_bme680_channel_get(const struct device *dev,
@@ -299,6 +319,49 @@ static int our_bme680_channel_get(const struct device *dev,
 	return 0;
 }
 
+int our_bme680_get_all(const struct device *dev, struct our_bme680_readings *readings)
+{
+	const struct our_bme680_data *data = dev->data;
+
+	if (!data->has_fetched) {
+		return -ENODATA;
+	}
+
+	readings->calc_temp = data->calc_temp;
+	readings->calc_press = data->calc_press;
+	readings->calc_humidity = data->calc_humidity;
+	readings->calc_gas_resistance = data->calc_gas_resistance;
+	return 0;
+}
+
+int our_bme680_set_capture(const struct device *dev, our_bme680_capture_fn callback, void *user_data)
+{
+#ifdef CONFIG_OUR_BME680_CAPTURE
+	struct our_bme680_data *data = dev->data;
+
+	data->capture_user_data = user_data;
+	data->capture = callback;
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int our_bme680_get_calibration(const struct device *dev, uint8_t *blob)
+{
+#ifdef CONFIG_OUR_BME680_CAPTURE
+	const struct our_bme680_data *data = dev->data;
+
+	if (!data->has_read_compensation) {
+		return -ENODATA;
+	}
+	memcpy(blob, data->calibration, BME680_LEN_COEFF_ALL);
+	return 0;
+#else
+	return -ENOTSUP;
+#endif
+}
+
 static int our_bme680_read_compensation(const struct device *dev)
 {
 	struct our_bme680_data *data = dev->data;
@@ -327,6 +390,10 @@ static int our_bme680_read_compensation(const struct device *dev)
 		return err;
 	}
 
+#ifdef CONFIG_OUR_BME680_CAPTURE
+	memcpy(data->calibration, buff, BME680_LEN_COEFF_ALL);
+#endif
+
 	/* Temperature related coefficients */
 	data->par_t1 = (uint16_t)(BME680_CONCAT_BYTES(buff[32], buff[31]));
 	data->par_t2 = (int16_t)(BME680_CONCAT_BYTES(buff[1], buff[0]));
@@ -0,0 +1,27 @@
+#ifndef OUR_DRIVERS_EMUL_ADXL362_H_
+#define OUR_DRIVERS_EMUL_ADXL362_H_
+
+#include <zephyr/drivers/emul.h>
+#include <zephyr/types.h>
+
+/* This block handles the C++ compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set the acceleration seen by an emulated ADXL362.
+ *
+ * The value is evaluated against the activity and inactivity thresholds programmed by the driver,
+ * raising INT1 on activity right away and on inactivity once it lasted the programmed time.
+ * @param target Emulator of the ADXL362, EMUL_DT_GET() of its devicetree node.
+ * @param x_mg, y_mg, z_mg Acceleration in milli-g.
+ * @return 0 on success.
+ */
+int emul_adxl362_set_accel(const struct emul *target, int16_t x_mg, int16_t y_mg, int16_t z_mg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OUR_DRIVERS_EMUL_ADXL362_H_ */
@@ -0,0 +1,55 @@
+#ifndef OUR_DRIVERS_EMUL_BME680_H_
+#define OUR_DRIVERS_EMUL_BME680_H_
+
+#include <zephyr/drivers/emul.h>
+#include <zephyr/types.h>
+#include <stdbool.h>
+
+/* This block handles the C++ compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set the environment measured by an emulated BME680.
+ *
+ * The values are latched into the data registers by the next forced measurement, in the driver's
+ * native resolution. Values outside -20..82 degC or 30..114 kPa are clamped, pressure reads back
+ * within 2 Pa and humidity within 4 m%RH.
+ * @param target Emulator of the BME680, EMUL_DT_GET() of its devicetree node.
+ * @param temperature Temperature in 0.01 degC.
+ * @param humidity Relative humidity in 0.001 %RH.
+ * @param pressure Pressure in Pa.
+ * @param gas Gas resistance in ohm.
+ * @return 0 on success.
+ */
+int emul_bme680_set_env(const struct emul *target, int32_t temperature, uint32_t humidity,
+			uint32_t pressure, uint32_t gas);
+
+/**
+ * @brief Frames of the -bme680_replay capture not measured yet.
+ * Requires CONFIG_EMUL_BME680_REPLAY.
+ * @param target Emulator of the BME680, EMUL_DT_GET() of its devicetree node.
+ * @return Number of frames, -ENODATA when no capture is replayed.
+ */
+int emul_bme680_replay_remaining(const struct emul *target);
+
+/**
+ * @brief Capture timestamp of the frame the last measurement latched.
+ * Requires CONFIG_EMUL_BME680_REPLAY.
+ * @param target Emulator of the BME680, EMUL_DT_GET() of its devicetree node.
+ * @param timestamp Output in ms, as recorded.
+ * @return 0 on success, -ENODATA when no capture is replayed.
+ */
+int emul_bme680_replay_timestamp(const struct emul *target, uint32_t *timestamp);
+
+/**
+ * @brief Whether -bme680_replay_paced was given. Requires CONFIG_EMUL_BME680_REPLAY.
+ */
+bool emul_bme680_replay_paced(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OUR_DRIVERS_EMUL_BME680_H_ */
@@ -0,0 +1,83 @@
+#ifndef OUR_DRIVERS_OUR_ADXL372_H_
+#define OUR_DRIVERS_OUR_ADXL372_H_
+
+#include <zephyr/types.h>
+#include <zephyr/device.h>
+#include <zephyr/sys/byteorder.h>
+
+/* This block handles the C++ compatibility */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Every FIFO entry is one axis of one sample, X, Y and Z in turn. */
+#define OUR_ADXL372_FIFO_ENTRIES   512
+#define OUR_ADXL372_AXES           3
+#define OUR_ADXL372_MG_PER_LSB     100
+
+/**
+ * @brief One impact window, read from the FIFO with a single SPI burst.
+ *
+ * The entries live in a driver buffer and stay valid until the capture is handed back with
+ * our_adxl372_capture_release(). The driver has two such buffers.
+ */
+struct our_adxl372_capture {
+	const uint8_t *fifo;    /* raw FIFO entries, 16-bit big endian */
+	uint16_t entries;       /* number of FIFO entries, a multiple of OUR_ADXL372_AXES */
+	uint16_t pre_trigger;   /* entries recorded before the activity event */
+	int64_t trigger_time;   /* k_uptime_get() of the activity interrupt */
+	uint8_t buffer;         /* driver buffer index */
+};
+
+/**
+ * @brief Callbacks of an armed ADXL372, called from the driver thread.
+ *
+ * impact is called as soon as the activity interrupt fires, capture once the post-trigger part
+ * of the window was recorded and read out.
+ */
+struct our_adxl372_callbacks {
+	void (*impact)(const struct device *dev, int64_t time, void *user_data);
+	void (*capture)(const struct device *dev, const struct our_adxl372_capture *capture,
+			void *user_data);
+	void *user_data;
+};
+
+/**
+ * @brief Start impact detection in triggered FIFO mode.
+ * @param dev Pointer to the ADXL372 device structure.
+ * @param callbacks Callbacks, must stay valid while armed.
+ * @return 0 on success, negative errno on failure.
+ */
+int our_adxl372_impact_arm(const struct device *dev, const struct our_adxl372_callbacks *callbacks);
+
+/**
+ * @brief Hand a capture buffer back to the driver.
+ * @param dev Pointer to the ADXL372 device structure.
+ * @param capture Capture passed to the capture callback.
+ */
+void our_adxl372_capture_release(const struct device *dev, const struct our_adxl372_capture *capture);
+
+/**
+ * @brief Number of windows lost because both capture buffers were still held.
+ * @param dev Pointer to the ADXL372 device structure.
+ */
+uint32_t our_adxl372_captures_dropped(const struct device *dev);
+
+/**
+ * @brief Acceleration of one FIFO entry in mg.
+ * @param capture Capture to read.
+ * @param index Entry index, below capture->entries.
+ */
+static inline int32_t our_adxl372_entry_mg(const struct our_adxl372_capture *capture, size_t index)
+{
+	/* 12-bit left justified, bit 0 flags the X entry of a sample. */
+	int16_t raw = (int16_t)sys_get_be16(&capture->fifo[2 * index]) >> 4;
+
+	return (int32_t)raw * OUR_ADXL372_MG_PER_LSB;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OUR_DRIVERS_OUR_ADXL372_H_ */
@@ -62,6 +62,9 @@ struct our_bme680_data_regs {
     uint8_t gas[2];
 } __packed;
 
+typedef void (*our_bme680_capture_fn)(const struct device *dev, const struct our_bme680_data_regs *regs,
+				      void *user_data);
+
 struct our_bme680_data {
     /* Compensation parameters. */
     uint16_t par_h1;
@@ -100,11 +103,18 @@ struct our_bme680_data {
 
     /* Additional information */
     uint8_t heatr_stab;
+    bool has_fetched;
 
     /* Carryover between temperature and pressure/humidity compensation. */
     int32_t t_fine;
 
     uint8_t chip_id;
+#ifdef CONFIG_OUR_BME680_CAPTURE
+    /* Raw COEFF1, COEFF2 and COEFF3 blocks, BME680_LEN_COEFF_ALL bytes. */
+    uint8_t calibration[42];
+    our_bme680_capture_fn capture;
+    void *capture_user_data;
+#endif
 #if BME680_BUS_SPI
 	uint8_t mem_page;
 #endif
@@ -195,6 +205,16 @@ struct our_bme680_data {
 #define BME680_HEATR_DUR_MS 1943
 #endif
 
+/* Duration of a forced measurement, as the Bosch BME68x API computes it: 1963 us per oversampling
+ * cycle, 477 us per TPH and gas switch, 500 us settling and 1 ms wake-up, then the heater.
+ */
+#define BME680_OS_CYCLES(over)   (1 << ((over) - 1))
+#define BME680_MEAS_CYCLES       (BME680_OS_CYCLES(BME680_TEMP_OVER >> 5) +  \
+				  BME680_OS_CYCLES(BME680_PRESS_OVER >> 2) + \
+				  BME680_OS_CYCLES(BME680_HUMIDITY_OVER))
+#define BME680_TPH_DUR_MS        ((BME680_MEAS_CYCLES * 1963 + 477 * 9 + 500) / 1000 + 1)
+#define BME680_MEAS_DUR_MS       (BME680_TPH_DUR_MS + BME680_HEATR_DUR_MS)
+
 #if defined CONFIG_OUR_BME680_FILTER_OFF
 #define BME680_FILTER 0
 #elif defined CONFIG_OUR_BME680_FILTER_2
@@ -233,6 +253,65 @@ struct our_bme680_data {
  * into the generic 'sensor_channel_get' model.
  */
 
+/**
+ * @brief Compensated values of the last fetch, in the driver's native resolution.
+ */
+struct our_bme680_readings {
+	int32_t calc_temp;            /* 0.01 degC */
+	uint32_t calc_press;          /* Pa */
+	uint32_t calc_humidity;       /* 0.001 %RH */
+	uint32_t calc_gas_resistance; /* ohm */
+};
+
+/**
+ * @brief Read every channel of the last sensor_sample_fetch() in one call.
+ * Unlike sensor_channel_get() the values are not split into struct sensor_value.
+ * * @param dev Pointer to the BME680 device structure.
+ * @param readings Output for the four compensated values.
+ * @return 0 on success, -ENODATA if nothing was fetched yet.
+ */
+int our_bme680_get_all(const struct device *dev, struct our_bme680_readings *readings);
+
+/**
+ * @brief Pass the raw data registers of every following fetch to a callback.
+ * The callback runs in the context of sensor_sample_fetch(), before compensation. Requires
+ * CONFIG_OUR_BME680_CAPTURE.
+ * * @param dev Pointer to the BME680 device structure.
+ * @param callback Called once per successful fetch, NULL to stop capturing.
+ * @param user_data Passed to callback.
+ * @return 0 on success, -ENOTSUP without CONFIG_OUR_BME680_CAPTURE.
+ */
+int our_bme680_set_capture(const struct device *dev, our_bme680_capture_fn callback, void *user_data);
+
+/**
+ * @brief Copy the raw calibration registers the compensation was set up from.
+ * COEFF1, COEFF2 and COEFF3, in the order the driver reads them. Requires
+ * CONFIG_OUR_BME680_CAPTURE.
+ * * @param dev Pointer to the BME680 device structure.
+ * @param blob Output for BME680_LEN_COEFF_ALL bytes.
+ * @return 0 on success, -ENODATA before the sensor was powered up, -ENOTSUP without
+ * CONFIG_OUR_BME680_CAPTURE.
+ */
+int our_bme680_get_calibration(const struct device *dev, uint8_t *blob);
+
+/**
+ * @brief Trigger a forced measurement and return without waiting for it.
+ * sensor_sample_fetch() is our_bme680_start_measurement() followed by
+ * our_bme680_finish_measurement(). Split, the caller can read other sensors or sleep while the
+ * BME680 measures and heats its gas plate.
+ * * @param dev Pointer to the BME680 device structure.
+ * @return 0 on success, negative errno on failure. The result is due BME680_MEAS_DUR_MS later.
+ */
+int our_bme680_start_measurement(const struct device *dev);
+
+/**
+ * @brief Wait for the measurement our_bme680_start_measurement() triggered, then read and
+ * compensate it, as sensor_sample_fetch() does.
+ * * @param dev Pointer to the BME680 device structure.
+ * @return 0 on success, -EAGAIN if the result did not arrive, negative errno on failure.
+ */
+int our_bme680_finish_measurement(const struct device *dev);
+
 /**
  * @brief Force the sensor to run a specific gas heater profile immediately.
  * * @param dev Pointer to the BME680 device structure.
@@ -0,0 +1,351 @@
+#!/usr/bin/env python3
+"""Pull the logged data off a BabbiesTracker over mcumgr, see src/services/bulk_transfer.h.
+
+Reads each region in chunks with a few SMP requests in flight, optionally at a
+raised UART speed, and writes it to the output directory: the raw partitions,
+the sample log decoded to CSV and the counters and boot profile as JSON. Every
+sample log batch carries its boot and the TimeService correction of that boot,
+the samples get their UTC time from the latest correction logged for their boot.
+Console lines between SMP frames are skipped. Needs pyserial:
+
+    west build -- -DEXTRA_CONF_FILE=overlay-bulk.conf
+    python3 scripts/bulk_client.py /dev/ttyACM0 --baud 1000000 -o dump/
+"""
+import argparse
+import base64
+import json
+import os
+import struct
+import sys
+import time
+
+import serial
+
+from uplink_server import decode_batch, stamp_to_utc
+
+GROUP_ID = 64
+SMP_VERSION = 1
+OP_READ, OP_READ_RSP, OP_WRITE, OP_WRITE_RSP = 0, 1, 2, 3
+CMD_INFO, CMD_READ, CMD_BAUD = 0, 1, 2
+REGIONS = ["sample_log", "uplink_queue", "stats", "boot_profile"]
+
+STATS_FIELDS = ["uptime_ms", "sample_log_batches", "sample_log_erases", "uplink_sessions",
+                "uplink_samples", "uplink_bytes", "uplink_failures", "uplink_dropped",
+                "queue_pending", "queue_dropped", "queue_downsampled", "bus_windows", "impacts",
+                "energy_micro_amps",
+                *(f"deadband_{kind}_{channel}" for kind in ("forwarded", "heartbeats", "dropped")
+                  for channel in ("t", "p", "h", "g")),
+                "windows_closed", "window_samples", "window_first_ms", "window_last_ms",
+                *(f"window_{kind}_{channel}" for kind in ("min", "max", "last", "variance")
+                  for channel in ("t", "p", "h", "g"))]
+# The readings of the last window are signed, the counters are not
+STATS_FORMAT = "<" + "".join("i" if field.startswith(("window_min", "window_max", "window_last")) else "I"
+                             for field in STATS_FIELDS)
+BOOT_STAGES = ["main", "services", "loop"]
+BOOT_SYNC_OFFSET = 4 + 4 * len(BOOT_STAGES)
+# SystemManager::ServiceId order
+BOOT_SERVICES = ["energy", "led", "connectivity", "settings", "time", "sensor", "bus_scheduler", "battery",
+                 "motion", "impact", "sample_log", "uplink_queue", "uplink", "delta_dfu", "bulk_transfer"]
+
+FRAME_START = b"\x06\x09"
+FRAME_CONTINUE = b"\x04\x14"
+LINE_SIZE = 127  # markers and newline included
+SAMPLE_LOG_MAGIC = 0x534C4F47
+# SampleLog::ENTRY_VERSION, every entry starts with a TimeService::TimeBase
+SAMPLE_LOG_VERSION = 2
+TIME_BASE = struct.Struct("<HIq")
+
+
+def crc16_xmodem(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def crc8_ccitt(crc, data):
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07 if crc & 0x80 else crc << 1) & 0xFF
+    return crc
+
+
+# Just enough CBOR for the requests (maps of unsigned values) and the responses.
+def cbor_head(major, value):
+    if value < 24:
+        return bytes([(major << 5) | value])
+    for info, size in ((24, 1), (25, 2), (26, 4), (27, 8)):
+        if value < 1 << (8 * size):
+            return bytes([(major << 5) | info]) + value.to_bytes(size, "big")
+    raise ValueError(value)
+
+
+def cbor_encode(request):
+    data = cbor_head(5, len(request))
+    for key, value in request.items():
+        data += cbor_head(3, len(key)) + key.encode() + cbor_head(0, value)
+    return data
+
+
+# Without CONFIG_ZCBOR_CANONICAL, zcbor encodes lists and maps with an
+# indefinite length (additional info 31) that ends at the break byte.
+BREAK = 0xFF
+
+
+def cbor_decode(data, pos=0):
+    major, info = data[pos] >> 5, data[pos] & 0x1F
+    pos += 1
+    if info < 24:
+        value = info
+    elif info == 31:
+        value = None
+    else:
+        size = 1 << (info - 24)
+        value = int.from_bytes(data[pos:pos + size], "big")
+        pos += size
+    if major == 0:
+        return value, pos
+    if major == 1:
+        return -1 - value, pos
+    if major in (2, 3):
+        if value is None:
+            raw = b""
+            while data[pos] != BREAK:
+                chunk, pos = cbor_decode(data, pos)
+                raw += chunk if major == 2 else chunk.encode()
+            pos += 1
+        else:
+            raw = data[pos:pos + value]
+            pos += value
+        return (raw if major == 2 else raw.decode()), pos
+    if major == 4:
+        items = []
+        while (data[pos] != BREAK) if value is None else len(items) < value:
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos + (value is None)
+    if major == 5:
+        items = {}
+        while (data[pos] != BREAK) if value is None else len(items) < value:
+            key, pos = cbor_decode(data, pos)
+            items[key], pos = cbor_decode(data, pos)
+        return items, pos + (value is None)
+    if major == 7 and info in (20, 21):
+        return info == 21, pos
+    raise ValueError(f"unsupported CBOR major type {major}")
+
+
+class SmpSerial:
+    def __init__(self, port, baud, timeout, verbose):
+        self.serial = serial.Serial(port, baud, timeout=timeout)
+        self.timeout = timeout
+        self.verbose = verbose
+        self.sequence = 0
+        self.frame = None
+
+    def send(self, op, command, request):
+        payload = cbor_encode(request)
+        sequence = self.sequence
+        self.sequence = (self.sequence + 1) & 0xFF
+        packet = struct.pack("!BBHHBB", (SMP_VERSION << 3) | op, 0, len(payload), GROUP_ID, sequence,
+                             command) + payload
+        body = struct.pack("!H", len(packet) + 2) + packet + struct.pack("!H", crc16_xmodem(packet))
+        encoded = base64.b64encode(body)
+        lines = []
+        marker = FRAME_START
+        while encoded:
+            room = LINE_SIZE - len(marker) - 1
+            lines.append(marker + encoded[:room] + b"\n")
+            encoded = encoded[room:]
+            marker = FRAME_CONTINUE
+        self.serial.write(b"".join(lines))
+        return sequence
+
+    def receive(self):
+        """Return (sequence, response map) of the next SMP response."""
+        deadline = time.monotonic() + self.timeout
+        while time.monotonic() < deadline:
+            line = self.serial.readline().rstrip(b"\r\n")
+            if line.startswith(FRAME_START):
+                self.frame = bytearray(base64.b64decode(line[2:]))
+            elif line.startswith(FRAME_CONTINUE) and self.frame is not None:
+                self.frame += base64.b64decode(line[2:])
+            else:
+                if line and self.verbose:
+                    print(line.decode(errors="replace"), file=sys.stderr)
+                continue
+            (length,) = struct.unpack_from("!H", self.frame)
+            if len(self.frame) < 2 + length:
+                continue
+            packet, crc = bytes(self.frame[2:length]), struct.unpack_from("!H", self.frame, length)[0]
+            self.frame = None
+            if crc16_xmodem(packet) != crc:
+                print("Dropped a frame with a bad CRC", file=sys.stderr)
+                continue
+            _, _, _, group, sequence, _ = struct.unpack_from("!BBHHBB", packet)
+            response, _ = cbor_decode(packet, 8)
+            if group != GROUP_ID:
+                continue
+            error = response.get("rc") or response.get("err", {}).get("rc")
+            if error:
+                raise RuntimeError(f"SMP error {error}")
+            return sequence, response
+        raise TimeoutError("no response from the device")
+
+    def call(self, op, command, request):
+        sequence = self.send(op, command, request)
+        while True:
+            received, response = self.receive()
+            if received == sequence:
+                return response
+
+    def set_baud(self, baud):
+        self.call(OP_WRITE, CMD_BAUD, {"baud": baud})
+        self.serial.flush()
+        time.sleep(0.1)  # the device switches CONFIG_APP_BULK_TRANSFER_BAUD_DELAY_MS after its answer
+        self.serial.baudrate = baud
+        self.serial.reset_input_buffer()
+
+
+def read_region(smp, region, size, chunk, window):
+    """Read a region with up to window requests in flight, in any order of arrival."""
+    data = bytearray(size)
+    pending = {}
+    offset = 0
+    while offset < size or pending:
+        while offset < size and len(pending) < window:
+            length = min(chunk, size - offset)
+            pending[smp.send(OP_READ, CMD_READ, {"r": region, "off": offset, "len": length})] = offset
+            offset += length
+        sequence, response = smp.receive()
+        if sequence not in pending:
+            continue
+        start = pending.pop(sequence)
+        data[start:start + len(response["data"])] = response["data"]
+    return bytes(data)
+
+
+def sample_rows(entries):
+    """(boot, timestamp_ms, utc_ms, readings...) of every logged sample, oldest first.
+
+    A batch logged before the sync of its boot has no correction of its own, it
+    takes the latest one logged for that boot. Boot 0 was not counted, so it only
+    trusts the correction of its own batch.
+    """
+    batches = [(TIME_BASE.unpack_from(entry), entry[TIME_BASE.size:]) for entry in entries]
+    latest = {boot: (sync_stamp, sync_utc_ms) for (boot, sync_stamp, sync_utc_ms), _ in batches
+              if boot and sync_utc_ms}
+    rows = []
+    for (boot, sync_stamp, sync_utc_ms), batch in batches:
+        if not sync_utc_ms and boot in latest:
+            sync_stamp, sync_utc_ms = latest[boot]
+        for sample in decode_batch(batch):
+            utc_ms = stamp_to_utc(sample[0], sync_stamp, sync_utc_ms) if sync_utc_ms else ""
+            rows.append((boot, sample[0], utc_ms, *sample[1:]))
+    return rows
+
+
+def fcb_entries(partition, sector_size, align, magic, version):
+    """Yield the valid entries of an FCB partition, oldest sector first.
+
+    Sectors of another version were written in a format the caller cannot read.
+    """
+    header = struct.Struct("<IBxH")
+    sectors = []
+    for start in range(0, len(partition), sector_size):
+        sector_magic, sector_version, sector_id = header.unpack_from(partition, start)
+        if sector_magic == magic and sector_version == version:
+            sectors.append((sector_id, start))
+    ids = [sector_id for sector_id, _ in sectors]
+    if ids and max(ids) - min(ids) > 0x8000:  # the 16-bit sector IDs wrapped around
+        sectors = [((sector_id + 0x10000) if sector_id < 0x8000 else sector_id, start)
+                   for sector_id, start in sectors]
+
+    def round_up(value):
+        return (value + align - 1) // align * align
+
+    for _, start in sorted(sectors):
+        pos, end = start + round_up(header.size), start + sector_size
+        while pos < end and partition[pos] != 0xFF:
+            length = partition[pos]
+            length_size = 1
+            if length & 0x80:
+                length = (length & 0x7F) | (partition[pos + 1] << 7)
+                length_size = 2
+            data_pos = pos + round_up(length_size)
+            crc_pos = data_pos + round_up(length)
+            if crc_pos >= end:
+                break
+            data = partition[data_pos:data_pos + length]
+            crc = crc8_ccitt(crc8_ccitt(0xFF, partition[pos:pos + length_size]), data)
+            if crc == partition[crc_pos]:
+                yield data
+            pos = crc_pos + round_up(1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("port", help="serial port of the mcumgr UART")
+    parser.add_argument("--boot-baud", type=int, default=115200, help="speed the device boots with")
+    parser.add_argument("--baud", type=int, help="raise the UART to this speed for the transfer")
+    parser.add_argument("--window", type=int, default=3, help="read requests in flight")
+    parser.add_argument("--align", type=int, default=4, help="flash write block size of the FCB")
+    parser.add_argument("--regions", default=",".join(REGIONS), help="comma separated regions to read")
+    parser.add_argument("--timeout", type=float, default=2.0)
+    parser.add_argument("-o", "--output", default=".", help="output directory")
+    parser.add_argument("--verbose", action="store_true", help="print the console lines in between")
+    args = parser.parse_args()
+
+    smp = SmpSerial(args.port, args.boot_baud, args.timeout, args.verbose)
+    info = smp.call(OP_READ, CMD_INFO, {})
+    if args.baud and args.baud != args.boot_baud:
+        smp.set_baud(args.baud)
+    os.makedirs(args.output, exist_ok=True)
+
+    try:
+        for name in args.regions.split(","):
+            region = REGIONS.index(name)
+            size = info["sizes"][region]
+            if size == 0:
+                print(f"{name}: not built in")
+                continue
+            start = time.monotonic()
+            data = read_region(smp, region, size, info["chunk"], args.window)
+            elapsed = max(time.monotonic() - start, 1e-6)
+            line_rate = smp.serial.baudrate / 10
+            print(f"{name}: {size} bytes in {elapsed:.2f} s, {size / elapsed:.0f} B/s"
+                  f" ({100 * size / elapsed / line_rate:.0f}% of the line rate)")
+
+            with open(os.path.join(args.output, f"{name}.bin"), "wb") as file:
+                file.write(data)
+            if name == "sample_log":
+                rows = sample_rows(fcb_entries(data, info["sectors"][region], args.align, SAMPLE_LOG_MAGIC,
+                                               SAMPLE_LOG_VERSION))
+                with open(os.path.join(args.output, "samples.csv"), "w", encoding="utf-8") as file:
+                    file.write("boot,timestamp_ms,utc_ms,temperature,pressure,humidity,gas_resistance\n")
+                    for row in rows:
+                        file.write(",".join(map(str, row)) + "\n")
+                print(f"    {len(rows)} samples in samples.csv, {sum(1 for row in rows if row[2] != '')} with UTC")
+            elif name == "stats":
+                values = dict(zip(STATS_FIELDS, struct.unpack(STATS_FORMAT, data)))
+                with open(os.path.join(args.output, "stats.json"), "w", encoding="utf-8") as file:
+                    json.dump(values, file, indent=2)
+            elif name == "boot_profile":
+                reset_cause, *stages, sync_stamp, sync_utc_ms = struct.unpack_from(f"<I{len(BOOT_STAGES)}IIq", data)
+                services = struct.unpack_from(f"<{len(BOOT_SERVICES)}I", data, BOOT_SYNC_OFFSET + 12)
+                values = {"reset_cause": reset_cause, **{f"{stage}_us": us for stage, us in zip(BOOT_STAGES, stages)},
+                          "sync_stamp_ms": sync_stamp, "sync_utc_ms": sync_utc_ms,
+                          "service_init_us": dict(zip(BOOT_SERVICES, services))}
+                with open(os.path.join(args.output, "boot_profile.json"), "w", encoding="utf-8") as file:
+                    json.dump(values, file, indent=2)
+    finally:
+        if smp.serial.baudrate != args.boot_baud:
+            smp.set_baud(args.boot_baud)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+"""Collect the boot-time benchmark results of a BabbiesTracker native_sim build.
+
+Runs the native_sim executable for a while, or reads a saved log, and turns the
+CSV lines logged by the *_benchmark modules into JSON, one list of rows per
+module. The first line of a module made only of comma separated names is its
+header, later lines with as many fields are its rows:
+
+    west build -b native_sim -- -DEXTRA_CONF_FILE=overlay-native-bench.conf
+    python3 scripts/collect_benchmarks.py build/zephyr/zephyr.exe --seconds 30
+
+Options after -- are passed to the executable, e.g. -bme680_replay=capture.b680.
+"""
+import argparse
+import json
+import re
+import subprocess
+import sys
+
+LOG_LINE = re.compile(r"<inf> (\w+_benchmark): (.*)$")
+HEADER = re.compile(r"^[a-z_]+(,[a-z0-9_]+)+$")
+ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*m")
+
+
+def value(field):
+    try:
+        return int(field)
+    except ValueError:
+        return field
+
+
+def parse(lines):
+    headers = {}
+    results = {}
+    for line in lines:
+        match = LOG_LINE.search(ANSI_ESCAPE.sub("", line).rstrip())
+        if not match:
+            continue
+        module, text = match.groups()
+        if module not in headers:
+            if HEADER.match(text):
+                headers[module] = text.split(",")
+                results[module] = []
+            continue
+        fields = text.split(",")
+        if len(fields) == len(headers[module]) and " " not in text:
+            results[module].append(dict(zip(headers[module], map(value, fields))))
+    return results
+
+
+def run(executable, seconds, options):
+    completed = subprocess.run([executable, f"-stop_at={seconds}", *options], capture_output=True, text=True,
+                               check=False)
+    return completed.stdout.splitlines()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("executable", nargs="?", help="native_sim zephyr.exe to run")
+    parser.add_argument("--seconds", type=int, default=30, help="simulated time to run for")
+    parser.add_argument("--log", help="parse this log instead of running the executable")
+    argv = sys.argv[1:]
+    split = argv.index("--") if "--" in argv else len(argv)
+    args = parser.parse_args(argv[:split])
+    options = argv[split + 1:]
+
+    if args.log:
+        with open(args.log, encoding="utf-8", errors="replace") as log:
+            lines = log.readlines()
+    elif args.executable:
+        lines = run(args.executable, args.seconds, options)
+    else:
+        parser.error("give the executable or --log")
+
+    results = parse(lines)
+    if not results:
+        print("No benchmark output found", file=sys.stderr)
+        return 1
+    json.dump(results, sys.stdout, indent=2)
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
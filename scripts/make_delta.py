@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Make or apply a BabbiesTracker delta firmware patch.
+
+The patch rebuilds the new signed application image (app_update.bin, or
+zephyr.signed.bin without the partition manager) from the image in the MCUboot
+primary slot, see src/services/delta_dfu.h for the format:
+
+    python3 scripts/make_delta.py diff old/app_update.bin new/app_update.bin -o patch.bin
+    python3 scripts/make_delta.py apply old/app_update.bin patch.bin -o rebuilt.bin
+
+diff applies the patch it made and compares the result with the new image
+before writing it. apply runs the patch like the device does, which is how a
+patch is checked without hardware.
+"""
+import argparse
+import hashlib
+import struct
+import sys
+
+MAGIC = 0x46445442
+VERSION = 1
+HEADER = struct.Struct("<IB3xII32s32s")
+OP_INSERT = 1 << 31
+OP_LENGTH_MASK = OP_INSERT - 1
+
+# Matches are looked up by their first KEY bytes. A COPY costs 8 bytes of patch,
+# shorter matches are sent as literals.
+KEY = 8
+MIN_MATCH = 24
+MAX_CANDIDATES = 32
+
+
+def index_old(old):
+    table = {}
+    for position in range(len(old) - KEY + 1):
+        candidates = table.setdefault(old[position:position + KEY], [])
+        if len(candidates) < MAX_CANDIDATES:
+            candidates.append(position)
+    return table
+
+
+def match_length(old, new, old_position, new_position):
+    length = 0
+    limit = min(len(old) - old_position, len(new) - new_position, OP_LENGTH_MASK)
+    while length < limit and old[old_position + length] == new[new_position + length]:
+        length += 1
+    return length
+
+
+def diff(old, new):
+    """Greedy COPY/INSERT operations turning old into new."""
+    table = index_old(old)
+    operations = []
+    literal = bytearray()
+    position = 0
+    expected = 0  # old offset following the last copy, tried first
+    while position < len(new):
+        best_length, best_offset = 0, 0
+        candidates = table.get(new[position:position + KEY], [])
+        for offset in ([expected] if expected < len(old) else []) + candidates:
+            length = match_length(old, new, offset, position)
+            if length > best_length:
+                best_length, best_offset = length, offset
+        if best_length >= MIN_MATCH:
+            if literal:
+                operations.append((OP_INSERT, bytes(literal)))
+                literal = bytearray()
+            operations.append((best_offset, best_length))
+            position += best_length
+            expected = best_offset + best_length
+        else:
+            literal.append(new[position])
+            position += 1
+            if len(literal) == OP_LENGTH_MASK:
+                operations.append((OP_INSERT, bytes(literal)))
+                literal = bytearray()
+    if literal:
+        operations.append((OP_INSERT, bytes(literal)))
+    return operations
+
+
+def encode(old, new, operations):
+    patch = bytearray(HEADER.pack(MAGIC, VERSION, len(old), len(new), hashlib.sha256(old).digest(),
+                                  hashlib.sha256(new).digest()))
+    for first, second in operations:
+        if first == OP_INSERT:
+            patch += struct.pack("<I", OP_INSERT | len(second)) + second
+        else:
+            patch += struct.pack("<II", second, first)
+    return bytes(patch)
+
+
+def apply(old, patch):
+    magic, version, old_size, new_size, old_hash, new_hash = HEADER.unpack_from(patch)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("not a delta patch")
+    if hashlib.sha256(old[:old_size]).digest() != old_hash:
+        raise ValueError("patch was not made for this image")
+    new = bytearray()
+    position = HEADER.size
+    while position < len(patch):
+        (word,) = struct.unpack_from("<I", patch, position)
+        length = word & OP_LENGTH_MASK
+        if word & OP_INSERT:
+            new += patch[position + 4:position + 4 + length]
+            position += 4 + length
+        else:
+            (offset,) = struct.unpack_from("<I", patch, position + 4)
+            if offset + length > old_size:
+                raise ValueError("copy past the end of the old image")
+            new += old[offset:offset + length]
+            position += 8
+    if len(new) != new_size or hashlib.sha256(new).digest() != new_hash:
+        raise ValueError("rebuilt image does not match the patch")
+    return bytes(new)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    make = commands.add_parser("diff", help="make a patch from old to new")
+    make.add_argument("old")
+    make.add_argument("new")
+    make.add_argument("-o", "--output", required=True)
+    rebuild = commands.add_parser("apply", help="rebuild the new image from old and a patch")
+    rebuild.add_argument("old")
+    rebuild.add_argument("patch")
+    rebuild.add_argument("-o", "--output", required=True)
+    args = parser.parse_args()
+
+    with open(args.old, "rb") as file:
+        old = file.read()
+    if args.command == "diff":
+        with open(args.new, "rb") as file:
+            new = file.read()
+        operations = diff(old, new)
+        patch = encode(old, new, operations)
+        if apply(old, patch) != new:
+            raise SystemExit("patch does not rebuild the new image")
+        with open(args.output, "wb") as file:
+            file.write(patch)
+        copied = sum(op[1] for op in operations if op[0] != OP_INSERT)
+        print(f"{len(patch)} byte patch for a {len(new)} byte image ({100 * len(patch) / len(new):.1f}%),"
+              f" {copied} bytes copied in {len(operations)} operations")
+    else:
+        with open(args.patch, "rb") as file:
+            patch = file.read()
+        try:
+            new = apply(old, patch)
+        except ValueError as error:
+            raise SystemExit(str(error))
+        with open(args.output, "wb") as file:
+            file.write(new)
+        print(f"Rebuilt {len(new)} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
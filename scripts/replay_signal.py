@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""Replay a recorded LTE signal trace into a BabbiesTracker native_sim build.
+
+Feeds each row of the trace to the stub link control with the "link_stub signal"
+shell command at its time, and reports when the uplink held batches back and
+released them. The trace is CSV with one "seconds,rsrp_dbm,rsrq_db" row per
+signal change, a header row and lines starting with # are skipped:
+
+    west build -b native_sim -- -DEXTRA_CONF_FILE=overlay-uplink.conf
+    python3 scripts/replay_signal.py build/zephyr/zephyr.exe trace.csv
+
+native_sim runs in real time, so the replay takes as long as the trace plus
+--tail seconds. --log parses a saved log instead.
+"""
+import argparse
+import json
+import re
+import subprocess
+import sys
+import threading
+import time
+
+LOG_LINE = re.compile(r"\[(\d+):(\d+):(\d+)\.(\d+),\d+\] <inf> uplink: (.*)$")
+HELD = re.compile(r"Uplink held back: RSRP (-?\d+) dBm, RSRQ (-?\d+) dB, sent within (\d+) s")
+RELEASED = re.compile(r"Uplink released: RSRP (-?\d+) dBm, RSRQ (-?\d+) dB")
+SESSION = re.compile(r"Uplink session (\d+): (\d+) samples")
+ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*m")
+
+
+def load_trace(path):
+    rows = []
+    with open(path, encoding="utf-8") as file:
+        for line in file:
+            line = line.strip()
+            if not line or line.startswith("#"):
+                continue
+            fields = line.split(",")
+            try:
+                rows.append((float(fields[0]), int(fields[1]), int(fields[2])))
+            except (ValueError, IndexError):
+                continue
+    return sorted(rows)
+
+
+def parse(lines):
+    """Uplink decisions in the log, each with its uptime in seconds."""
+    events = []
+    for line in lines:
+        match = LOG_LINE.search(ANSI_ESCAPE.sub("", line).rstrip())
+        if not match:
+            continue
+        hours, minutes, seconds, millis, text = match.groups()
+        at = int(hours) * 3600 + int(minutes) * 60 + int(seconds) + int(millis) / 1000
+        if held := HELD.search(text):
+            events.append({"seconds": at, "event": "held", "rsrp": int(held[1]), "rsrq": int(held[2]),
+                           "deadline_s": int(held[3])})
+        elif released := RELEASED.search(text):
+            events.append({"seconds": at, "event": "released", "rsrp": int(released[1]),
+                           "rsrq": int(released[2])})
+        elif session := SESSION.search(text):
+            events.append({"seconds": at, "event": "session", "samples": int(session[2])})
+    return events
+
+
+def run(executable, trace, tail):
+    duration = (trace[-1][0] if trace else 0) + tail
+    process = subprocess.Popen([executable, "-uart_stdinout", f"-stop_at={duration}"], stdin=subprocess.PIPE,
+                               stdout=subprocess.PIPE, text=True, bufsize=1)
+    lines = []
+    reader = threading.Thread(target=lambda: lines.extend(process.stdout), daemon=True)
+    reader.start()
+
+    start = time.monotonic()
+    for seconds, rsrp, rsrq in trace:
+        time.sleep(max(0.0, seconds - (time.monotonic() - start)))
+        if process.poll() is not None:
+            break
+        process.stdin.write(f"link_stub signal {rsrp} {rsrq}\n")
+        process.stdin.flush()
+    process.wait()
+    reader.join()
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("executable", nargs="?", help="native_sim zephyr.exe to run")
+    parser.add_argument("trace", nargs="?", help="CSV signal trace to replay")
+    parser.add_argument("--tail", type=float, default=60, help="seconds to keep running after the trace")
+    parser.add_argument("--log", help="parse this log instead of running the executable")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, encoding="utf-8", errors="replace") as log:
+            lines = log.readlines()
+    elif args.executable and args.trace:
+        lines = run(args.executable, load_trace(args.trace), args.tail)
+    else:
+        parser.error("give the executable and the trace, or --log")
+
+    events = parse(lines)
+    summary = {kind: sum(1 for event in events if event["event"] == kind) for kind in ("held", "released", "session")}
+    json.dump({"summary": summary, "events": events}, sys.stdout, indent=2)
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
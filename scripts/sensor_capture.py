@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""Turn a BME680 capture log of BabbiesTracker into a replay file for native_sim.
+
+A build with overlay-capture.conf logs the sensor's calibration once and the raw
+data registers of every fetch. "convert" writes them to a capture file that the
+emulated BME680 of a native_sim build with overlay-replay.conf replays through
+the driver, "show" prints the frames of a capture file as JSON:
+
+    python3 scripts/sensor_capture.py convert uart.log capture.b680
+    python3 scripts/sensor_capture.py show capture.b680
+    build/zephyr/zephyr.exe -bme680_replay=capture.b680 [-bme680_replay_paced]
+
+Only the first boot in the log is converted: it ends at the next calibration
+line or at a stamp older than the one before.
+"""
+import argparse
+import json
+import re
+import struct
+import sys
+
+LOG_LINE = re.compile(r"<inf> sensor_capture: (calibration|frame),(.*)$")
+ANSI_ESCAPE = re.compile(r"\x1b\[[0-9;]*m")
+
+MAGIC = 0x30383642  # "B680"
+VERSION = 1
+CALIBRATION_SIZE = 42
+REGS_SIZE = 13
+HEADER = struct.Struct(f"<IBBBBI{CALIBRATION_SIZE}s")
+FRAME = struct.Struct(f"<I{REGS_SIZE}s")
+
+
+def parse(lines):
+    """Calibration and (stamp, regs) frames of the first boot in the log."""
+    calibration = None
+    frames = []
+    for line in lines:
+        match = LOG_LINE.search(ANSI_ESCAPE.sub("", line).rstrip())
+        if not match:
+            continue
+        kind, fields = match.groups()
+        if kind == "calibration":
+            if calibration is not None:
+                break
+            calibration = bytes.fromhex(fields)
+            if len(calibration) != CALIBRATION_SIZE:
+                raise ValueError(f"calibration of {len(calibration)} bytes, expected {CALIBRATION_SIZE}")
+            continue
+        if calibration is None:
+            continue
+        stamp, regs = fields.split(",")
+        regs = bytes.fromhex(regs)
+        if len(regs) != REGS_SIZE:
+            continue
+        if frames and int(stamp) < frames[-1][0]:
+            break
+        frames.append((int(stamp), regs))
+    return calibration, frames
+
+
+def write(path, calibration, frames):
+    with open(path, "wb") as file:
+        file.write(HEADER.pack(MAGIC, VERSION, FRAME.size, CALIBRATION_SIZE, 0, len(frames), calibration))
+        for stamp, regs in frames:
+            file.write(FRAME.pack(stamp, regs))
+
+
+def read(path):
+    with open(path, "rb") as file:
+        data = file.read()
+    magic, version, frame_size, calibration_size, _, count, calibration = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or frame_size != FRAME.size or calibration_size != CALIBRATION_SIZE:
+        raise ValueError(f"{path} is not a version {VERSION} BME680 capture")
+    frames = [FRAME.unpack_from(data, HEADER.size + i * FRAME.size) for i in range(count)]
+    return calibration, frames
+
+
+def decode(regs):
+    """ADC values of the data registers, in the layout of our_bme680_data_regs."""
+    return {
+        "press_adc": regs[0] << 12 | regs[1] << 4 | regs[2] >> 4,
+        "temp_adc": regs[3] << 12 | regs[4] << 4 | regs[5] >> 4,
+        "hum_adc": regs[6] << 8 | regs[7],
+        "gas_adc": regs[11] << 2 | regs[12] >> 6,
+        "gas_range": regs[12] & 0x0F,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    commands = parser.add_subparsers(dest="command", required=True)
+    convert = commands.add_parser("convert", help="capture log to capture file")
+    convert.add_argument("log", help="console log of a build with overlay-capture.conf")
+    convert.add_argument("output", help="capture file to write")
+    show = commands.add_parser("show", help="print the frames of a capture file")
+    show.add_argument("capture", help="capture file to read")
+    args = parser.parse_args()
+
+    if args.command == "convert":
+        with open(args.log, encoding="utf-8", errors="replace") as log:
+            calibration, frames = parse(log)
+        if calibration is None:
+            print("No calibration line in the log", file=sys.stderr)
+            return 1
+        write(args.output, calibration, frames)
+        span = (frames[-1][0] - frames[0][0]) / 1000 if frames else 0
+        print(f"{len(frames)} frames over {span:.1f} s written to {args.output}")
+        return 0
+
+    calibration, frames = read(args.capture)
+    json.dump({"calibration": calibration.hex(),
+               "frames": [{"stamp": stamp, **decode(regs)} for stamp, regs in frames]}, sys.stdout, indent=2)
+    print()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""Stand-in CoAP collector for the BabbiesTracker uplink.
+
+Acknowledges every confirmable POST, decodes the SampleCodec batch in the
+payload and reports bytes per sample and radio sessions per hour. Sample stamps
+are uptimes, they are placed in UTC with the boot counter and TimeService
+correction in the payload header, see Uplink::PayloadHeader. Use it with
+native_sim and offloaded sockets, with APP_UPLINK_SERVER_ADDR="127.0.0.1":
+
+    python3 scripts/uplink_server.py --port 5683
+
+With --patch it also serves a delta firmware patch made by make_delta.py to
+block-wise GETs of the firmware resource, otherwise they get 4.04 Not Found.
+"""
+import argparse
+import datetime
+import socket
+import struct
+import time
+
+PAYLOAD_VERSION = 2
+PAYLOAD_HEADER_V1 = struct.Struct("<BBH")
+# version, flags, sequence, then TimeService::TimeBase: boot, sync stamp, sync UTC ms
+PAYLOAD_HEADER = struct.Struct("<BBHHIq")
+BATCH_HEADER = struct.Struct("<BBHIIiIII")
+
+# (short, medium) widths per field, must match sample_codec.cpp
+WIDTHS = [(6, 14), (4, 10), (5, 12), (7, 14), (10, 18)]
+
+
+class BitReader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, bits):
+        value = 0
+        for i in range(bits):
+            byte = self.data[self.pos // 8]
+            value |= ((byte >> (self.pos % 8)) & 1) << i
+            self.pos += 1
+        return value
+
+
+def zigzag_decode(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def read_value(reader, short, medium):
+    if reader.read(1) == 0:
+        return 0
+    if reader.read(1) == 0:
+        return zigzag_decode(reader.read(short))
+    return zigzag_decode(reader.read(32 if reader.read(1) else medium))
+
+
+def decode_batch(data):
+    version, _, count, first, _, temp, press, hum, gas = BATCH_HEADER.unpack_from(data)
+    if version != 1:
+        raise ValueError(f"unknown batch version {version}")
+    sample = [first, temp, press, hum, gas]
+    samples = [tuple(sample)]
+    reader = BitReader(data[BATCH_HEADER.size:])
+    interval = 0
+    for _ in range(count - 1):
+        deltas = [read_value(reader, *w) for w in WIDTHS]
+        interval += deltas[0]
+        sample[0] = (sample[0] + interval) & 0xFFFFFFFF
+        for i in range(1, 5):
+            sample[i] += deltas[i]
+        samples.append(tuple(sample))
+    return samples
+
+
+def stamp_to_utc(stamp, sync_stamp, sync_utc_ms):
+    """UTC ms of a stamp from the correction of its boot, like TimeService::toUtc()."""
+    delta = (stamp - sync_stamp) & 0xFFFFFFFF
+    return sync_utc_ms + (delta - (1 << 32) if delta >= 1 << 31 else delta)
+
+
+def format_utc(utc_ms):
+    return datetime.datetime.fromtimestamp(utc_ms / 1000, datetime.timezone.utc).isoformat(timespec="milliseconds")
+
+
+class Corrections:
+    """Latest correction seen per device and boot, for batches sealed before the sync of their boot."""
+
+    def __init__(self):
+        self.known = {}
+
+    def lookup(self, device, boot, sync_stamp, sync_utc_ms):
+        key = (device, boot)
+        if sync_utc_ms:
+            # Boot 0 was not counted, its correction only holds for its own batch
+            if boot:
+                self.known[key] = (sync_stamp, sync_utc_ms)
+            return sync_stamp, sync_utc_ms
+        return self.known.get(key) if boot else None
+
+
+COAP_GET = 1
+OPTION_URI_PATH = 11
+OPTION_BLOCK2 = 23
+CONTENT = (2 << 5) | 5
+CHANGED = (2 << 5) | 4
+NOT_FOUND = (4 << 5) | 4
+
+
+def option_field(value, packet, pos):
+    """Decode an extended option delta or length nibble."""
+    if value == 13:
+        return packet[pos] + 13, pos + 1
+    if value == 14:
+        return struct.unpack_from("!H", packet, pos)[0] + 269, pos + 2
+    return value, pos
+
+
+def parse_coap(packet):
+    """Return (type, code, message id, token, options, payload) of a CoAP message."""
+    first, code, message_id = struct.unpack_from("!BBH", packet)
+    token_length = first & 0x0F
+    token = packet[4:4 + token_length]
+    options = []
+    number = 0
+    pos = 4 + token_length
+    while pos < len(packet) and packet[pos] != 0xFF:
+        nibbles = packet[pos]
+        delta, pos = option_field(nibbles >> 4, packet, pos + 1)
+        length, pos = option_field(nibbles & 0x0F, packet, pos)
+        number += delta
+        options.append((number, packet[pos:pos + length]))
+        pos += length
+    payload = packet[pos + 1:] if pos < len(packet) else b""
+    return (first >> 4) & 0x03, code, message_id, token, options, payload
+
+
+def option_header(delta, length):
+    # Lengths here are at most 3 bytes, deltas up to 268 take one extended byte
+    if delta < 13:
+        return bytes([(delta << 4) | length])
+    return bytes([(13 << 4) | length, delta - 13])
+
+
+def coap_ack(message_id, token, code=CHANGED, block2=None, payload=b""):
+    # Version 1, type ACK (2)
+    packet = struct.pack("!BBH", 0x60 | len(token), code, message_id) + token
+    if block2 is not None:
+        value = block2.to_bytes((block2.bit_length() + 7) // 8, "big") if block2 else b""
+        packet += option_header(OPTION_BLOCK2, len(value)) + value
+    if payload:
+        packet += b"\xff" + payload
+    return packet
+
+
+def serve_patch(patch, message_id, token, options):
+    """Answer a GET of the firmware resource with the requested block of the patch."""
+    path = "/".join(value.decode() for number, value in options if number == OPTION_URI_PATH)
+    if path != "firmware" or patch is None:
+        return coap_ack(message_id, token, NOT_FOUND)
+    block = next((int.from_bytes(value, "big") for number, value in options if number == OPTION_BLOCK2), 0)
+    num, szx = block >> 4, block & 0x07
+    size = 16 << szx
+    chunk = patch[num * size:(num + 1) * size]
+    more = (num + 1) * size < len(patch)
+    print(f"firmware block {num} ({size} bytes){'' if more else ', last'}")
+    return coap_ack(message_id, token, CONTENT, (num << 4) | (int(more) << 3) | szx, chunk)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=5683)
+    parser.add_argument("--verbose", action="store_true", help="print every decoded sample")
+    parser.add_argument("--patch", help="delta firmware patch to serve")
+    args = parser.parse_args()
+
+    patch = None
+    if args.patch:
+        with open(args.patch, "rb") as file:
+            patch = file.read()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.host, args.port))
+    print(f"Listening on {args.host}:{args.port}")
+
+    start = None
+    sessions = total_bytes = total_samples = 0
+    corrections = Corrections()
+    while True:
+        packet, peer = sock.recvfrom(2048)
+        msg_type, code, message_id, token, options, payload = parse_coap(packet)
+        if code == COAP_GET:
+            sock.sendto(serve_patch(patch, message_id, token, options), peer)
+            continue
+        if msg_type == 0:
+            sock.sendto(coap_ack(message_id, token), peer)
+
+        correction = None
+        if payload[0] == PAYLOAD_VERSION:
+            version, flags, sequence, boot, sync_stamp, sync_utc_ms = PAYLOAD_HEADER.unpack_from(payload)
+            samples = decode_batch(payload[PAYLOAD_HEADER.size:])
+            correction = corrections.lookup(peer[0], boot, sync_stamp, sync_utc_ms)
+        else:
+            # Queued by an image before the time base was added, stamps only
+            version, flags, sequence = PAYLOAD_HEADER_V1.unpack_from(payload)
+            samples = decode_batch(payload[PAYLOAD_HEADER_V1.size:])
+            boot = None
+        utc = [stamp_to_utc(sample[0], *correction) if correction else None for sample in samples]
+
+        now = time.monotonic()
+        start = start or now
+        sessions += 1
+        total_bytes += len(packet)
+        total_samples += len(samples)
+        hours = max(now - start, 1.0) / 3600
+        print(f"#{sequence} from {peer[0]}: {len(samples)} samples in {len(packet)} bytes"
+              f"{' URGENT' if flags & 1 else ''} | {total_bytes / total_samples:.2f} B/sample,"
+              f" {sessions / hours:.1f} sessions/h")
+        print(f"    boot {boot if boot else 'unknown'},"
+              f" {format_utc(utc[0]) + ' to ' + format_utc(utc[-1]) if correction else 'not synced, stamps only'}")
+        if args.verbose:
+            for sample, utc_ms in zip(samples, utc):
+                print("   ", sample, format_utc(utc_ms) if utc_ms is not None else "")
+
+
+if __name__ == "__main__":
+    main()
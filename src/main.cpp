@@ -1,3 +1,5 @@
+// Standard modules
+#include <cstdlib>
 // Zephyr modules
 #include <inttypes.h>
 #include <zephyr/device.h>
@@ -7,12 +9,71 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/reboot.h>
 #include <zephyr/sys/util.h>
-// #include <modem/lte_lc.h>
 // App modules
+#ifdef CONFIG_APP_CONNECTIVITY
+#include "services/connectivity.h"
+#endif
+#include "services/sensor.h"
 #include "services/settings_storage.h"
+#ifdef CONFIG_APP_SETTINGS_BENCHMARK
+#include "services/settings_benchmark.h"
+#endif
+#ifdef CONFIG_APP_SENSOR_CAPTURE
+#include "services/sensor_capture.h"
+#endif
 #include "services/system_manager.h"
-#include <zephyr/device.h>
-#include <zephyr/drivers/sensor.h>
+#include "services/time_service.h"
+#ifdef CONFIG_APP_SAMPLE_LOG
+#include "services/sample_log.h"
+#endif
+#ifdef CONFIG_APP_AGGREGATE
+#include "services/aggregator.h"
+#endif
+#ifdef CONFIG_APP_DEADBAND
+#include "services/deadband_filter.h"
+#endif
+#ifdef CONFIG_APP_IAQ
+#include "services/air_quality.h"
+#endif
+#ifdef CONFIG_APP_UPLINK
+#include "services/uplink.h"
+#endif
+#ifdef CONFIG_APP_UPLINK_QUEUE
+#include "services/uplink_queue.h"
+#endif
+#ifdef CONFIG_APP_DELTA_DFU
+#include "services/delta_dfu.h"
+#endif
+#ifdef CONFIG_APP_BULK_TRANSFER
+#include "services/bulk_transfer.h"
+#endif
+#ifdef CONFIG_APP_MOTION
+#include "services/motion.h"
+#endif
+#ifdef CONFIG_APP_IMPACT
+#include "services/impact.h"
+#endif
+#ifdef CONFIG_APP_BUS_SCHEDULER
+#include "services/bus_scheduler.h"
+#endif
+#ifdef CONFIG_APP_BATTERY
+#include "services/battery.h"
+#endif
+#ifdef CONFIG_APP_ENERGY
+#include "services/energy_ledger.h"
+#endif
+#ifdef CONFIG_APP_LED
+#include "services/led.h"
+#endif
+#ifdef CONFIG_APP_FEATURES_BENCHMARK
+#include "services/feature_benchmark.h"
+#endif
+#ifdef CONFIG_APP_SYSTEM_BENCHMARK
+#include "services/system_benchmark.h"
+#endif
+#ifdef CONFIG_APP_REPLAY_BENCHMARK
+#include "services/replay_benchmark.h"
+#endif
 #include "our_drivers/our_bme680.h" // <--- Your custom API
 
 #define DEBUGGER_ATTACH 0
@@ -33,11 +94,186 @@ static struct gpio_callback button_cb_data;
 static const struct gpio_dt_spec led = GPIO_DT_SPEC_GET(LED0_NODE, gpios);
 volatile int buttonPushed            = 0;
 
+// The device name "BME680" must match your devicetree label/node
+static const struct device *const sensorDevice = DEVICE_DT_GET_ANY(our_bme680);
+static const Services::Bme680 bme680(sensorDevice);
+
 void button_pressed(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
     printk("Button pushed");
     buttonPushed++;
 }
 
+#ifdef CONFIG_APP_BATTERY
+void batteryUpdated(const Services::Battery::Status &status) {
+#ifdef CONFIG_APP_MOTION
+    Services::Motion::getInstance().setPeriodScale(status.periodScale);
+#endif
+#ifdef CONFIG_APP_UPLINK
+    Services::Uplink::getInstance().setPeriodScale(status.periodScale);
+#endif
+}
+#endif
+
+#ifdef CONFIG_APP_IMPACT
+void impactDetected(const Services::Impact::Event &event) {
+    if (event.window != nullptr) {
+        return;
+    }
+    LOG_WRN("Impact detected");
+#ifdef CONFIG_APP_LED
+    Services::Led::getInstance().show(Services::Led::Priority::Alert,
+                                      Services::Led::Pattern::blink(Services::Led::Color::Red, 100, 200), 5000);
+#endif
+#ifdef CONFIG_APP_UPLINK
+    // Send what was collected so far right away, the impact is an alert
+    Services::Uplink::getInstance().flushNow();
+#endif
+}
+#endif
+
+/**< Store and send a sample, or the record of a window of them, unless it is within the deadband. */
+static void forward(const Services::Sample &sample) {
+#ifdef CONFIG_APP_DEADBAND
+    if (!Services::DeadbandFilter::getInstance().pass(sample)) {
+        return;
+    }
+#endif
+#ifdef CONFIG_APP_SAMPLE_LOG
+    Services::SampleLog::getInstance().append(sample);
+#endif
+#if defined(CONFIG_APP_UPLINK) && defined(CONFIG_APP_MOTION)
+    // Samples taken while still are only logged, the radio stays off
+    if (Services::Motion::getInstance().isMoving()) {
+        Services::Uplink::getInstance().add(sample);
+    }
+#elif defined(CONFIG_APP_UPLINK)
+    Services::Uplink::getInstance().add(sample);
+#endif
+}
+
+/**< End of a sampling cycle, sleep until the next one is due. */
+static void waitNextSample() {
+#ifdef CONFIG_APP_SYSTEM_BENCHMARK
+    Services::SystemBenchmark::loopEnd();
+#endif
+#ifdef CONFIG_APP_MOTION
+    Services::Motion::getInstance().waitNextSample();
+#else
+    k_sleep(K_SECONDS(2));
+#endif
+}
+
+using Services::SystemManager;
+using ServiceId = Services::SystemManager::ServiceId;
+
+/**< Every service built in, in the order main() used to start them. The dependencies only order
+ * the inits: each service already copes with the ones it uses being unavailable.
+ */
+static constexpr SystemManager::Service services[] = {
+#ifdef CONFIG_APP_ENERGY
+    // So every subsystem is accounted from boot
+    {ServiceId::Energy, "energy", [] { return Services::EnergyLedger::getInstance().init(); }, 0},
+#endif
+#ifdef CONFIG_APP_CONNECTIVITY
+    // The attach runs in the background, waiting for the settings to apply the stored APN
+    {ServiceId::Connectivity, "connectivity", [] { return Services::Connectivity::getInstance().start(); },
+     SystemManager::after(ServiceId::Energy)},
+#endif
+#ifdef CONFIG_APP_LED
+    // The heartbeat is played by the RTC and GPIOTE, the loop no longer wakes up to toggle the LED
+    {ServiceId::Led, "led",
+     [] {
+         Services::Led &leds = Services::Led::getInstance();
+         int error           = leds.init();
+         if (error == 0) {
+             leds.show(Services::Led::Priority::Background,
+                       Services::Led::Pattern::blink(Services::Led::Color::Red, 50, 4000));
+         }
+         return error;
+     },
+     SystemManager::after(ServiceId::Energy)},
+#endif
+    {ServiceId::Settings, "settings", [] { return Services::SettingsStorage::getInstance().init(); }, 0},
+    // Samples are stamped from boot, the mapping to UTC follows once the network sent its time. The
+    // boot is counted in the settings, before anything is stored or sent
+    {ServiceId::Time, "time", [] { return Services::TimeService::getInstance().init(); },
+     SystemManager::after(ServiceId::Connectivity, ServiceId::Settings)},
+    // The first measurement powers the sensor up and heats the gas plate
+#ifdef CONFIG_APP_SENSOR_CAPTURE
+    // The calibration is only read by the first measurement, every fetch after it is captured
+    {ServiceId::Sensor, "sensor",
+     [] {
+         int error = bme680.isReady() ? bme680.fetch() : -ENODEV;
+         if (error == 0) {
+             error = Services::SensorCapture::start(sensorDevice);
+         }
+         return error;
+     },
+     SystemManager::after(ServiceId::Energy)},
+#else
+    {ServiceId::Sensor, "sensor", [] { return bme680.isReady() ? bme680.fetch() : -ENODEV; },
+     SystemManager::after(ServiceId::Energy)},
+#endif
+#ifdef CONFIG_APP_BUS_SCHEDULER
+    // Shares the bus with the sensor, so after its first measurement
+    {ServiceId::BusScheduler, "bus_scheduler", [] { return Services::BusScheduler::getInstance().init(); },
+     SystemManager::after(ServiceId::Energy, ServiceId::Sensor)},
+#endif
+#ifdef CONFIG_APP_BATTERY
+    {ServiceId::Battery, "battery",
+     [] {
+         Services::Battery &battery = Services::Battery::getInstance();
+         int error                  = battery.init();
+         if (error == 0) {
+             battery.addListener(batteryUpdated);
+         }
+         return error;
+     },
+     SystemManager::after(ServiceId::Energy, ServiceId::BusScheduler)},
+#endif
+#ifdef CONFIG_APP_MOTION
+    // Without the accelerometer the device stays in the moving state, sampling at full rate
+    {ServiceId::Motion, "motion", [] { return Services::Motion::getInstance().init(); },
+     SystemManager::after(ServiceId::Energy)},
+#endif
+#ifdef CONFIG_APP_IMPACT
+    {ServiceId::Impact, "impact",
+     [] {
+         Services::Impact &impact = Services::Impact::getInstance();
+         int error                = impact.init();
+         if (error == 0) {
+             impact.addListener(impactDetected);
+         }
+         return error;
+     },
+     SystemManager::after(ServiceId::Energy, ServiceId::Led)},
+#endif
+#ifdef CONFIG_APP_SAMPLE_LOG
+    // Without it samples are not stored
+    {ServiceId::SampleLog, "sample_log", [] { return Services::SampleLog::getInstance().init(); },
+     SystemManager::after(ServiceId::Energy)},
+#endif
+#ifdef CONFIG_APP_UPLINK_QUEUE
+    // Payloads queued before a reboot are sent once the link is up and the settings are loaded
+    {ServiceId::UplinkQueue, "uplink_queue", [] { return Services::UplinkQueue::getInstance().init(); },
+     SystemManager::after(ServiceId::Energy)},
+#endif
+#ifdef CONFIG_APP_UPLINK
+    {ServiceId::Uplink, "uplink", [] { return Services::Uplink::getInstance().init(); },
+     SystemManager::after(ServiceId::Energy, ServiceId::Connectivity, ServiceId::UplinkQueue)},
+#endif
+#ifdef CONFIG_APP_DELTA_DFU
+    // Checks for an update once the link is up, and confirms the running image to MCUboot
+    {ServiceId::DeltaDfu, "delta_dfu", [] { return Services::DeltaDfu::getInstance().init(); },
+     SystemManager::after(ServiceId::Uplink)},
+#endif
+#ifdef CONFIG_APP_BULK_TRANSFER
+    // After the services it reports on
+    {ServiceId::BulkTransfer, "bulk_transfer", [] { return Services::BulkTransfer::getInstance().init(); },
+     SystemManager::after(ServiceId::SampleLog, ServiceId::UplinkQueue, ServiceId::Uplink)},
+#endif
+};
+
 int main(void) {
 #if DEBUGGER_ATTACH
     volatile int attach_debugger = 1;
@@ -48,16 +284,22 @@ int main(void) {
 #endif
 
     LOG_INF("BabbiesTracker application started. Like a charm!\n");
+#ifdef CONFIG_APP_BULK_TRANSFER
+    Services::BulkTransfer::getInstance().mark(Services::BulkTransfer::BootStage::Main);
+#endif
 
+    int ret;
+#ifndef CONFIG_APP_LED
     if (!gpio_is_ready_dt(&led)) {
         LOG_ERR("Error: LED device %s is not ready\n", led.port->name);
         return 0;
     }
-    int ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT_ACTIVE);
+    ret = gpio_pin_configure_dt(&led, GPIO_OUTPUT_ACTIVE);
     if (ret < 0) {
         LOG_ERR("Error %d: failed to configure %s pin %d\n", ret, led.port->name, led.pin);
         return 0;
     }
+#endif
 
     if (!gpio_is_ready_dt(&button)) {
         LOG_ERR("Error: button device %s is not ready\n", button.port->name);
@@ -80,51 +322,73 @@ int main(void) {
     gpio_add_callback(button.port, &button_cb_data);
     LOG_INF("Set up button at %s pin %d\n", button.port->name, button.pin);
 
-    // Fetch the BME680 Sensor
-    // The device name "BME680" must match your devicetree label/node
-    const struct device *dev = DEVICE_DT_GET_ANY(our_bme680);
-
-    if (!device_is_ready(dev)) {
-        LOG_ERR("Sensor BME680 not ready!\n");
-        // return 0;
-    }
-
-    // int err;
-    // Initialize the LTE Modem (Required for nRF9160 system stability)
-    // This boots the modem core, even if we don't connect to a tower yet.
-    // LOG_INF("Initializing LTE modem...\n");
-    // err = lte_lc_init();
-    // if (err) {
-    //     LOG_ERR("Failed to init LTE modem: %d\n", err);
-    // }
-    // LOG_INF("LTE modem initialized.\n");
-
-    Services::SystemManager &system = Services::SystemManager::getInstance();
-    system.init();
+    // Services that block on hardware start in parallel, each as soon as the ones it needs are up
+    SystemManager &system = SystemManager::getInstance();
+    system.init(services);
+#ifdef CONFIG_APP_BULK_TRANSFER
+    Services::BulkTransfer::getInstance().mark(Services::BulkTransfer::BootStage::Services);
+#endif
 
     Services::SettingsStorage &settings = Services::SettingsStorage::getInstance();
-    
+    ret                                 = system.record(ServiceId::Settings).result;
     if (ret != 0) {
-        LOG_ERR("Failed to initialize Settings Storage: %d", ret);
-        return ret;
+        // The sensor loop does not need the settings, the cell keeps its built-in APN
+        LOG_ERR("Failed to initialize Settings Storage: %d, running with the defaults", ret);
     }
+#ifdef CONFIG_APP_SETTINGS_BENCHMARK
+    else {
+        ret = Services::SettingsBenchmark::run();
+        if (ret != 0) {
+            LOG_ERR("Settings benchmark failed: %d", ret);
+        }
+    }
+#endif
 
-    while (1) {
-        ret = gpio_pin_toggle_dt(&led);
-        // Fetch fresh data
-        sensor_sample_fetch(dev);
+#ifdef CONFIG_APP_ENERGY
+    Services::EnergyLedger &ledger = Services::EnergyLedger::getInstance();
+#ifndef CONFIG_APP_LED
+    bool ledOn = true;
+    ledger.setActive(Services::EnergyLedger::Subsystem::Led, ledOn);
+#endif
+#endif
+#ifdef CONFIG_APP_BUS_SCHEDULER
+    Services::BusScheduler &busScheduler = Services::BusScheduler::getInstance();
+#endif
+#ifdef CONFIG_APP_AGGREGATE
+    Services::Aggregator &aggregator = Services::Aggregator::getInstance();
+#endif
+#ifdef CONFIG_APP_IAQ
+    Services::AirQuality &airQuality = Services::AirQuality::getInstance();
+#endif
 
-        struct sensor_value temp, press, humidity, gas;
-        sensor_channel_get(dev, SENSOR_CHAN_AMBIENT_TEMP, &temp);
-        sensor_channel_get(dev, SENSOR_CHAN_PRESS, &press);
-        sensor_channel_get(dev, SENSOR_CHAN_HUMIDITY, &humidity);
-        sensor_channel_get(dev, SENSOR_CHAN_GAS_RES, &gas);
+#ifdef CONFIG_APP_FEATURES_BENCHMARK
+    Services::FeatureBenchmark::run();
+#endif
 
-        LOG_INF("BME680 readings\n\tT: %d.%06d; P: %d.%06d; H: %d.%06d; G: %d.%06d",
-                temp.val1, temp.val2, press.val1, press.val2,
-                humidity.val1, humidity.val2, gas.val1, gas.val2);
-        LOG_INF("LED toggled.");
+#ifdef CONFIG_APP_SYSTEM_BENCHMARK
+    // After the bus scheduler and the settings, so both paths are timed as the loop runs them
+    Services::SystemBenchmark::run(sensorDevice);
+#endif
+#ifdef CONFIG_APP_REPLAY_BENCHMARK
+    // Takes every frame of the capture, the loop then reads the emulated environment again
+    Services::ReplayBenchmark::run(sensorDevice);
+#endif
 
+#ifdef CONFIG_APP_BULK_TRANSFER
+    Services::BulkTransfer::getInstance().mark(Services::BulkTransfer::BootStage::Loop);
+#endif
+    while (1) {
+#ifdef CONFIG_APP_SYSTEM_BENCHMARK
+        Services::SystemBenchmark::loopBegin();
+#endif
+#ifndef CONFIG_APP_LED
+        ret = gpio_pin_toggle_dt(&led);
+#ifdef CONFIG_APP_ENERGY
+        ledOn = !ledOn;
+        ledger.setActive(Services::EnergyLedger::Subsystem::Led, ledOn);
+#endif
+#endif
+        // Before the sampling, a failed sample must not swallow a button push
         switch (buttonPushed) {
         case 0:
             // No button push
@@ -149,7 +413,56 @@ int main(void) {
             break;
         }
 
-        k_sleep(K_SECONDS(2));
+        // Fetch fresh data
+#ifdef CONFIG_APP_BUS_SCHEDULER
+        ret = busScheduler.runWindow();
+        if (ret == -EAGAIN) {
+            ret = bme680.fetch();
+        } else if (busScheduler.snapshot().environmentValid) {
+            // runWindow() logged the PMIC, BH1749 or ADXL362 reads that failed, the sample stands
+            ret = 0;
+        } else if (ret == 0) {
+            ret = -ENODATA;
+        }
+#else
+        ret = bme680.fetch();
+#endif
+
+        // Kept in the driver's native resolution: 0.01 degC, Pa, 0.001 %RH, ohm
+        Services::Sample sample = {.timestamp = Services::TimeService::stamp()};
+        if (ret == 0) {
+            ret = bme680.read(sample);
+        }
+        if (ret != 0) {
+            // Stale or missing readings are not stored or sent
+            LOG_WRN("Sampling failed: %d, sample skipped", ret);
+            waitNextSample();
+            continue;
+        }
+
+        LOG_INF("BME680 readings\n\tT: %d.%02d degC; P: %u Pa; H: %u.%03u %%RH; G: %u ohm",
+                sample.temperature / 100, abs(sample.temperature % 100), sample.pressure,
+                sample.humidity / 1000, sample.humidity % 1000, sample.gasResistance);
+#ifndef CONFIG_APP_LED
+        LOG_INF("LED toggled.");
+#endif
+#ifdef CONFIG_APP_IAQ
+        // Every raw sample, before aggregation and the deadband
+        Services::AirQuality::Result airResult = airQuality.add(sample);
+        LOG_INF("IAQ %u, accuracy %s", airResult.iaq, Services::AirQuality::accuracyName(airResult.accuracy));
+#endif
+
+#ifdef CONFIG_APP_AGGREGATE
+        // One record per window, unless raw samples were asked for
+        Services::Sample record;
+        if (aggregator.add(sample, record)) {
+            forward(record);
+        }
+#else
+        forward(sample);
+#endif
+
+        waitNextSample();
     }
     return 0;
 }
\ No newline at end of file
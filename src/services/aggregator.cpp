@@ -0,0 +1,121 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+#include <errno.h>
+// App modules
+#include "aggregator.h"
+#include "settings_storage.h"
+
+using Services::Aggregator;
+using Services::RunningStats;
+using Services::Sample;
+using Services::SettingsStorage;
+
+LOG_MODULE_REGISTER(aggregator, LOG_LEVEL_INF);
+
+/**< Restores the raw mode when settings_load() runs. */
+static int aggregateRootHandleSet(const char *name, size_t length, settings_read_cb readCallBack,
+                                  void *callBackArguments) {
+    const char *next;
+    uint8_t raw;
+
+    if (settings_name_steq(name, "raw", &next) && !next) {
+        if (length != sizeof(raw)) {
+            return -EINVAL;
+        }
+        int rc = readCallBack(callBackArguments, &raw, sizeof(raw));
+        if (rc < 0) {
+            return rc;
+        }
+        Aggregator::getInstance().setRaw(raw != 0);
+        return 0;
+    }
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(aggregateRootHandle, "aggregate", nullptr, aggregateRootHandleSet, nullptr, nullptr);
+
+constinit Aggregator Aggregator::instance;
+
+bool Aggregator::add(const Sample &sample, Sample &record) {
+    if (current.temperature.count() == 0) {
+        current.firstTimestamp = sample.timestamp;
+    }
+    current.lastTimestamp = sample.timestamp;
+    current.temperature.add(sample.temperature);
+    current.pressure.add(sample.pressure);
+    current.humidity.add(sample.humidity);
+    current.gasResistance.add(sample.gasResistance);
+
+    bool full = current.temperature.count() >= WINDOW_SAMPLES ||
+                sample.timestamp - current.firstTimestamp >= WINDOW_MS;
+    if (full) {
+        close();
+    }
+
+    if (isRaw()) {
+        record = sample;
+        return true;
+    }
+    if (!full) {
+        return false;
+    }
+    record = {
+        .timestamp     = closed.lastTimestamp,
+        .temperature   = static_cast<int32_t>(closed.temperature.mean()),
+        .pressure      = static_cast<uint32_t>(closed.pressure.mean()),
+        .humidity      = static_cast<uint32_t>(closed.humidity.mean()),
+        .gasResistance = static_cast<uint32_t>(closed.gasResistance.mean()),
+    };
+    return true;
+}
+
+static void logChannel(const char *name, const RunningStats &stats) {
+    LOG_INF("  %s: min %lld, max %lld, mean %lld, variance %llu, last %lld", name, stats.min(), stats.max(),
+            stats.mean(), stats.variance(), stats.last());
+}
+
+void Aggregator::close() {
+    closed = current;
+    current.temperature.reset();
+    current.pressure.reset();
+    current.humidity.reset();
+    current.gasResistance.reset();
+    windows++;
+
+    LOG_INF("Window %u: %u samples from %u to %u ms", windows, closed.temperature.count(), closed.firstTimestamp,
+            closed.lastTimestamp);
+    logChannel("T", closed.temperature);
+    logChannel("P", closed.pressure);
+    logChannel("H", closed.humidity);
+    logChannel("G", closed.gasResistance);
+}
+
+#ifdef CONFIG_SHELL
+static int rawCommand(const struct shell *sh, size_t argc, char **argv) {
+    uint8_t raw;
+    if (strcmp(argv[1], "on") == 0) {
+        raw = 1;
+    } else if (strcmp(argv[1], "off") == 0) {
+        raw = 0;
+    } else {
+        shell_error(sh, "Expected on or off");
+        return -EINVAL;
+    }
+    Aggregator::getInstance().setRaw(raw != 0);
+    int error = SettingsStorage::getInstance().SetKey(Aggregator::KEY_RAW, &raw, sizeof(raw));
+    shell_print(sh, "Raw samples %s%s", raw ? "on" : "off", error ? ", not persisted" : "");
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(aggregateCommands,
+                               SHELL_CMD_ARG(raw, NULL, "Pass every sample on: raw <on|off>", rawCommand, 2, 0),
+                               SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(aggregate, &aggregateCommands, "Sample aggregation", NULL);
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+#include <string_view>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+// App modules
+#include "running_stats.h"
+#include "sample.h"
+
+namespace Services {
+    /**< Windowed aggregation of the sample stream.
+     *
+     * Every sample goes into the running statistics of its window, one RunningStats per channel. A
+     * window closes after CONFIG_APP_AGGREGATE_WINDOW_SECONDS or CONFIG_APP_AGGREGATE_WINDOW_SAMPLES
+     * samples, whichever comes first, and then yields one sample of the channel means for the sample
+     * log and the uplink instead of all of its raw samples. The min, max, variance and last value of
+     * every channel are logged and kept until the next window closes, BulkTransfer reads them into
+     * its stats region. Fixed memory, O(1) per sample.
+     *
+     * In raw mode, for debugging, every sample is passed on as it is, the windows still close. The
+     * mode is persisted under KEY_RAW and set from the shell with "aggregate raw <on|off>".
+     */
+    class Aggregator {
+      public:
+        using key_t                              = std::string_view;
+        constexpr static key_t KEY_RAW           = "aggregate/raw";
+        static constexpr uint32_t WINDOW_MS      = CONFIG_APP_AGGREGATE_WINDOW_SECONDS * MSEC_PER_SEC;
+        static constexpr uint32_t WINDOW_SAMPLES = CONFIG_APP_AGGREGATE_WINDOW_SAMPLES;
+
+        struct Window {
+            uint32_t firstTimestamp;
+            uint32_t lastTimestamp;
+            RunningStats temperature;
+            RunningStats pressure;
+            RunningStats humidity;
+            RunningStats gasResistance;
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Aggregator(const Aggregator &)            = delete;
+        Aggregator &operator=(const Aggregator &) = delete;
+        static Aggregator &getInstance() { return instance; }
+
+        /**< Add a sample. Returns true with the record to store and send: the means of the window the
+         * sample closed, stamped with its last sample, or in raw mode the sample itself. Main loop only.
+         */
+        bool add(const Sample &sample, Sample &record);
+        /**< The window closed last, all zero before the first one closed. */
+        const Window &lastWindow() const { return closed; }
+        uint32_t windowsClosed() const { return windows; }
+
+        /**< Pass every sample on instead of one per window. Does not persist the mode. */
+        void setRaw(bool enabled) { atomic_set(&raw, enabled ? 1 : 0); }
+        bool isRaw() const { return atomic_get(&raw) != 0; }
+
+      private:
+        constexpr Aggregator() = default;
+        static Aggregator instance;
+        void close();
+
+        Window current{};
+        Window closed{};
+        uint32_t windows = 0;
+        atomic_t raw     = ATOMIC_INIT(0);
+    };
+} // namespace Services
@@ -0,0 +1,82 @@
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <errno.h>
+// App modules
+#include "air_quality.h"
+#include "settings_storage.h"
+
+using Services::AirQuality;
+using Services::IaqEstimator;
+using Services::SettingsStorage;
+
+LOG_MODULE_REGISTER(air_quality, LOG_LEVEL_INF);
+
+/**< Restores the estimator state when settings_load() runs. */
+static int iaqRootHandleSet(const char *name, size_t length, settings_read_cb readCallBack,
+                            void *callBackArguments) {
+    const char *next;
+    IaqEstimator::State state;
+
+    if (settings_name_steq(name, "state", &next) && !next) {
+        if (length != sizeof(state)) {
+            return -EINVAL;
+        }
+        int rc = readCallBack(callBackArguments, &state, sizeof(state));
+        if (rc < 0) {
+            return rc;
+        }
+        AirQuality::getInstance().restore(state);
+        return 0;
+    }
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(iaqRootHandle, "iaq", nullptr, iaqRootHandleSet, nullptr, nullptr);
+
+constinit AirQuality AirQuality::instance;
+K_WORK_DEFINE(AirQuality::checkpointWork, AirQuality::checkpointHandler);
+
+const char *AirQuality::accuracyName(Accuracy accuracy) {
+    switch (accuracy) {
+    case Accuracy::Unreliable:
+        return "unreliable";
+    case Accuracy::Low:
+        return "low";
+    case Accuracy::Medium:
+        return "medium";
+    case Accuracy::High:
+        return "high";
+    }
+    return "unknown";
+}
+
+void AirQuality::restore(const IaqEstimator::State &state) {
+    estimator.restore(state);
+    LOG_INF("Restored IAQ baseline %d/65536 log2 ohm, %u samples learned", state.baseline, state.learned);
+}
+
+AirQuality::Result AirQuality::add(const Sample &sample) {
+    result = estimator.add(sample.gasResistance, sample.humidity);
+
+    if (!checkpointed) {
+        checkpointed   = true;
+        lastCheckpoint = sample.timestamp;
+    } else if (sample.timestamp - lastCheckpoint >= CONFIG_APP_IAQ_CHECKPOINT_MINUTES * 60U * MSEC_PER_SEC &&
+               !k_work_is_pending(&checkpointWork)) {
+        // The copy only changes at the next checkpoint, long after the work wrote it
+        checkpoint     = estimator.state();
+        lastCheckpoint = sample.timestamp;
+        k_work_submit(&checkpointWork);
+    }
+    return result;
+}
+
+void AirQuality::checkpointHandler(struct k_work *work) {
+    AirQuality &self = getInstance();
+    int error        = SettingsStorage::getInstance().SetKey(KEY_STATE, &self.checkpoint, sizeof(self.checkpoint));
+    if (error) {
+        LOG_WRN("Failed to checkpoint IAQ state: %d", error);
+    }
+}
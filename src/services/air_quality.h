@@ -0,0 +1,50 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+#include <string_view>
+// Zephyr modules
+#include <zephyr/kernel.h>
+// App modules
+#include "iaq_estimator.h"
+#include "sample.h"
+
+namespace Services {
+    /**< Air quality index of the sample stream, see IaqEstimator.
+     *
+     * The estimator state, the gas baseline and how long it was learned, is restored from KEY_STATE
+     * when the settings load and checkpointed back every CONFIG_APP_IAQ_CHECKPOINT_MINUTES, from the
+     * system work queue, so a reboot does not start the baseline over. At the default of an hour
+     * that is 24 small settings writes a day.
+     */
+    class AirQuality {
+      public:
+        using key_t                      = std::string_view;
+        constexpr static key_t KEY_STATE = "iaq/state";
+        using Accuracy                   = IaqEstimator::Accuracy;
+        using Result                     = IaqEstimator::Result;
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        AirQuality(const AirQuality &)            = delete;
+        AirQuality &operator=(const AirQuality &) = delete;
+        static AirQuality &getInstance() { return instance; }
+
+        /**< Estimate the index of a sample. Main loop only. */
+        Result add(const Sample &sample);
+        const Result &latest() const { return result; }
+        /**< Apply a state loaded from the settings, before the first add(). */
+        void restore(const IaqEstimator::State &state);
+        static const char *accuracyName(Accuracy accuracy);
+
+      private:
+        constexpr AirQuality() = default;
+        static AirQuality instance;
+        static void checkpointHandler(struct k_work *work);
+
+        static struct k_work checkpointWork;
+        IaqEstimator estimator{CONFIG_APP_IAQ_WARMUP_SAMPLES};
+        IaqEstimator::State checkpoint = {};
+        Result result                  = {};
+        uint32_t lastCheckpoint        = 0; // sample stamp
+        bool checkpointed              = false;
+    };
+} // namespace Services
@@ -0,0 +1,165 @@
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+// App modules
+#include "battery.h"
+#include "bus_scheduler.h"
+
+using Services::Battery;
+using Services::BusScheduler;
+
+LOG_MODULE_REGISTER(battery, LOG_LEVEL_INF);
+
+static constexpr int64_t MS_PER_HOUR = 3600LL * 1000LL;
+static constexpr int64_t TARGET_MS   = CONFIG_APP_BATTERY_TARGET_DAYS * 24LL * MS_PER_HOUR;
+
+constinit Battery Battery::instance;
+K_WORK_DELAYABLE_DEFINE(Battery::updateWork, Battery::updateHandler);
+static K_MUTEX_DEFINE(lock);
+
+const char *Battery::chargerName(Charger charger) {
+    switch (charger) {
+    case Charger::Off:
+        return "off";
+    case Charger::Trickle:
+        return "trickle";
+    case Charger::FastConstantCurrent:
+        return "fast cc";
+    case Charger::FastConstantVoltage:
+        return "fast cv";
+    case Charger::Complete:
+        return "complete";
+    case Charger::LdoMode:
+        return "ldo";
+    case Charger::TimerExpired:
+        return "timer expired";
+    case Charger::BatteryDetection:
+        return "battery detection";
+    }
+    return "unknown";
+}
+
+bool Battery::isExternallyPowered(Charger charger) { return charger != Charger::Off; }
+
+int Battery::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+    if (!BusScheduler::getInstance().isInitialized()) {
+        LOG_ERR("BusScheduler not initialized");
+        return -EAGAIN;
+    }
+
+    /* The first bus window runs with the first sample, read the battery right after it. */
+    k_work_schedule(&updateWork, K_SECONDS(1));
+    initialized = true;
+    LOG_INF("Initialized Battery: target %d days, period scale up to %d%%", CONFIG_APP_BATTERY_TARGET_DAYS,
+            CONFIG_APP_BATTERY_MAX_PERIOD_SCALE);
+    return 0;
+}
+
+int Battery::addListener(Listener listener) {
+    if (listenerCount == ARRAY_SIZE(listeners)) {
+        return -ENOMEM;
+    }
+    listeners[listenerCount++] = listener;
+    return 0;
+}
+
+Battery::Status Battery::status() const {
+    k_mutex_lock(&lock, K_FOREVER);
+    Status copy = current;
+    k_mutex_unlock(&lock);
+    return copy;
+}
+
+/**< The scale is corrected by how far the projected runtime falls short of the target, the
+ * discharge rate being measured over at least CONFIG_APP_BATTERY_MIN_DROP_PERCENT so the 1 %
+ * resolution of the fuel gauge does not dominate. Each correction starts a new measurement, so
+ * the next one sees the effect of the current scale.
+ */
+uint16_t Battery::adjustScale(const Status &reading) {
+    int64_t scale = current.periodScale;
+
+    if (isExternallyPowered(reading.charger)) {
+        discharging = false;
+        current.projectedHours = 0;
+        return NOMINAL_SCALE;
+    }
+    if (!discharging) {
+        discharging   = true;
+        targetEnd     = reading.time + TARGET_MS;
+        referenceTime = reading.time;
+        referenceSoc  = reading.soc;
+        current.projectedHours = 0;
+        LOG_INF("Discharging from %u%%, the charge should last until %lld h from now", reading.soc,
+                TARGET_MS / MS_PER_HOUR);
+        return static_cast<uint16_t>(scale);
+    }
+
+    if (reading.soc <= CONFIG_APP_BATTERY_CRITICAL_SOC) {
+        return CONFIG_APP_BATTERY_MAX_PERIOD_SCALE;
+    }
+
+    int64_t elapsed = reading.time - referenceTime;
+    int32_t used    = static_cast<int32_t>(referenceSoc) - reading.soc;
+    if (used < CONFIG_APP_BATTERY_MIN_DROP_PERCENT || elapsed <= 0) {
+        return static_cast<uint16_t>(scale);
+    }
+
+    int64_t projected      = elapsed * reading.soc / used;
+    int64_t needed         = targetEnd - reading.time;
+    current.projectedHours = static_cast<uint32_t>(projected / MS_PER_HOUR);
+    if (needed > 0) {
+        /* Halfway to the correction, the consumption does not scale down entirely with the periods. */
+        int64_t corrected = scale * needed / MAX(projected, int64_t{1});
+        corrected         = CLAMP(corrected, int64_t{NOMINAL_SCALE}, CONFIG_APP_BATTERY_MAX_PERIOD_SCALE);
+        scale             = (scale + corrected) / 2;
+    }
+    referenceTime = reading.time;
+    referenceSoc  = reading.soc;
+    return static_cast<uint16_t>(CLAMP(scale, int64_t{NOMINAL_SCALE}, CONFIG_APP_BATTERY_MAX_PERIOD_SCALE));
+}
+
+void Battery::update() {
+    BusScheduler::Snapshot snapshot = BusScheduler::getInstance().snapshot();
+
+    if (!snapshot.batteryValid) {
+        LOG_WRN("No fuel gauge reading yet");
+        return;
+    }
+
+    Status reading = {
+        .time           = snapshot.time,
+        .soc            = snapshot.batterySoc,
+        .millivolts     = snapshot.batteryMv,
+        .charger        = static_cast<Charger>(snapshot.chargerStatus),
+        .periodScale    = NOMINAL_SCALE,
+        .projectedHours = 0,
+    };
+
+    k_mutex_lock(&lock, K_FOREVER);
+    uint16_t previousScale = current.periodScale;
+    uint16_t scale         = adjustScale(reading);
+    reading.periodScale    = scale;
+    reading.projectedHours = current.projectedHours;
+    current                = reading;
+    k_mutex_unlock(&lock);
+
+    if (scale != previousScale) {
+        LOG_INF("Battery %u%% %u mV, charger %s, projected %u h: periods at %u%%", reading.soc,
+                reading.millivolts, chargerName(reading.charger), reading.projectedHours, scale);
+    }
+    for (size_t i = 0; i < listenerCount; i++) {
+        listeners[i](reading);
+    }
+}
+
+void Battery::updateHandler(struct k_work *work) {
+    Battery &self = getInstance();
+
+    self.update();
+    k_work_schedule(&self.updateWork, K_SECONDS(CONFIG_APP_BATTERY_UPDATE_SECONDS));
+}
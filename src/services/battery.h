@@ -0,0 +1,75 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/kernel.h>
+
+namespace Services {
+    /**< Battery state from the ADP5360 and the duty cycle policy derived from it.
+     *
+     * Every CONFIG_APP_BATTERY_UPDATE_SECONDS the state of charge, voltage and charger status read
+     * by BusScheduler are published to the listeners, together with a period scale. The scale
+     * stretches the sampling and uplink periods so the charge lasts CONFIG_APP_BATTERY_TARGET_DAYS
+     * from the moment the charger was disconnected, or from boot. It is derived from the discharge
+     * rate measured since the previous adjustment, so the throughput drops step by step as the
+     * battery drains faster than planned instead of the device dying at a fixed rate.
+     */
+    class Battery {
+      public:
+        /**< ADP5360 CHARGER_STATUS1 charger state. */
+        enum class Charger : uint8_t {
+            Off,
+            Trickle,
+            FastConstantCurrent,
+            FastConstantVoltage,
+            Complete,
+            LdoMode,
+            TimerExpired,
+            BatteryDetection,
+        };
+
+        struct Status {
+            int64_t time; // k_uptime_get() of the reading
+            uint8_t soc;  // %
+            uint16_t millivolts;
+            Charger charger;
+            uint16_t periodScale;    // percent of the nominal periods, 100 or more
+            uint32_t projectedHours; // at the measured discharge rate, 0 while unknown
+        };
+        using Listener = void (*)(const Status &status);
+
+        static constexpr uint16_t NOMINAL_SCALE = 100;
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Battery(const Battery &)            = delete;
+        Battery &operator=(const Battery &) = delete;
+        static Battery &getInstance() { return instance; }
+        int init();
+        /**< Listeners are called from the system work queue after every update. */
+        int addListener(Listener listener);
+
+        Status status() const;
+        static bool isExternallyPowered(Charger charger);
+        static const char *chargerName(Charger charger);
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr Battery() = default;
+        static Battery instance;
+        static void updateHandler(struct k_work *work);
+        void update();
+        uint16_t adjustScale(const Status &reading);
+
+        static struct k_work_delayable updateWork;
+        Status current = {.time = 0, .soc = 0, .millivolts = 0, .charger = Charger::Off,
+                          .periodScale = NOMINAL_SCALE, .projectedHours = 0};
+        int64_t targetEnd      = 0; // k_uptime_get() the charge should last until
+        int64_t referenceTime  = 0; // start of the discharge rate measurement
+        uint8_t referenceSoc   = 0;
+        bool discharging       = false;
+        Listener listeners[CONFIG_APP_BATTERY_MAX_LISTENERS] = {};
+        size_t listenerCount = 0;
+        bool initialized     = false;
+    };
+} // namespace Services
@@ -0,0 +1,409 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/mgmt/mcumgr/mgmt/handlers.h>
+#include <zephyr/mgmt/mcumgr/mgmt/mgmt.h>
+#include <zephyr/mgmt/mcumgr/smp/smp.h>
+#include <zephyr/storage/flash_map.h>
+#ifdef CONFIG_HWINFO
+#include <zephyr/drivers/hwinfo.h>
+#endif
+#if defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#include <pm_config.h>
+#endif
+#include <errno.h>
+#include <zcbor_common.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+// App modules
+#include "bulk_transfer.h"
+#include "time_service.h"
+#ifdef CONFIG_APP_SAMPLE_LOG
+#include "sample_log.h"
+#endif
+#ifdef CONFIG_APP_UPLINK
+#include "uplink.h"
+#endif
+#ifdef CONFIG_APP_UPLINK_QUEUE
+#include "uplink_queue.h"
+#endif
+#ifdef CONFIG_APP_BUS_SCHEDULER
+#include "bus_scheduler.h"
+#endif
+#ifdef CONFIG_APP_IMPACT
+#include "impact.h"
+#endif
+#ifdef CONFIG_APP_DEADBAND
+#include "deadband_filter.h"
+#endif
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+#ifdef CONFIG_APP_AGGREGATE
+#include "aggregator.h"
+#endif
+
+using Services::BulkTransfer;
+using Services::TimeService;
+using Services::SystemManager;
+#ifdef CONFIG_APP_SAMPLE_LOG
+using Services::SampleLog;
+#endif
+#ifdef CONFIG_APP_UPLINK
+using Services::Uplink;
+#endif
+#ifdef CONFIG_APP_UPLINK_QUEUE
+using Services::UplinkQueue;
+#endif
+#ifdef CONFIG_APP_BUS_SCHEDULER
+using Services::BusScheduler;
+#endif
+#ifdef CONFIG_APP_IMPACT
+using Services::Impact;
+#endif
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+#ifdef CONFIG_APP_DEADBAND
+using Services::Channel;
+using Services::DeadbandFilter;
+#endif
+#ifdef CONFIG_APP_AGGREGATE
+using Services::Aggregator;
+using Services::RunningStats;
+#endif
+
+LOG_MODULE_REGISTER(bulk_transfer, LOG_LEVEL_INF);
+
+/* Same partitions as SampleLog and UplinkQueue, see sample_log.cpp and uplink_queue.cpp. */
+#if defined(PM_SAMPLE_LOG_ID)
+#define SAMPLE_LOG_PARTITION_ID PM_SAMPLE_LOG_ID
+#elif !defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#define SAMPLE_LOG_PARTITION_ID FIXED_PARTITION_ID(sample_log_partition)
+#endif
+#if defined(PM_UPLINK_QUEUE_ID)
+#define UPLINK_QUEUE_PARTITION_ID PM_UPLINK_QUEUE_ID
+#elif !defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#define UPLINK_QUEUE_PARTITION_ID FIXED_PARTITION_ID(uplink_queue_partition)
+#endif
+
+#define REGION_COUNT static_cast<size_t>(BulkTransfer::Region::Count)
+
+/**< Speeds the nRF UARTE runs at without error, checked before the response is sent since a
+ * failing uart_configure() could not be reported afterwards.
+ */
+static constexpr uint32_t BAUDRATES[] = {115200, 230400, 460800, 921600, 1000000};
+
+const struct mgmt_handler BulkTransfer::handlers[] = {
+    {infoHandler, nullptr},
+    {readHandler, nullptr},
+    {nullptr, baudHandler},
+};
+
+constinit BulkTransfer BulkTransfer::instance;
+K_WORK_DELAYABLE_DEFINE(BulkTransfer::baudWork, BulkTransfer::applyBaudHandler);
+K_WORK_DELAYABLE_DEFINE(BulkTransfer::sessionWork, BulkTransfer::sessionHandler);
+
+int BulkTransfer::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    struct uart_config config;
+    int error = uart_config_get(uart, &config);
+    if (error) {
+        LOG_ERR("Failed to get the mcumgr UART configuration: %d", error);
+        return error;
+    }
+    bootBaudrate = config.baudrate;
+
+    /* A region without a partition in this layout reads as empty. */
+#if defined(CONFIG_APP_SAMPLE_LOG) && defined(SAMPLE_LOG_PARTITION_ID)
+    error = flash_area_open(SAMPLE_LOG_PARTITION_ID, &sampleLog);
+    if (error) {
+        LOG_ERR("Failed to open the sample log partition: %d", error);
+        return error;
+    }
+#endif
+#if defined(CONFIG_APP_UPLINK_QUEUE) && defined(UPLINK_QUEUE_PARTITION_ID)
+    error = flash_area_open(UPLINK_QUEUE_PARTITION_ID, &uplinkQueue);
+    if (error) {
+        LOG_ERR("Failed to open the uplink queue partition: %d", error);
+        return error;
+    }
+#endif
+
+    group.mg_handlers       = handlers;
+    group.mg_handlers_count = ARRAY_SIZE(handlers);
+    group.mg_group_id       = CONFIG_APP_BULK_TRANSFER_GROUP_ID;
+    mgmt_register_group(&group);
+
+    initialized = true;
+    LOG_INF("Initialized BulkTransfer: SMP group %d, %u byte chunks at %u baud", CONFIG_APP_BULK_TRANSFER_GROUP_ID,
+            static_cast<unsigned int>(CHUNK_SIZE), bootBaudrate);
+    return 0;
+}
+
+void BulkTransfer::mark(BootStage stage) {
+    if (stage == BootStage::Main) {
+#ifdef CONFIG_HWINFO
+        (void)hwinfo_get_reset_cause(&boot.resetCause);
+        (void)hwinfo_clear_reset_cause();
+#endif
+    }
+    boot.stageUs[static_cast<size_t>(stage)] = k_ticks_to_us_floor32(k_uptime_ticks());
+}
+
+void BulkTransfer::collectStats() {
+    stats = {.uptimeMs = k_uptime_get_32()};
+#ifdef CONFIG_APP_SAMPLE_LOG
+    const SampleLog &log   = SampleLog::getInstance();
+    stats.sampleLogBatches = log.batchesWritten();
+    stats.sampleLogErases  = log.sectorsErased();
+#endif
+#ifdef CONFIG_APP_UPLINK
+    Uplink::Stats uplinkStats = Uplink::getInstance().stats();
+    stats.uplinkSessions      = uplinkStats.sessions;
+    stats.uplinkSamples       = uplinkStats.samples;
+    stats.uplinkBytes         = uplinkStats.bytes;
+    stats.uplinkFailures      = uplinkStats.failures;
+    stats.uplinkDropped       = uplinkStats.dropped;
+#endif
+#ifdef CONFIG_APP_UPLINK_QUEUE
+    const UplinkQueue &queue = UplinkQueue::getInstance();
+    stats.queuePending       = queue.pending();
+    stats.queueDropped       = queue.droppedPayloads();
+    stats.queueDownsampled   = queue.downsampledPayloads();
+#endif
+#ifdef CONFIG_APP_BUS_SCHEDULER
+    stats.busWindows = BusScheduler::getInstance().windows();
+#endif
+#ifdef CONFIG_APP_IMPACT
+    stats.impacts = Impact::getInstance().impacts();
+#endif
+#ifdef CONFIG_APP_ENERGY
+    stats.energyMicroAmps = EnergyLedger::getInstance().totalMicroAmps();
+#endif
+#ifdef CONFIG_APP_DEADBAND
+    const DeadbandFilter &deadband = DeadbandFilter::getInstance();
+    for (size_t i = 0; i < DeadbandFilter::CHANNEL_COUNT; i++) {
+        DeadbandFilter::Counters counters = deadband.counters(static_cast<Channel>(i));
+        stats.deadbandForwarded[i]        = counters.forwarded;
+        stats.deadbandHeartbeats[i]       = counters.heartbeats;
+        stats.deadbandDropped[i]          = counters.dropped;
+    }
+#endif
+#ifdef CONFIG_APP_AGGREGATE
+    const Aggregator &aggregator     = Aggregator::getInstance();
+    const Aggregator::Window &window = aggregator.lastWindow();
+    stats.windowsClosed              = aggregator.windowsClosed();
+    stats.windowSamples              = window.temperature.count();
+    stats.windowFirstTimestamp       = window.firstTimestamp;
+    stats.windowLastTimestamp        = window.lastTimestamp;
+    const RunningStats *channels[]   = {&window.temperature, &window.pressure, &window.humidity,
+                                        &window.gasResistance};
+    for (size_t i = 0; i < ARRAY_SIZE(channels); i++) {
+        // The channels are 32-bit readings, so are their min, max and last
+        stats.windowMin[i]      = static_cast<int32_t>(channels[i]->min());
+        stats.windowMax[i]      = static_cast<int32_t>(channels[i]->max());
+        stats.windowLast[i]     = static_cast<int32_t>(channels[i]->last());
+        stats.windowVariance[i] = static_cast<uint32_t>(MIN(channels[i]->variance(), UINT32_MAX));
+    }
+#endif
+}
+
+size_t BulkTransfer::regionSize(Region region) const {
+    switch (region) {
+    case Region::SampleLog:
+        return sampleLog != nullptr ? sampleLog->fa_size : 0;
+    case Region::UplinkQueue:
+        return uplinkQueue != nullptr ? uplinkQueue->fa_size : 0;
+    case Region::Stats:
+        return sizeof(Stats);
+    case Region::BootProfile:
+        return sizeof(BootProfile);
+    default:
+        return 0;
+    }
+}
+
+int BulkTransfer::readRegion(Region region, uint32_t offset, uint8_t *buffer, size_t length) {
+    switch (region) {
+    case Region::SampleLog:
+        return flash_area_read(sampleLog, offset, buffer, length);
+    case Region::UplinkQueue:
+        return flash_area_read(uplinkQueue, offset, buffer, length);
+    case Region::Stats:
+        // One snapshot for the whole region, it always fits in a chunk
+        if (offset == 0) {
+            collectStats();
+        }
+        memcpy(buffer, reinterpret_cast<const uint8_t *>(&stats) + offset, length);
+        return 0;
+    case Region::BootProfile:
+        if (offset == 0) {
+            TimeService::Correction correction;
+            if (TimeService::getInstance().correction(correction) == 0) {
+                boot.syncStamp = correction.stamp;
+                boot.syncUtcMs = correction.utcMs;
+            }
+            const SystemManager &system = SystemManager::getInstance();
+            for (size_t i = 0; i < SystemManager::SERVICE_COUNT; i++) {
+                boot.serviceUs[i] = system.record(static_cast<SystemManager::ServiceId>(i)).durationUs;
+            }
+        }
+        memcpy(buffer, reinterpret_cast<const uint8_t *>(&boot) + offset, length);
+        return 0;
+    default:
+        return -EINVAL;
+    }
+}
+
+/**< Decode a request map of unsigned values, leaving the values of missing keys untouched. */
+static bool decodeRequest(zcbor_state_t *zsd, const char *const keys[], uint32_t *const values[], size_t count) {
+    if (!zcbor_map_start_decode(zsd)) {
+        return false;
+    }
+    while (!zcbor_array_at_end(zsd)) {
+        struct zcbor_string key;
+        uint32_t value;
+        if (!zcbor_tstr_decode(zsd, &key) || !zcbor_uint32_decode(zsd, &value)) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (key.len == strlen(keys[i]) && memcmp(key.value, keys[i], key.len) == 0) {
+                *values[i] = value;
+            }
+        }
+    }
+    return zcbor_map_end_decode(zsd);
+}
+
+void BulkTransfer::touchSession() {
+    k_work_reschedule(&sessionWork, K_SECONDS(CONFIG_APP_BULK_TRANSFER_SESSION_SECONDS));
+}
+
+int BulkTransfer::infoHandler(struct smp_streamer *ctxt) {
+    BulkTransfer &self = getInstance();
+    zcbor_state_t *zse = ctxt->writer->zs;
+    uint32_t sectors[REGION_COUNT] = {};
+
+    self.touchSession();
+    const struct flash_area *areas[] = {self.sampleLog, self.uplinkQueue};
+    for (size_t i = 0; i < ARRAY_SIZE(areas); i++) {
+        struct flash_pages_info page;
+        if (areas[i] != nullptr &&
+            flash_get_page_info_by_offs(flash_area_get_device(areas[i]), areas[i]->fa_off, &page) == 0) {
+            sectors[i] = page.size;
+        }
+    }
+
+    bool ok = zcbor_tstr_put_lit(zse, "chunk") && zcbor_uint32_put(zse, CHUNK_SIZE) &&
+              zcbor_tstr_put_lit(zse, "sizes") && zcbor_list_start_encode(zse, REGION_COUNT);
+    for (size_t i = 0; ok && i < REGION_COUNT; i++) {
+        ok = zcbor_uint32_put(zse, self.regionSize(static_cast<Region>(i)));
+    }
+    ok = ok && zcbor_list_end_encode(zse, REGION_COUNT) && zcbor_tstr_put_lit(zse, "sectors") &&
+         zcbor_list_start_encode(zse, REGION_COUNT);
+    for (size_t i = 0; ok && i < REGION_COUNT; i++) {
+        ok = zcbor_uint32_put(zse, sectors[i]);
+    }
+    ok = ok && zcbor_list_end_encode(zse, REGION_COUNT);
+    return ok ? MGMT_ERR_EOK : MGMT_ERR_EMSGSIZE;
+}
+
+int BulkTransfer::readHandler(struct smp_streamer *ctxt) {
+    BulkTransfer &self = getInstance();
+    zcbor_state_t *zsd = ctxt->reader->zs;
+    zcbor_state_t *zse = ctxt->writer->zs;
+    uint32_t region    = REGION_COUNT;
+    uint32_t offset    = 0;
+    uint32_t length    = CHUNK_SIZE;
+
+    static const char *const keys[] = {"r", "off", "len"};
+    uint32_t *const values[]        = {&region, &offset, &length};
+    if (!decodeRequest(zsd, keys, values, ARRAY_SIZE(keys)) || region >= REGION_COUNT) {
+        return MGMT_ERR_EINVAL;
+    }
+    self.touchSession();
+
+    size_t size = self.regionSize(static_cast<Region>(region));
+    if (offset > size) {
+        return MGMT_ERR_EINVAL;
+    }
+    length = MIN(MIN(length, CHUNK_SIZE), size - offset);
+
+    /* The data is read straight into the response: the byte string header is written for the
+     * largest possible length and fixed up by zcbor_bstr_end_encode() once the bytes are in place.
+     */
+    bool ok = zcbor_tstr_put_lit(zse, "off") && zcbor_uint32_put(zse, offset) && zcbor_tstr_put_lit(zse, "data") &&
+              zcbor_bstr_start_encode(zse);
+    if (!ok || static_cast<size_t>(zse->payload_end - zse->payload) < length) {
+        return MGMT_ERR_EMSGSIZE;
+    }
+    int error = self.readRegion(static_cast<Region>(region), offset, zse->payload_mut, length);
+    if (error) {
+        LOG_ERR("Failed to read region %u at %u: %d", region, offset, error);
+        return MGMT_ERR_EUNKNOWN;
+    }
+    zse->payload_mut += length;
+    return zcbor_bstr_end_encode(zse, nullptr) ? MGMT_ERR_EOK : MGMT_ERR_EMSGSIZE;
+}
+
+int BulkTransfer::baudHandler(struct smp_streamer *ctxt) {
+    BulkTransfer &self = getInstance();
+    zcbor_state_t *zsd = ctxt->reader->zs;
+    zcbor_state_t *zse = ctxt->writer->zs;
+    uint32_t baudrate  = 0;
+
+    static const char *const keys[] = {"baud"};
+    uint32_t *const values[]        = {&baudrate};
+    if (!decodeRequest(zsd, keys, values, ARRAY_SIZE(keys))) {
+        return MGMT_ERR_EINVAL;
+    }
+    bool supported = false;
+    for (uint32_t candidate : BAUDRATES) {
+        supported |= candidate == baudrate;
+    }
+    if (!supported) {
+        return MGMT_ERR_ENOTSUP;
+    }
+
+    // The response goes out at the current speed, the new one applies once it has been sent
+    self.nextBaudrate = baudrate;
+    k_work_reschedule(&self.baudWork, K_MSEC(CONFIG_APP_BULK_TRANSFER_BAUD_DELAY_MS));
+    self.touchSession();
+    bool ok = zcbor_tstr_put_lit(zse, "baud") && zcbor_uint32_put(zse, baudrate);
+    return ok ? MGMT_ERR_EOK : MGMT_ERR_EMSGSIZE;
+}
+
+int BulkTransfer::setBaudrate(uint32_t baudrate) {
+    struct uart_config config;
+    int error = uart_config_get(uart, &config);
+    if (error || config.baudrate == baudrate) {
+        return error;
+    }
+    config.baudrate = baudrate;
+    error           = uart_configure(uart, &config);
+    if (error) {
+        LOG_ERR("Failed to set %u baud: %d", baudrate, error);
+        return error;
+    }
+    LOG_INF("mcumgr UART at %u baud", baudrate);
+    return 0;
+}
+
+void BulkTransfer::applyBaudHandler(struct k_work *work) {
+    BulkTransfer &self = getInstance();
+    self.setBaudrate(self.nextBaudrate);
+}
+
+void BulkTransfer::sessionHandler(struct k_work *work) {
+    // The client went quiet without restoring the speed, go back to the one the console expects
+    BulkTransfer &self = getInstance();
+    self.setBaudrate(self.bootBaudrate);
+}
@@ -0,0 +1,116 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/mgmt/mcumgr/mgmt/mgmt.h>
+#include <zephyr/mgmt/mcumgr/smp/smp.h>
+#include <zephyr/storage/flash_map.h>
+// App modules
+#include "system_manager.h"
+
+namespace Services {
+    /**< Bulk retrieval of logged data over mcumgr, in the SMP group CONFIG_APP_BULK_TRANSFER_GROUP_ID.
+     *
+     * Each region is read in chunks of up to CONFIG_APP_BULK_TRANSFER_CHUNK_SIZE bytes. Flash regions
+     * are read by flash_area_read() straight into the response buffer, so the FCB sectors arrive
+     * exactly as stored and the host decodes the records, see scripts/bulk_client.py. The client
+     * keeps a few requests in flight so the UART never idles between chunks, and may raise the UART
+     * speed for the session. It falls back to the boot speed once the client goes quiet.
+     *
+     * Commands, CBOR maps, regions indexed by Region:
+     *   info  (read)  -> {"chunk", "sizes": [...], "sectors": [...]}
+     *   read  (read)  {"r", "off", "len"} -> {"off", "data"}
+     *   baud  (write) {"baud"} -> {"baud"}, applied once the response has been sent
+     */
+    class BulkTransfer {
+      public:
+        static constexpr size_t CHUNK_SIZE = CONFIG_APP_BULK_TRANSFER_CHUNK_SIZE;
+
+        enum class Command : uint8_t { Info, Read, Baud };
+        enum class Region : uint8_t { SampleLog, UplinkQueue, Stats, BootProfile, Count };
+
+        enum class BootStage : uint8_t { Main, Services, Loop, Count };
+
+        /**< Counters of the services, zero for the ones that are not built in. Little endian. */
+        struct __attribute__((packed)) Stats {
+            uint32_t uptimeMs;
+            uint32_t sampleLogBatches;
+            uint32_t sampleLogErases;
+            uint32_t uplinkSessions;
+            uint32_t uplinkSamples;
+            uint32_t uplinkBytes;
+            uint32_t uplinkFailures;
+            uint32_t uplinkDropped;
+            uint32_t queuePending;
+            uint32_t queueDropped;
+            uint32_t queueDownsampled;
+            uint32_t busWindows;
+            uint32_t impacts;
+            uint32_t energyMicroAmps;
+            uint32_t deadbandForwarded[4]; // per Channel
+            uint32_t deadbandHeartbeats[4];
+            uint32_t deadbandDropped[4];
+            // Aggregator::lastWindow(), per Channel
+            uint32_t windowsClosed;
+            uint32_t windowSamples;
+            uint32_t windowFirstTimestamp;
+            uint32_t windowLastTimestamp;
+            int32_t windowMin[4];
+            int32_t windowMax[4];
+            int32_t windowLast[4];
+            uint32_t windowVariance[4]; // UINT32_MAX once saturated
+        };
+
+        /**< Reset cause, the uptime in microseconds when each BootStage was reached, the TimeService
+         * correction the host converts the sample stamps of this boot to UTC with and how long the
+         * init of each SystemManager::ServiceId took.
+         */
+        struct __attribute__((packed)) BootProfile {
+            uint32_t resetCause; // RESET_* flags of the hwinfo API, 0 without CONFIG_HWINFO
+            uint32_t stageUs[static_cast<size_t>(BootStage::Count)];
+            uint32_t syncStamp; // both 0 until the first network time sync
+            int64_t syncUtcMs;
+            uint32_t serviceUs[SystemManager::SERVICE_COUNT]; // 0 for services not built in
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        BulkTransfer(const BulkTransfer &)            = delete;
+        BulkTransfer &operator=(const BulkTransfer &) = delete;
+        static BulkTransfer &getInstance() { return instance; }
+        /**< Register the SMP group. */
+        int init();
+        /**< Record that boot reached stage, callable before init(). */
+        void mark(BootStage stage);
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr BulkTransfer() = default;
+        static BulkTransfer instance;
+        static int infoHandler(struct smp_streamer *ctxt);
+        static int readHandler(struct smp_streamer *ctxt);
+        static int baudHandler(struct smp_streamer *ctxt);
+        static void applyBaudHandler(struct k_work *work);
+        static void sessionHandler(struct k_work *work);
+        int setBaudrate(uint32_t baudrate);
+        void touchSession();
+        void collectStats();
+        size_t regionSize(Region region) const;
+        int readRegion(Region region, uint32_t offset, uint8_t *buffer, size_t length);
+
+        static const struct mgmt_handler handlers[];
+        struct mgmt_group group {};
+        const struct flash_area *sampleLog   = nullptr;
+        const struct flash_area *uplinkQueue = nullptr;
+        const struct device *uart = DEVICE_DT_GET(DT_CHOSEN(zephyr_uart_mcumgr));
+        static struct k_work_delayable baudWork;
+        static struct k_work_delayable sessionWork;
+        uint32_t bootBaudrate = 0;
+        uint32_t nextBaudrate = 0;
+        Stats stats{};
+        BootProfile boot{};
+        bool initialized = false;
+    };
+} // namespace Services
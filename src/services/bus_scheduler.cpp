@@ -0,0 +1,340 @@
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/device_runtime.h>
+#include <zephyr/sys/byteorder.h>
+#include <errno.h>
+// App modules
+#include "bus_scheduler.h"
+#include "sensor.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+using Services::BusScheduler;
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+
+LOG_MODULE_REGISTER(bus_scheduler, LOG_LEVEL_INF);
+
+#define BME680_NODE DT_NODELABEL(bme680)
+#define BH1749_NODE DT_NODELABEL(bh1749)
+#define PMIC_NODE   DT_COMPAT_GET_ANY_STATUS_OKAY(adi_adp5360)
+/* Read on its own SPI bus while the BME680 converts, when the Motion service built its driver in. */
+#if DT_HAS_COMPAT_STATUS_OKAY(adi_adxl362) && defined(CONFIG_ADXL362)
+#define ADXL362_PRESENT 1
+#else
+#define ADXL362_PRESENT 0
+#endif
+
+/* ADP5360 charger status, then the fuel gauge from BAT_SOC up to VBAT_READ_L. */
+#define ADP5360_REG_CHARGER_STATUS1  0x08
+#define ADP5360_CHARGER_STATUS_MASK  0x07
+#define ADP5360_REG_BAT_SOC          0x21
+#define ADP5360_FG_READ_LENGTH       6
+#define ADP5360_BAT_SOC_MASK         0x7F
+
+/* BH1749, RGB at gain x1, IR at gain x1 and 120 ms measurements, then the data registers
+ * RED_DATA_LSBs up to GREEN2 in one read.
+ */
+#define BH1749_REG_MODE_CONTROL1 0x41
+#define BH1749_MODE_CONTROL1_VAL 0x2A
+#define BH1749_MODE_CONTROL2_VAL 0x10 // RGB_EN
+#define BH1749_REG_RED_DATA      0x50
+#define BH1749_DATA_LENGTH       12
+
+constinit BusScheduler BusScheduler::instance;
+static K_MUTEX_DEFINE(lock);
+
+const char *BusScheduler::deviceName(Device device) {
+    switch (device) {
+    case Device::Pmic:
+        return "adp5360";
+    case Device::Bh1749:
+        return "bh1749";
+    case Device::Bme680:
+        return "bme680";
+    case Device::Adxl362:
+        return "adxl362";
+    case Device::Count:
+        break;
+    }
+    return "unknown";
+}
+
+int BusScheduler::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    bus    = DEVICE_DT_GET(DT_NODELABEL(i2c2));
+    bme680 = DEVICE_DT_GET(BME680_NODE);
+    if (!device_is_ready(bus)) {
+        LOG_ERR("i2c2 not ready");
+        return -ENODEV;
+    }
+    if (!device_is_ready(bme680)) {
+        LOG_WRN("BME680 not ready, it is left out of the bus windows");
+        bme680 = nullptr;
+    }
+#if ADXL362_PRESENT
+    adxl362 = DEVICE_DT_GET_ONE(adi_adxl362);
+    if (!device_is_ready(adxl362)) {
+        LOG_WRN("ADXL362 not ready, it is left out of the bus windows");
+        adxl362 = nullptr;
+    }
+#endif
+
+    initialized = true;
+    LOG_INF("Initialized BusScheduler: runtime PM %s",
+            pm_device_runtime_is_enabled(bus) ? "enabled" : "disabled, the bus stays awake");
+    return 0;
+}
+
+int BusScheduler::transfer(Device device, uint16_t address, struct i2c_msg *messages, uint8_t count) {
+    Statistics &statistics = devices[static_cast<size_t>(device)];
+
+    statistics.transactions++;
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::I2c);
+#endif
+    int error = i2c_transfer(bus, messages, count, address);
+    if (error) {
+        statistics.errors++;
+    }
+    return error;
+}
+
+int BusScheduler::readPmic() {
+#if DT_NODE_EXISTS(PMIC_NODE)
+    uint8_t statusReg = ADP5360_REG_CHARGER_STATUS1;
+    uint8_t status;
+    uint8_t fuelGaugeReg = ADP5360_REG_BAT_SOC;
+    uint8_t values[ADP5360_FG_READ_LENGTH];
+    struct i2c_msg messages[] = {
+        {.buf = &statusReg, .len = sizeof(statusReg), .flags = I2C_MSG_WRITE},
+        {.buf = &status, .len = sizeof(status), .flags = I2C_MSG_RESTART | I2C_MSG_READ},
+        {.buf = &fuelGaugeReg, .len = sizeof(fuelGaugeReg), .flags = I2C_MSG_RESTART | I2C_MSG_WRITE},
+        {.buf = values, .len = sizeof(values), .flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP},
+    };
+
+    int error = transfer(Device::Pmic, DT_REG_ADDR(PMIC_NODE), messages, ARRAY_SIZE(messages));
+    if (error) {
+        latest.batteryValid = false;
+        return error;
+    }
+    /* VBAT_READ_H holds bits 12:5 and VBAT_READ_L bits 4:0 in its upper bits, in mV. */
+    latest.chargerStatus = status & ADP5360_CHARGER_STATUS_MASK;
+    latest.batterySoc    = values[0] & ADP5360_BAT_SOC_MASK;
+    latest.batteryMv     = static_cast<uint16_t>((values[4] << 5) | (values[5] >> 3));
+    latest.batteryValid  = true;
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+int BusScheduler::readBh1749() {
+#if DT_NODE_HAS_STATUS_OKAY(BH1749_NODE)
+    constexpr uint16_t address = DT_REG_ADDR(BH1749_NODE);
+
+    if (!bh1749Ready) {
+        /* Register addresses auto-increment, MODE_CONTROL2 follows MODE_CONTROL1. */
+        uint8_t setup[]        = {BH1749_REG_MODE_CONTROL1, BH1749_MODE_CONTROL1_VAL, BH1749_MODE_CONTROL2_VAL};
+        struct i2c_msg message = {.buf = setup, .len = sizeof(setup), .flags = I2C_MSG_WRITE | I2C_MSG_STOP};
+        int error              = transfer(Device::Bh1749, address, &message, 1);
+        if (error) {
+            return error;
+        }
+        /* The first measurement is ready one period later, in the next window. */
+        bh1749Ready = true;
+        return 0;
+    }
+
+    uint8_t reg = BH1749_REG_RED_DATA;
+    uint8_t values[BH1749_DATA_LENGTH];
+    struct i2c_msg messages[] = {
+        {.buf = &reg, .len = sizeof(reg), .flags = I2C_MSG_WRITE},
+        {.buf = values, .len = sizeof(values), .flags = I2C_MSG_RESTART | I2C_MSG_READ | I2C_MSG_STOP},
+    };
+
+    int error = transfer(Device::Bh1749, address, messages, ARRAY_SIZE(messages));
+    if (error) {
+        latest.lightValid = false;
+        return error;
+    }
+    latest.red        = sys_get_le16(&values[0]);
+    latest.green      = sys_get_le16(&values[2]);
+    latest.blue       = sys_get_le16(&values[4]);
+    latest.infrared   = sys_get_le16(&values[8]);
+    latest.lightValid = true;
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+int BusScheduler::startBme680() {
+    Statistics &statistics = devices[static_cast<size_t>(Device::Bme680)];
+    statistics.transactions++;
+    int error = Services::startBme680Measurement(bme680);
+    if (error) {
+        statistics.errors++;
+        latest.environmentValid = false;
+    }
+    return error;
+}
+
+int BusScheduler::finishBme680() {
+    int error = our_bme680_finish_measurement(bme680);
+    if (error == 0) {
+        error = our_bme680_get_all(bme680, &latest.environment);
+    }
+    if (error) {
+        devices[static_cast<size_t>(Device::Bme680)].errors++;
+    }
+    latest.environmentValid = error == 0;
+    return error;
+}
+
+int BusScheduler::readAdxl362() {
+#if ADXL362_PRESENT
+    if (adxl362 == nullptr) {
+        return 0;
+    }
+
+    Statistics &statistics = devices[static_cast<size_t>(Device::Adxl362)];
+    statistics.transactions++;
+    struct sensor_value values[3];
+    int error = sensor_sample_fetch_chan(adxl362, SENSOR_CHAN_ACCEL_XYZ);
+    if (error == 0) {
+        error = sensor_channel_get(adxl362, SENSOR_CHAN_ACCEL_XYZ, values);
+    }
+    if (error) {
+        statistics.errors++;
+        latest.accelerationValid = false;
+        return error;
+    }
+    for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+        latest.acceleration[i] = static_cast<int32_t>(sensor_value_to_milli(&values[i]));
+    }
+    latest.accelerationValid = true;
+    return 0;
+#else
+    return 0;
+#endif
+}
+
+int BusScheduler::runWindow() {
+    using Read = int (BusScheduler::*)();
+    struct Step {
+        Device device;
+        Read read;
+    };
+    // Read while the BME680 converts, the devices that need the bus first
+    static constexpr Step steps[] = {
+        {Device::Pmic, &BusScheduler::readPmic},
+        {Device::Bh1749, &BusScheduler::readBh1749},
+        {Device::Adxl362, &BusScheduler::readAdxl362},
+    };
+
+    if (!initialized) {
+        return -EAGAIN;
+    }
+
+    k_mutex_lock(&lock, K_FOREVER);
+    // Set again once this window's measurement is read, a failed window never shows an old one
+    latest.environmentValid = false;
+    int result = pm_device_runtime_get(bus);
+    if (result) {
+        LOG_ERR("Failed to resume i2c2: %d", result);
+        k_mutex_unlock(&lock);
+        return result;
+    }
+
+    auto failed = [&result](Device device, int error) {
+        LOG_WRN("Failed to read %s: %d", deviceName(device), error);
+        if (result == 0) {
+            result = error;
+        }
+    };
+    Statistics &environment = devices[static_cast<size_t>(Device::Bme680)];
+
+    uint32_t windowStart = k_cycle_get_32();
+    int64_t bme680Due    = k_uptime_get() + BME680_MEAS_DUR_MS;
+    bool measuring       = false;
+    if (bme680 != nullptr) {
+        int error = startBme680();
+        measuring = error == 0;
+        if (error) {
+            failed(Device::Bme680, error);
+        }
+        environment.busyUs += k_cyc_to_us_floor64(k_cycle_get_32() - windowStart);
+    }
+
+    for (const Step &step : steps) {
+        uint32_t start = k_cycle_get_32();
+        int error      = (this->*step.read)();
+        devices[static_cast<size_t>(step.device)].busyUs += k_cyc_to_us_floor64(k_cycle_get_32() - start);
+        if (error) {
+            failed(step.device, error);
+        }
+    }
+
+    if (measuring) {
+        // Sleep with the bus suspended until the BME680 result is due
+        int64_t remaining = bme680Due - k_uptime_get();
+        if (remaining > 0) {
+            busyUs += k_cyc_to_us_floor64(k_cycle_get_32() - windowStart);
+            (void)pm_device_runtime_put(bus);
+            k_msleep(static_cast<int32_t>(remaining));
+            windowStart = k_cycle_get_32();
+            int error   = pm_device_runtime_get(bus);
+            if (error) {
+                LOG_ERR("Failed to resume i2c2: %d", error);
+                latest.environmentValid = false;
+                k_mutex_unlock(&lock);
+                return error;
+            }
+        }
+        uint32_t start = k_cycle_get_32();
+        int error      = finishBme680();
+        environment.busyUs += k_cyc_to_us_floor64(k_cycle_get_32() - start);
+        if (error) {
+            failed(Device::Bme680, error);
+        }
+    }
+    busyUs += k_cyc_to_us_floor64(k_cycle_get_32() - windowStart);
+    latest.time = k_uptime_get();
+    windowCount++;
+
+    (void)pm_device_runtime_put(bus);
+    k_mutex_unlock(&lock);
+
+#if CONFIG_APP_BUS_SCHEDULER_REPORT_WINDOWS > 0
+    if (windowCount % CONFIG_APP_BUS_SCHEDULER_REPORT_WINDOWS == 0) {
+        logStatistics();
+    }
+#endif
+    return result;
+}
+
+BusScheduler::Snapshot BusScheduler::snapshot() const {
+    k_mutex_lock(&lock, K_FOREVER);
+    Snapshot copy = latest;
+    k_mutex_unlock(&lock);
+    return copy;
+}
+
+void BusScheduler::logStatistics() const {
+    LOG_INF("i2c2: %u windows, busy %u ms", windowCount, static_cast<unsigned int>(busyUs / 1000U));
+    for (size_t i = 0; i < static_cast<size_t>(Device::Count); i++) {
+        LOG_INF("  %s: %u transactions, %u errors, busy %u ms", deviceName(static_cast<Device>(i)),
+                devices[i].transactions, devices[i].errors, static_cast<unsigned int>(devices[i].busyUs / 1000U));
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
+// App modules
+#include "our_drivers/our_bme680.h"
+
+namespace Services {
+    /**< Scheduler of the periodic reads on i2c2, shared by the ADP5360, the BH1749 and the BME680.
+     *
+     * Instead of every device waking the bus on its own schedule, all periodic reads happen in one
+     * bus-active window per sampling cycle. The TWIM and its pins are resumed once at the start of
+     * the window and suspended at the end, through runtime PM, so the bus sleeps in between. Each
+     * read is a single i2c_transfer() message list where the device allows it.
+     *
+     * The window is pipelined around the BME680 conversion, which takes BME680_MEAS_DUR_MS with the
+     * gas heater: the measurement is triggered first, the ADP5360, the BH1749 and the ADXL362 are
+     * read while it runs, then the thread sleeps, with the bus suspended, until the result is due and
+     * collects it. A window takes as long as the slowest device instead of the sum of all of them.
+     * The BME680 driver owns its own transfers, for it a transaction is one trigger and collection.
+     */
+    class BusScheduler {
+      public:
+        enum class Device : uint8_t {
+            Pmic,
+            Bh1749,
+            Bme680,
+            Adxl362,
+            Count,
+        };
+
+        struct Statistics {
+            uint32_t transactions;
+            uint32_t errors;
+            uint64_t busyUs; // time spent on the device's reads, bus resumed
+        };
+
+        /**< Latest values read in a window, the combined snapshot of one sampling cycle. */
+        struct Snapshot {
+            int64_t time;          // k_uptime_get() of the last window
+            bool environmentValid;
+            struct our_bme680_readings environment;
+            bool batteryValid;
+            uint8_t chargerStatus; // ADP5360 CHARGER_STATUS1 bits 2:0
+            uint8_t batterySoc;    // %
+            uint16_t batteryMv;
+            bool lightValid;
+            uint16_t red;
+            uint16_t green;
+            uint16_t blue;
+            uint16_t infrared;
+            bool accelerationValid;
+            int32_t acceleration[3]; // mm/s^2, x, y, z
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        BusScheduler(const BusScheduler &)            = delete;
+        BusScheduler &operator=(const BusScheduler &) = delete;
+        static BusScheduler &getInstance() { return instance; }
+        int init();
+        /**< Run one bus-active window reading every device. Returns the first error, the other
+         * devices are still read. Whether the BME680 was read is in snapshot().environmentValid. */
+        int runWindow();
+
+        Snapshot snapshot() const;
+        const Statistics &statistics(Device device) const { return devices[static_cast<size_t>(device)]; }
+        uint32_t windows() const { return windowCount; }
+        /**< Time the bus was resumed, over all windows. */
+        uint64_t busBusyUs() const { return busyUs; }
+        void logStatistics() const;
+        static const char *deviceName(Device device);
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr BusScheduler() = default;
+        static BusScheduler instance;
+        int transfer(Device device, uint16_t address, struct i2c_msg *messages, uint8_t count);
+        int readPmic();
+        int readBh1749();
+        int startBme680();
+        int finishBme680();
+        int readAdxl362();
+
+        const struct device *bus     = nullptr;
+        const struct device *bme680  = nullptr;
+        const struct device *adxl362 = nullptr;
+        Statistics devices[static_cast<size_t>(Device::Count)] = {};
+        Snapshot latest      = {};
+        uint64_t busyUs      = 0;
+        uint32_t windowCount = 0;
+        bool bh1749Ready     = false;
+        bool initialized     = false;
+    };
+} // namespace Services
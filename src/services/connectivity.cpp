@@ -0,0 +1,176 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+// App modules
+#include "connectivity.h"
+#include "settings_storage.h"
+
+using Services::Connectivity;
+using Services::SettingsStorage;
+namespace LinkControl = Services::LinkControl;
+
+LOG_MODULE_REGISTER(connectivity, LOG_LEVEL_INF);
+
+K_THREAD_STACK_DEFINE(connectivityStack, CONFIG_APP_CONNECTIVITY_STACK_SIZE);
+
+constinit Connectivity Connectivity::instance;
+struct k_work_q Connectivity::workQueue;
+K_WORK_DEFINE(Connectivity::bringUpWork, Connectivity::bringUpHandler);
+K_WORK_DEFINE(Connectivity::notifyWork, Connectivity::notifyHandler);
+K_WORK_DEFINE(Connectivity::qualityWork, Connectivity::qualityNotifyHandler);
+static struct k_spinlock listenerLock;
+
+const char *Connectivity::stateName(LinkState state) {
+    switch (state) {
+    case LinkState::Offline:
+        return "offline";
+    case LinkState::Searching:
+        return "searching";
+    case LinkState::Registered:
+        return "registered";
+    case LinkState::Roaming:
+        return "roaming";
+    case LinkState::Failed:
+        return "failed";
+    }
+    return "unknown";
+}
+
+int Connectivity::start() {
+    if (started) {
+        return -EALREADY;
+    }
+
+    k_work_queue_start(&workQueue, connectivityStack, K_THREAD_STACK_SIZEOF(connectivityStack),
+                       CONFIG_APP_CONNECTIVITY_THREAD_PRIORITY, nullptr);
+    k_thread_name_set(&workQueue.thread, "connectivity");
+    started = true;
+
+    k_work_submit_to_queue(&workQueue, &bringUpWork);
+    return 0;
+}
+
+int Connectivity::addListener(Listener listener) {
+    int error = -ENOMEM;
+    K_SPINLOCK(&listenerLock) {
+        if (listenerCount < ARRAY_SIZE(listeners)) {
+            // Filled before it is counted, notifyHandler() reads the count without the lock
+            listeners[listenerCount] = listener;
+            listenerCount++;
+            error = 0;
+        }
+    }
+    return error;
+}
+
+int Connectivity::addQualityListener(QualityListener listener) {
+    int error = -ENOMEM;
+    K_SPINLOCK(&listenerLock) {
+        if (qualityListenerCount < ARRAY_SIZE(qualityListeners)) {
+            qualityListeners[qualityListenerCount] = listener;
+            qualityListenerCount++;
+            error = 0;
+        }
+    }
+    return error;
+}
+
+void Connectivity::setState(LinkState state) {
+    if (static_cast<LinkState>(atomic_set(&linkState, static_cast<atomic_val_t>(state))) != state) {
+        k_work_submit_to_queue(&workQueue, &notifyWork);
+    }
+}
+
+/**< Runs on the connectivity work queue, so main() never waits for the modem. */
+void Connectivity::bringUpHandler(struct k_work *work) {
+    Connectivity &self = getInstance();
+    int64_t startTime  = k_uptime_get();
+
+    int error = LinkControl::modemInit();
+    if (error) {
+        LOG_ERR("Failed to initialize modem: %d", error);
+        self.setState(LinkState::Failed);
+        return;
+    }
+    LOG_INF("Modem started in %lld ms", k_uptime_get() - startTime);
+    if (LinkControl::subscribeQuality(qualityHandler) != 0) {
+        LOG_WRN("Signal quality unavailable");
+    }
+
+    /* The APN must be set before attach. Settings are loaded in parallel by main(), fall back to the
+     * modem's stored APN if they are not ready in time.
+     */
+    SettingsStorage &settings = SettingsStorage::getInstance();
+    if (settings.waitInitialized(K_MSEC(CONFIG_APP_CONNECTIVITY_SETTINGS_TIMEOUT_MS)) == 0) {
+        char apn[32];
+        if (settings.GetKey(SettingsStorage::KEY_CELL_APN, apn, sizeof(apn)) == 0 && apn[0] != '\0') {
+            apn[sizeof(apn) - 1] = '\0';
+            (void)LinkControl::setApn(apn);
+        }
+    } else {
+        LOG_WRN("Settings not ready, connecting with the modem's APN");
+    }
+
+    error = LinkControl::connectAsync(linkEventHandler);
+    if (error) {
+        LOG_ERR("Failed to start LTE connection: %d", error);
+        self.setState(LinkState::Failed);
+        return;
+    }
+    LOG_INF("LTE attach started");
+}
+
+void Connectivity::linkEventHandler(LinkControl::Event event) {
+    Connectivity &self = getInstance();
+
+    switch (event) {
+    case LinkControl::Event::Searching:
+        self.setState(LinkState::Searching);
+        break;
+    case LinkControl::Event::RegisteredHome:
+        self.setState(LinkState::Registered);
+        break;
+    case LinkControl::Event::RegisteredRoaming:
+        self.setState(LinkState::Roaming);
+        break;
+    case LinkControl::Event::NotRegistered:
+        self.setState(LinkState::Offline);
+        break;
+    case LinkControl::Event::Failed:
+        self.setState(LinkState::Failed);
+        break;
+    }
+}
+
+void Connectivity::notifyHandler(struct k_work *work) {
+    Connectivity &self = getInstance();
+    LinkState current  = self.state();
+
+    LOG_INF("Link state: %s", stateName(current));
+    for (size_t i = 0; i < self.listenerCount; i++) {
+        self.listeners[i](current);
+    }
+}
+
+/**< Called from the modem's notification context, the listeners run on the work queue. */
+void Connectivity::qualityHandler(const LinkControl::Quality &quality) {
+    Connectivity &self = getInstance();
+
+    if (static_cast<uint32_t>(atomic_set(&self.linkQuality, static_cast<atomic_val_t>(pack(quality)))) !=
+        pack(quality)) {
+        k_work_submit_to_queue(&workQueue, &qualityWork);
+    }
+}
+
+void Connectivity::qualityNotifyHandler(struct k_work *work) {
+    Connectivity &self                 = getInstance();
+    const LinkControl::Quality current = self.quality();
+
+    LOG_DBG("Signal: RSRP %d dBm, RSRQ %d dB", current.rsrp, current.rsrq);
+    for (size_t i = 0; i < self.qualityListenerCount; i++) {
+        self.qualityListeners[i](current);
+    }
+}
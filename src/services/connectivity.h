@@ -0,0 +1,86 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+// App modules
+#include "link_control.h"
+
+namespace Services {
+    /**< LTE connectivity service.
+     *
+     * start() only queues the bring-up on the service's own work queue: modem start, APN from
+     * SettingsStorage and lte_lc_connect_async() all run there, so sensor and settings
+     * initialisation in main() proceed while the modem boots and attaches. Once the modem is up the
+     * serving cell's RSRP and RSRQ are tracked from its signal notifications, so quality() costs no
+     * AT command.
+     */
+    class Connectivity {
+      public:
+        enum class LinkState : uint8_t {
+            Offline,
+            Searching,
+            Registered,
+            Roaming,
+            Failed,
+        };
+        using Listener        = void (*)(LinkState state);
+        using QualityListener = void (*)(const LinkControl::Quality &quality);
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Connectivity(const Connectivity &)            = delete;
+        Connectivity &operator=(const Connectivity &) = delete;
+        static Connectivity &getInstance() { return instance; }
+        /**< Queue the modem bring-up and return immediately. */
+        int start();
+        /**< Listeners are called from the connectivity work queue on every link-state change. Safe to
+         * call from the parallel service inits.
+         */
+        int addListener(Listener listener);
+        /**< Quality listeners are called from the connectivity work queue whenever the modem reports a
+         * new signal level. Safe to call from the parallel service inits.
+         */
+        int addQualityListener(QualityListener listener);
+
+        LinkState state() const { return static_cast<LinkState>(atomic_get(&linkState)); }
+        bool isConnected() const {
+            LinkState current = state();
+            return current == LinkState::Registered || current == LinkState::Roaming;
+        }
+        static const char *stateName(LinkState state);
+        /**< Last signal the modem reported, both values QUALITY_UNKNOWN before the first report. */
+        LinkControl::Quality quality() const {
+            uint32_t packed = static_cast<uint32_t>(atomic_get(&linkQuality));
+            return {.rsrp = static_cast<int16_t>(packed >> 16), .rsrq = static_cast<int16_t>(packed & 0xFFFF)};
+        }
+
+      private:
+        constexpr Connectivity() = default;
+        static Connectivity instance;
+        static void bringUpHandler(struct k_work *work);
+        static void linkEventHandler(LinkControl::Event event);
+        static void notifyHandler(struct k_work *work);
+        static void qualityHandler(const LinkControl::Quality &quality);
+        static void qualityNotifyHandler(struct k_work *work);
+        void setState(LinkState state);
+        static constexpr uint32_t pack(const LinkControl::Quality &quality) {
+            return static_cast<uint32_t>(static_cast<uint16_t>(quality.rsrp)) << 16 |
+                   static_cast<uint16_t>(quality.rsrq);
+        }
+
+        static struct k_work_q workQueue;
+        static struct k_work bringUpWork;
+        static struct k_work notifyWork;
+        static struct k_work qualityWork;
+        Listener listeners[CONFIG_APP_CONNECTIVITY_MAX_LISTENERS]               = {};
+        QualityListener qualityListeners[CONFIG_APP_CONNECTIVITY_MAX_LISTENERS] = {};
+        size_t listenerCount        = 0;
+        size_t qualityListenerCount = 0;
+        atomic_t linkState          = ATOMIC_INIT(static_cast<atomic_val_t>(LinkState::Offline));
+        atomic_t linkQuality        = ATOMIC_INIT(static_cast<atomic_val_t>(
+            pack({LinkControl::QUALITY_UNKNOWN, LinkControl::QUALITY_UNKNOWN})));
+        bool started                = false;
+    };
+} // namespace Services
@@ -0,0 +1,203 @@
+// Standard modules
+#include <cstdlib>
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#endif
+#include <errno.h>
+// App modules
+#include "deadband_filter.h"
+#include "settings_storage.h"
+
+using Services::Channel;
+using Services::DeadbandFilter;
+using Services::Sample;
+using Services::SettingsStorage;
+
+LOG_MODULE_REGISTER(deadband_filter, LOG_LEVEL_INF);
+
+/* Last component of the channel keys, in Channel order. */
+static const char *const channelNames[DeadbandFilter::CHANNEL_COUNT] = {"t", "p", "h", "g"};
+
+/**< Applies stored thresholds when settings_load() runs, and new ones set at runtime with
+ * settings_runtime_set().
+ */
+static int deadbandRootHandleSet(const char *name, size_t length, settings_read_cb readCallBack,
+                                 void *callBackArguments) {
+    const char *next;
+    DeadbandFilter::Threshold threshold;
+
+    for (size_t i = 0; i < DeadbandFilter::CHANNEL_COUNT; i++) {
+        if (settings_name_steq(name, channelNames[i], &next) && !next) {
+            if (length != sizeof(threshold)) {
+                return -EINVAL;
+            }
+            int rc = readCallBack(callBackArguments, &threshold, sizeof(threshold));
+            if (rc < 0) {
+                return rc;
+            }
+            DeadbandFilter::getInstance().applyThreshold(static_cast<Channel>(i), threshold);
+            return 0;
+        }
+    }
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(deadbandRootHandle, "deadband", nullptr, deadbandRootHandleSet, nullptr, nullptr);
+
+constinit DeadbandFilter DeadbandFilter::instance;
+static K_MUTEX_DEFINE(lock);
+
+static int64_t valueOf(const Sample &sample, size_t channel) {
+    switch (static_cast<Channel>(channel)) {
+    case Channel::Temperature:
+        return sample.temperature;
+    case Channel::Pressure:
+        return sample.pressure;
+    case Channel::Humidity:
+        return sample.humidity;
+    case Channel::GasResistance:
+    default:
+        return sample.gasResistance;
+    }
+}
+
+bool DeadbandFilter::pass(const Sample &sample) {
+    Threshold thresholds[CHANNEL_COUNT];
+    k_mutex_lock(&lock, K_FOREVER);
+    for (size_t i = 0; i < CHANNEL_COUNT; i++) {
+        thresholds[i] = channels[i].threshold;
+    }
+    k_mutex_unlock(&lock);
+
+    bool moved[CHANNEL_COUNT] = {};
+    bool due[CHANNEL_COUNT]   = {};
+    bool anyMoved             = !started;
+    bool anyDue               = false;
+    uint32_t sinceReference   = sample.timestamp - referenceStamp;
+    uint32_t sincePrevious    = sample.timestamp - previousStamp;
+    for (size_t i = 0; i < CHANNEL_COUNT && started; i++) {
+        const Threshold &threshold = thresholds[i];
+        int64_t value              = valueOf(sample, i);
+        uint64_t change            = static_cast<uint64_t>(llabs(value - channels[i].reference));
+        uint64_t step              = static_cast<uint64_t>(llabs(value - channels[i].previous));
+
+        moved[i] = change > threshold.delta;
+        // step / sincePrevious > slopePerMinute / 60000, without the division
+        if (threshold.slopePerMinute != 0 && sincePrevious != 0 &&
+            step * MSEC_PER_SEC * 60 > uint64_t{threshold.slopePerMinute} * sincePrevious) {
+            moved[i] = true;
+        }
+        due[i] = threshold.heartbeatSeconds != 0 &&
+                 sinceReference >= uint64_t{threshold.heartbeatSeconds} * MSEC_PER_SEC;
+        anyMoved |= moved[i];
+        anyDue |= due[i];
+    }
+
+    bool passed = anyMoved || anyDue;
+    for (size_t i = 0; i < CHANNEL_COUNT; i++) {
+        State &channel = channels[i];
+        if (moved[i]) {
+            channel.counters.forwarded++;
+        } else if (due[i] && !anyMoved) {
+            channel.counters.heartbeats++;
+        } else if (started) {
+            channel.counters.dropped++;
+        }
+        channel.previous = valueOf(sample, i);
+        if (passed) {
+            channel.reference = channel.previous;
+        }
+    }
+    if (passed) {
+        referenceStamp = sample.timestamp;
+    }
+    previousStamp = sample.timestamp;
+    started       = true;
+    return passed;
+}
+
+DeadbandFilter::Threshold DeadbandFilter::threshold(Channel channel) const {
+    k_mutex_lock(&lock, K_FOREVER);
+    Threshold result = channels[static_cast<size_t>(channel)].threshold;
+    k_mutex_unlock(&lock);
+    return result;
+}
+
+void DeadbandFilter::applyThreshold(Channel channel, const Threshold &threshold) {
+    k_mutex_lock(&lock, K_FOREVER);
+    channels[static_cast<size_t>(channel)].threshold = threshold;
+    k_mutex_unlock(&lock);
+    LOG_INF("Deadband %s: delta %u, slope %u/min, heartbeat %u s", channelNames[static_cast<size_t>(channel)],
+            threshold.delta, threshold.slopePerMinute, threshold.heartbeatSeconds);
+}
+
+int DeadbandFilter::setThreshold(Channel channel, const Threshold &threshold) {
+    if (static_cast<size_t>(channel) >= CHANNEL_COUNT) {
+        return -EINVAL;
+    }
+    applyThreshold(channel, threshold);
+    Threshold stored = threshold;
+    return SettingsStorage::getInstance().SetKey(key(channel), &stored, sizeof(stored));
+}
+
+DeadbandFilter::key_t DeadbandFilter::key(Channel channel) {
+    switch (channel) {
+    case Channel::Temperature:
+        return KEY_TEMPERATURE;
+    case Channel::Pressure:
+        return KEY_PRESSURE;
+    case Channel::Humidity:
+        return KEY_HUMIDITY;
+    case Channel::GasResistance:
+    default:
+        return KEY_GAS;
+    }
+}
+
+#ifdef CONFIG_SHELL
+static int setCommand(const struct shell *sh, size_t argc, char **argv) {
+    for (size_t i = 0; i < DeadbandFilter::CHANNEL_COUNT; i++) {
+        if (strcmp(argv[1], channelNames[i]) != 0) {
+            continue;
+        }
+        DeadbandFilter::Threshold threshold = {
+            .delta            = static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)),
+            .slopePerMinute   = static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)),
+            .heartbeatSeconds = static_cast<uint32_t>(strtoul(argv[4], nullptr, 10)),
+        };
+        int error = DeadbandFilter::getInstance().setThreshold(static_cast<Channel>(i), threshold);
+        if (error) {
+            shell_warn(sh, "Applied, not persisted: %d", error);
+        }
+        return 0;
+    }
+    shell_error(sh, "Unknown channel %s, expected t, p, h or g", argv[1]);
+    return -EINVAL;
+}
+
+static int showCommand(const struct shell *sh, size_t argc, char **argv) {
+    const DeadbandFilter &filter = DeadbandFilter::getInstance();
+    shell_print(sh, "channel,delta,slope_per_min,heartbeat_s,forwarded,heartbeats,dropped");
+    for (size_t i = 0; i < DeadbandFilter::CHANNEL_COUNT; i++) {
+        DeadbandFilter::Threshold threshold = filter.threshold(static_cast<Channel>(i));
+        DeadbandFilter::Counters counters   = filter.counters(static_cast<Channel>(i));
+        shell_print(sh, "%s,%u,%u,%u,%u,%u,%u", channelNames[i], threshold.delta, threshold.slopePerMinute,
+                    threshold.heartbeatSeconds, counters.forwarded, counters.heartbeats, counters.dropped);
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(deadbandCommands,
+                               SHELL_CMD_ARG(set, NULL,
+                                             "Set the thresholds of a channel: "
+                                             "set <t|p|h|g> <delta> <slope_per_min> <heartbeat_s>",
+                                             setCommand, 5, 0),
+                               SHELL_CMD(show, NULL, "Thresholds and counters of every channel", showCommand),
+                               SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(deadband, &deadbandCommands, "Deadband filter", NULL);
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+// App modules
+#include "sample.h"
+#include "sensor.h"
+
+namespace Services {
+    /**< Report-by-exception filter between the sampling and the sample log and uplink.
+     *
+     * A sample passes when one of its channels moved more than that channel's delta since the last
+     * sample that passed, changed faster than its slope since the sample before, or went without a
+     * passed sample for its heartbeat period. Every passed sample is the new reference of all of its
+     * channels. The thresholds of each channel are persisted under its key and default to
+     * CONFIG_APP_DEADBAND_*. They apply at runtime through setThreshold(), settings_runtime_set()
+     * (e.g. the mcumgr settings group) or "deadband set" in the shell.
+     *
+     * Per channel counters tell how often the channel made a sample pass, was due as heartbeat, or
+     * stayed within its thresholds, so the thresholds can be tuned against the data volume.
+     */
+    class DeadbandFilter {
+      public:
+        using key_t                            = std::string_view;
+        constexpr static key_t KEY_TEMPERATURE = "deadband/t";
+        constexpr static key_t KEY_PRESSURE    = "deadband/p";
+        constexpr static key_t KEY_HUMIDITY    = "deadband/h";
+        constexpr static key_t KEY_GAS         = "deadband/g";
+        static constexpr size_t CHANNEL_COUNT  = 4;
+
+        /**< In the native resolution of the channel, as persisted. 0 turns a threshold off, a delta of
+         * 0 passes every change.
+         */
+        struct __attribute__((packed)) Threshold {
+            uint32_t delta;            // change since the last passed sample
+            uint32_t slopePerMinute;   // change per minute since the previous sample
+            uint32_t heartbeatSeconds; // longest time without a passed sample
+        };
+
+        struct Counters {
+            uint32_t forwarded;  // samples that passed because this channel moved
+            uint32_t heartbeats; // samples that passed only because this channel's heartbeat was due
+            uint32_t dropped;    // samples in which this channel stayed within its thresholds
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        DeadbandFilter(const DeadbandFilter &)            = delete;
+        DeadbandFilter &operator=(const DeadbandFilter &) = delete;
+        static DeadbandFilter &getInstance() { return instance; }
+
+        /**< Returns true when sample is to be stored and sent. Main loop only. */
+        bool pass(const Sample &sample);
+
+        Threshold threshold(Channel channel) const;
+        /**< Apply and persist the thresholds of channel. */
+        int setThreshold(Channel channel, const Threshold &threshold);
+        /**< Apply without persisting, for the settings handler. */
+        void applyThreshold(Channel channel, const Threshold &threshold);
+        Counters counters(Channel channel) const { return channels[static_cast<size_t>(channel)].counters; }
+        static key_t key(Channel channel);
+
+      private:
+        constexpr DeadbandFilter() = default;
+        static DeadbandFilter instance;
+
+        struct State {
+            Threshold threshold;
+            Counters counters;
+            int64_t reference; // value of the last passed sample
+            int64_t previous;  // value of the previous sample
+        };
+
+        State channels[CHANNEL_COUNT] = {
+            {{CONFIG_APP_DEADBAND_TEMPERATURE, 0, CONFIG_APP_DEADBAND_HEARTBEAT_SECONDS}, {}, 0, 0},
+            {{CONFIG_APP_DEADBAND_PRESSURE, 0, CONFIG_APP_DEADBAND_HEARTBEAT_SECONDS}, {}, 0, 0},
+            {{CONFIG_APP_DEADBAND_HUMIDITY, 0, CONFIG_APP_DEADBAND_HEARTBEAT_SECONDS}, {}, 0, 0},
+            {{CONFIG_APP_DEADBAND_GAS, 0, CONFIG_APP_DEADBAND_HEARTBEAT_SECONDS}, {}, 0, 0},
+        };
+        uint32_t referenceStamp = 0;
+        uint32_t previousStamp  = 0;
+        bool started            = false;
+    };
+} // namespace Services
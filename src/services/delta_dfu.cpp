@@ -0,0 +1,429 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/dfu/mcuboot.h>
+#ifdef CONFIG_FILE_SYSTEM
+#include <zephyr/fs/fs.h>
+#endif
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/coap.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/reboot.h>
+#if defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#include <pm_config.h>
+#endif
+#include <errno.h>
+// App modules
+#include "delta_dfu.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+using Services::Connectivity;
+using Services::DeltaDfu;
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+
+LOG_MODULE_REGISTER(delta_dfu, LOG_LEVEL_INF);
+
+/* The slots are mcuboot_primary and mcuboot_secondary in the babbies_tracker_pm_static*.yml layouts
+ * and slot0_partition and slot1_partition in the DTS for builds without the partition manager.
+ */
+#if defined(PM_MCUBOOT_PRIMARY_ID)
+#define PRIMARY_SLOT_ID   PM_MCUBOOT_PRIMARY_ID
+#define SECONDARY_SLOT_ID PM_MCUBOOT_SECONDARY_ID
+#else
+#define PRIMARY_SLOT_ID   FIXED_PARTITION_ID(slot0_partition)
+#define SECONDARY_SLOT_ID FIXED_PARTITION_ID(slot1_partition)
+#endif
+
+#define COAP_REQUEST_SIZE   64
+#define COAP_REPLY_RESERVE  32
+#define OP_WORD_SIZE        sizeof(uint32_t)
+
+K_THREAD_STACK_DEFINE(deltaDfuStack, CONFIG_APP_DELTA_DFU_STACK_SIZE);
+
+/**< The only RAM the old image goes through, for COPY operations and both hash checks. */
+static uint8_t window[CONFIG_APP_DELTA_DFU_WINDOW];
+
+constinit DeltaDfu DeltaDfu::instance;
+struct k_work_q DeltaDfu::workQueue;
+K_WORK_DEFINE(DeltaDfu::checkWork, DeltaDfu::checkHandler);
+
+int DeltaDfu::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    int error = flash_area_open(PRIMARY_SLOT_ID, &primary);
+    if (error) {
+        LOG_ERR("Failed to open the primary slot: %d", error);
+        return error;
+    }
+
+    k_work_queue_start(&workQueue, deltaDfuStack, K_THREAD_STACK_SIZEOF(deltaDfuStack),
+                       CONFIG_APP_DELTA_DFU_THREAD_PRIORITY, nullptr);
+    k_thread_name_set(&workQueue.thread, "delta_dfu");
+
+    error = Connectivity::getInstance().addListener(linkStateListener);
+    if (error) {
+        return error;
+    }
+
+    initialized = true;
+    LOG_INF("Initialized DeltaDfu: coap://%s:%d/%s, %d byte window", CONFIG_APP_UPLINK_SERVER_ADDR,
+            CONFIG_APP_UPLINK_SERVER_PORT, CONFIG_APP_DELTA_DFU_RESOURCE, CONFIG_APP_DELTA_DFU_WINDOW);
+    return 0;
+}
+
+int DeltaDfu::begin() {
+    if (primary == nullptr) {
+        return -EACCES;
+    }
+    staged   = 0;
+    produced = 0;
+    state    = State::Header;
+    return 0;
+}
+
+void DeltaDfu::abort() { state = State::Idle; }
+
+int DeltaDfu::fail(int error) {
+    state = State::Failed;
+    LOG_ERR("Delta update failed after %u bytes: %d", static_cast<unsigned int>(produced), error);
+    return error;
+}
+
+/**< Check the header against the running image and open the secondary slot. */
+int DeltaDfu::startPatch() {
+    memcpy(&header, staging, sizeof(header));
+    if (header.magic != MAGIC || header.version != VERSION) {
+        LOG_ERR("Not a delta patch, magic 0x%08x version %u", header.magic, header.version);
+        return -EINVAL;
+    }
+    if (header.oldSize > primary->fa_size) {
+        return -EINVAL;
+    }
+
+    struct flash_area_check check = {
+        .match = header.oldHash,
+        .clen  = header.oldSize,
+        .off   = 0,
+        .rbuf  = window,
+        .rblen = sizeof(window),
+    };
+    int error = flash_area_check_int_sha256(primary, &check);
+    if (error) {
+        LOG_ERR("Patch was not made for the running image: %d", error);
+        return -ESTALE;
+    }
+
+    error = flash_img_init_id(&image, SECONDARY_SLOT_ID);
+    if (error) {
+        LOG_ERR("Failed to open the secondary slot: %d", error);
+        return error;
+    }
+    if (header.newSize > image.flash_area->fa_size) {
+        return -EFBIG;
+    }
+
+    LOG_INF("Applying delta patch, %u byte image to %u bytes", header.oldSize, header.newSize);
+    return 0;
+}
+
+/**< Append bytes to the new image. */
+int DeltaDfu::emit(const uint8_t *data, size_t length) {
+    if (produced + length > header.newSize) {
+        return -EFBIG;
+    }
+    int error = flash_img_buffered_write(&image, data, length, false);
+    if (error) {
+        return error;
+    }
+    produced += length;
+    return 0;
+}
+
+/**< Append a range of the old image to the new one through the window. */
+int DeltaDfu::copy(uint32_t offset, uint32_t length) {
+    if (uint64_t{offset} + length > header.oldSize) {
+        return -EINVAL;
+    }
+    while (length > 0) {
+        size_t chunk = MIN(length, sizeof(window));
+        int error    = flash_area_read(primary, offset, window, chunk);
+        if (error == 0) {
+            error = emit(window, chunk);
+        }
+        if (error) {
+            return error;
+        }
+        offset += chunk;
+        length -= chunk;
+    }
+    return 0;
+}
+
+int DeltaDfu::write(const uint8_t *data, size_t length) {
+    while (length > 0) {
+        size_t take;
+        int error = 0;
+
+        switch (state) {
+        case State::Header:
+            take = MIN(length, sizeof(PatchHeader) - staged);
+            memcpy(staging + staged, data, take);
+            staged += take;
+            if (staged == sizeof(PatchHeader)) {
+                staged = 0;
+                error  = startPatch();
+                state  = State::Operation;
+            }
+            break;
+        case State::Operation:
+        case State::CopyOffset:
+            take = MIN(length, OP_WORD_SIZE - staged);
+            memcpy(staging + staged, data, take);
+            staged += take;
+            if (staged == OP_WORD_SIZE) {
+                uint32_t word = sys_get_le32(staging);
+                staged        = 0;
+                if (state == State::CopyOffset) {
+                    error = copy(word, opLength);
+                    state = State::Operation;
+                } else {
+                    opLength = word & OP_LENGTH_MASK;
+                    state    = (word & OP_INSERT) ? State::Insert : State::CopyOffset;
+                }
+            }
+            break;
+        case State::Insert:
+            take  = MIN(length, opLength);
+            error = emit(data, take);
+            opLength -= take;
+            break;
+        default:
+            return -EINVAL;
+        }
+        if (error) {
+            return fail(error);
+        }
+        if (state == State::Insert && opLength == 0) {
+            state = State::Operation;
+        }
+        data += take;
+        length -= take;
+    }
+    return 0;
+}
+
+int DeltaDfu::finish() {
+    if (state != State::Operation || staged != 0 || produced != header.newSize) {
+        return fail(-ENODATA);
+    }
+
+    int error = flash_img_buffered_write(&image, nullptr, 0, true);
+    if (error) {
+        return fail(error);
+    }
+
+    struct flash_area_check check = {
+        .match = header.newHash,
+        .clen  = header.newSize,
+        .off   = 0,
+        .rbuf  = window,
+        .rblen = sizeof(window),
+    };
+    error = flash_img_check(&image, &check, SECONDARY_SLOT_ID);
+    if (error) {
+        LOG_ERR("Rebuilt image does not match the patch");
+        return fail(-EBADMSG);
+    }
+
+    error = boot_request_upgrade(BOOT_UPGRADE_TEST);
+    if (error) {
+        return fail(error);
+    }
+    state = State::Done;
+    LOG_INF("Delta update verified, %u bytes, swapped in at the next reboot", header.newSize);
+    return 0;
+}
+
+int DeltaDfu::download() {
+    static uint8_t packet[COAP_REQUEST_SIZE];
+    static uint8_t reply[CONFIG_APP_DELTA_DFU_BLOCK_SIZE + COAP_REPLY_RESERVE];
+    struct coap_block_context block;
+    struct sockaddr_in server = {};
+
+    server.sin_family = AF_INET;
+    server.sin_port   = htons(CONFIG_APP_UPLINK_SERVER_PORT);
+    if (zsock_inet_pton(AF_INET, CONFIG_APP_UPLINK_SERVER_ADDR, &server.sin_addr) != 1) {
+        return -EINVAL;
+    }
+
+    int sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return -errno;
+    }
+    struct zsock_timeval timeout = {.tv_sec = CONFIG_APP_UPLINK_ACK_TIMEOUT_SECONDS, .tv_usec = 0};
+    (void)zsock_setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    int error = zsock_connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server));
+    if (error == 0) {
+        error = coap_block_transfer_init(&block, coap_bytes_to_block_size(CONFIG_APP_DELTA_DFU_BLOCK_SIZE), 0);
+    }
+    if (error == 0) {
+        error = begin();
+    }
+
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger &ledger = EnergyLedger::getInstance();
+    ledger.setActive(EnergyLedger::Subsystem::Radio, true);
+#endif
+    bool last = false;
+    while (error == 0 && !last) {
+        struct coap_packet request;
+        uint16_t messageId = coap_next_id();
+
+        error = coap_packet_init(&request, packet, sizeof(packet), COAP_VERSION_1, COAP_TYPE_CON,
+                                 COAP_TOKEN_MAX_LEN, coap_next_token(), COAP_METHOD_GET, messageId);
+        if (error == 0) {
+            error = coap_packet_append_option(&request, COAP_OPTION_URI_PATH,
+                                              reinterpret_cast<const uint8_t *>(CONFIG_APP_DELTA_DFU_RESOURCE),
+                                              strlen(CONFIG_APP_DELTA_DFU_RESOURCE));
+        }
+        if (error == 0) {
+            error = coap_append_block2_option(&request, &block);
+        }
+        if (error) {
+            break;
+        }
+
+        struct coap_packet response;
+        error = -ETIMEDOUT;
+        for (int attempt = 0; error == -ETIMEDOUT && attempt <= CONFIG_APP_UPLINK_RETRIES; attempt++) {
+            if (zsock_send(sock, request.data, request.offset, 0) < 0) {
+                error = -errno;
+                break;
+            }
+            ssize_t received = zsock_recv(sock, reply, sizeof(reply), 0);
+            if (received >= 0 && coap_packet_parse(&response, reply, received, nullptr, 0) == 0 &&
+                coap_header_get_type(&response) == COAP_TYPE_ACK && coap_header_get_id(&response) == messageId) {
+                error = 0;
+            }
+        }
+        if (error) {
+            break;
+        }
+
+        uint8_t code = coap_header_get_code(&response);
+        if (code == COAP_RESPONSE_CODE_NOT_FOUND) {
+            error = -ENOENT;
+            break;
+        }
+        if (code != COAP_RESPONSE_CODE_CONTENT) {
+            error = -EBADMSG;
+            break;
+        }
+
+        error = coap_update_from_block(&response, &block);
+        if (error) {
+            break;
+        }
+        uint16_t payloadLength;
+        const uint8_t *payload = coap_packet_get_payload(&response, &payloadLength);
+        if (payload != nullptr) {
+            error = write(payload, payloadLength);
+        }
+        last = coap_next_block(&response, &block) == 0;
+    }
+#ifdef CONFIG_APP_ENERGY
+    ledger.setActive(EnergyLedger::Subsystem::Radio, false);
+    ledger.addOperations(EnergyLedger::Subsystem::Radio);
+#endif
+    zsock_close(sock);
+
+    if (error) {
+        abort();
+        return error;
+    }
+    return finish();
+}
+
+#ifdef CONFIG_FILE_SYSTEM
+int DeltaDfu::applyFile(const char *path) {
+    static uint8_t chunk[CONFIG_APP_DELTA_DFU_BLOCK_SIZE];
+    struct fs_file_t file;
+
+    fs_file_t_init(&file);
+    int error = fs_open(&file, path, FS_O_READ);
+    if (error) {
+        return error;
+    }
+    error = begin();
+    while (error == 0) {
+        ssize_t length = fs_read(&file, chunk, sizeof(chunk));
+        if (length <= 0) {
+            error = static_cast<int>(length);
+            break;
+        }
+        error = write(chunk, static_cast<size_t>(length));
+    }
+    (void)fs_close(&file);
+
+    if (error) {
+        abort();
+        return error;
+    }
+    return finish();
+}
+#endif
+
+/**< Confirm the running image to MCUboot, which otherwise reverts it at the next reboot. */
+static void confirmImage() {
+#ifdef CONFIG_BOOTLOADER_MCUBOOT
+    if (!boot_is_img_confirmed()) {
+        int error = boot_write_img_confirmed();
+        if (error) {
+            LOG_ERR("Failed to confirm the running image: %d", error);
+        } else {
+            LOG_INF("Confirmed the running image");
+        }
+    }
+#endif
+}
+
+void DeltaDfu::checkHandler(struct k_work *work) {
+    DeltaDfu &self = getInstance();
+
+    int error = self.download();
+    /* The server answered, the image can receive the next fix. A broken download path is left
+     * unconfirmed for MCUboot to revert.
+     */
+    if (error == 0 || error == -ENOENT) {
+        confirmImage();
+    }
+    if (error == -ENOENT) {
+        LOG_INF("No firmware update");
+        return;
+    }
+    if (error) {
+        LOG_WRN("Firmware update check failed: %d", error);
+        return;
+    }
+    LOG_INF("Rebooting into the update");
+    k_sleep(K_SECONDS(1));
+    sys_reboot(SYS_REBOOT_WARM);
+}
+
+void DeltaDfu::linkStateListener(Connectivity::LinkState state) {
+    DeltaDfu &self = getInstance();
+
+    if (Connectivity::getInstance().isConnected() && self.initialized && !self.checked) {
+        self.checked = true;
+        k_work_submit_to_queue(&self.workQueue, &self.checkWork);
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/dfu/flash_img.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+// App modules
+#include "connectivity.h"
+
+namespace Services {
+    /**< Delta firmware updates into the MCUboot secondary slot.
+     *
+     * A patch made by scripts/make_delta.py rebuilds the new signed image from the one in the
+     * primary slot: COPY operations read a range of the old image through a RAM window of
+     * CONFIG_APP_DELTA_DFU_WINDOW bytes and INSERT operations carry the bytes that are new. The
+     * patch is applied while it is streamed in with write(), so it is never stored. The old image
+     * is checked against the SHA-256 in the patch header before anything is written and the
+     * rebuilt image against the new SHA-256 before finish() requests a test swap from MCUboot.
+     *
+     * Once the link is up, the patch is fetched once per boot from the uplink CoAP server with a
+     * block-wise GET of CONFIG_APP_DELTA_DFU_RESOURCE. A 4.04 means there is no update. The running
+     * image is confirmed to MCUboot once the server answered, an image that never gets an answer is
+     * reverted by MCUboot. applyFile() takes the patch from a file instead.
+     */
+    class DeltaDfu {
+      public:
+        static constexpr uint32_t MAGIC   = 0x46445442; // "BTDF"
+        static constexpr uint8_t VERSION  = 1;
+        static constexpr size_t HASH_SIZE = 32;
+
+        struct __attribute__((packed)) PatchHeader {
+            uint32_t magic;
+            uint8_t version;
+            uint8_t reserved[3];
+            uint32_t oldSize;
+            uint32_t newSize;
+            uint8_t oldHash[HASH_SIZE]; // SHA-256 of the first oldSize bytes of the primary slot
+            uint8_t newHash[HASH_SIZE]; // SHA-256 of the rebuilt image
+        };
+
+        /**< Every operation starts with a word holding its kind in the top bit and its length. A
+         * COPY is followed by the offset in the old image, an INSERT by length literal bytes.
+         */
+        static constexpr uint32_t OP_INSERT      = 1U << 31;
+        static constexpr uint32_t OP_LENGTH_MASK = OP_INSERT - 1;
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        DeltaDfu(const DeltaDfu &)            = delete;
+        DeltaDfu &operator=(const DeltaDfu &) = delete;
+        static DeltaDfu &getInstance() { return instance; }
+        /**< Open the primary slot and start watching the link. */
+        int init();
+
+        /**< Start applying a new patch, dropping any patch in progress. */
+        int begin();
+        /**< Apply the next bytes of the patch, split at any point. */
+        int write(const uint8_t *data, size_t length);
+        /**< Check the rebuilt image and request a test swap at the next reboot. */
+        int finish();
+        /**< Stop applying the patch in progress. */
+        void abort();
+
+        /**< Fetch and apply the patch from the server, blocking. Returns -ENOENT if there is none. */
+        int download();
+#ifdef CONFIG_FILE_SYSTEM
+        /**< Apply the patch stored in a file, blocking, e.g. one uploaded with the mcumgr fs group. */
+        int applyFile(const char *path);
+#endif
+
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        enum class State : uint8_t { Idle, Header, Operation, CopyOffset, Insert, Done, Failed };
+
+        constexpr DeltaDfu() = default;
+        static DeltaDfu instance;
+        static void checkHandler(struct k_work *work);
+        static void linkStateListener(Connectivity::LinkState state);
+        int startPatch();
+        int copy(uint32_t offset, uint32_t length);
+        int emit(const uint8_t *data, size_t length);
+        int fail(int error);
+
+        static struct k_work_q workQueue;
+        static struct k_work checkWork;
+        struct flash_img_context image {};
+        const struct flash_area *primary = nullptr;
+        PatchHeader header{};
+        uint8_t staging[sizeof(PatchHeader)] = {}; // header or operation word being assembled
+        size_t staged       = 0;
+        uint32_t opLength   = 0;              // bytes left in the current INSERT
+        size_t produced     = 0;              // bytes of the new image written so far
+        State state         = State::Idle;
+        bool checked        = false;          // the server was asked once since boot
+        bool initialized    = false;
+    };
+} // namespace Services
@@ -0,0 +1,169 @@
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+// App modules
+#include "energy_ledger.h"
+
+using Services::EnergyLedger;
+
+LOG_MODULE_REGISTER(energy_ledger, LOG_LEVEL_INF);
+
+struct Coefficients {
+    uint32_t activeUa;    // current while active
+    uint32_t operationNc; // charge per operation
+};
+
+static constexpr Coefficients coefficients[] = {
+    {CONFIG_APP_ENERGY_BASE_UA, 0},
+    {CONFIG_APP_ENERGY_BME680_HEATER_UA, 0},
+    {0, CONFIG_APP_ENERGY_I2C_TRANSACTION_NC},
+    {0, CONFIG_APP_ENERGY_SPI_TRANSACTION_NC},
+    {CONFIG_APP_ENERGY_LED_UA, 0},
+    {CONFIG_APP_ENERGY_RADIO_UA, CONFIG_APP_ENERGY_RADIO_SESSION_NC},
+    {0, CONFIG_APP_ENERGY_FLASH_ERASE_NC},
+};
+static_assert(ARRAY_SIZE(coefficients) == static_cast<size_t>(EnergyLedger::Subsystem::Count));
+
+constinit EnergyLedger EnergyLedger::instance;
+K_WORK_DELAYABLE_DEFINE(EnergyLedger::reportWork, EnergyLedger::reportHandler);
+
+const char *EnergyLedger::subsystemName(Subsystem subsystem) {
+    switch (subsystem) {
+    case Subsystem::Base:
+        return "base";
+    case Subsystem::Bme680Heater:
+        return "bme680_heater";
+    case Subsystem::I2c:
+        return "i2c";
+    case Subsystem::Spi:
+        return "spi";
+    case Subsystem::Led:
+        return "led";
+    case Subsystem::Radio:
+        return "radio";
+    case Subsystem::Flash:
+        return "flash";
+    case Subsystem::Count:
+        break;
+    }
+    return "unknown";
+}
+
+int EnergyLedger::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    start = k_uptime_get();
+#if CONFIG_APP_ENERGY_REPORT_SECONDS > 0
+    k_work_schedule(&reportWork, K_SECONDS(CONFIG_APP_ENERGY_REPORT_SECONDS));
+#endif
+    initialized = true;
+    LOG_INF("Initialized EnergyLedger: base %d uA", CONFIG_APP_ENERGY_BASE_UA);
+    return 0;
+}
+
+void EnergyLedger::addActive(Subsystem subsystem, uint32_t ms) {
+    size_t index = static_cast<size_t>(subsystem);
+
+    K_SPINLOCK(&lock) {
+        entries[index].activeMs += ms;
+        entries[index].chargeNc += uint64_t{ms} * coefficients[index].activeUa;
+    }
+}
+
+void EnergyLedger::addOperations(Subsystem subsystem, uint32_t count) {
+    size_t index = static_cast<size_t>(subsystem);
+
+    K_SPINLOCK(&lock) {
+        entries[index].operations += count;
+        entries[index].chargeNc += uint64_t{count} * coefficients[index].operationNc;
+    }
+}
+
+void EnergyLedger::setDuty(Subsystem subsystem, uint32_t permille) {
+    size_t index = static_cast<size_t>(subsystem);
+    int64_t now  = k_uptime_get();
+    int64_t since;
+    uint32_t previous;
+
+    K_SPINLOCK(&lock) {
+        since    = activeSince[index];
+        previous = duty[index];
+        /* 0 marks an idle subsystem, an interval starting at boot is shifted by 1 ms. */
+        activeSince[index] = permille ? MAX(now, int64_t{1}) : 0;
+        duty[index]        = permille;
+    }
+    if (since != 0) {
+        addActive(subsystem, static_cast<uint32_t>((now - since) * previous / FULL_DUTY));
+    }
+}
+
+EnergyLedger::Entry EnergyLedger::settled(Subsystem subsystem, int64_t now) const {
+    size_t index = static_cast<size_t>(subsystem);
+    Entry result;
+    int64_t since;
+    uint32_t permille;
+
+    K_SPINLOCK(&lock) {
+        result   = entries[index];
+        since    = activeSince[index];
+        permille = duty[index];
+    }
+    if (subsystem == Subsystem::Base) {
+        since    = start;
+        permille = FULL_DUTY;
+    }
+    if (since != 0) {
+        uint64_t running = static_cast<uint64_t>(now - since) * permille / FULL_DUTY;
+        result.activeMs += running;
+        result.chargeNc += running * coefficients[index].activeUa;
+    }
+    return result;
+}
+
+EnergyLedger::Entry EnergyLedger::entry(Subsystem subsystem) const { return settled(subsystem, k_uptime_get()); }
+
+uint32_t EnergyLedger::averageMicroAmps(Subsystem subsystem) const {
+    int64_t now     = k_uptime_get();
+    int64_t elapsed = now - start;
+
+    return elapsed > 0 ? static_cast<uint32_t>(settled(subsystem, now).chargeNc / elapsed) : 0;
+}
+
+uint32_t EnergyLedger::totalMicroAmps() const {
+    uint32_t total = 0;
+
+    for (size_t i = 0; i < COUNT; i++) {
+        total += averageMicroAmps(static_cast<Subsystem>(i));
+    }
+    return total;
+}
+
+void EnergyLedger::logReport() const {
+    int64_t now     = k_uptime_get();
+    int64_t elapsed = MAX(now - start, int64_t{1});
+    uint64_t total  = 0;
+
+    LOG_INF("Energy over %lld s", elapsed / 1000);
+    LOG_INF("subsystem,active_ms,operations,charge_uc,uah_per_h");
+    for (size_t i = 0; i < COUNT; i++) {
+        Entry current = settled(static_cast<Subsystem>(i), now);
+        total += current.chargeNc;
+        LOG_INF("%s,%u,%u,%u,%u", subsystemName(static_cast<Subsystem>(i)),
+                static_cast<unsigned int>(current.activeMs), current.operations,
+                static_cast<unsigned int>(current.chargeNc / 1000U),
+                static_cast<unsigned int>(current.chargeNc / elapsed));
+    }
+    LOG_INF("total,,,%u,%u", static_cast<unsigned int>(total / 1000U), static_cast<unsigned int>(total / elapsed));
+}
+
+void EnergyLedger::reportHandler(struct k_work *work) {
+    EnergyLedger &self = getInstance();
+
+    self.logReport();
+    k_work_schedule(&self.reportWork, K_SECONDS(CONFIG_APP_ENERGY_REPORT_SECONDS));
+}
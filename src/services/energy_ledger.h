@@ -0,0 +1,79 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+
+namespace Services {
+    /**< Estimate of the charge drawn by each subsystem.
+     *
+     * Subsystems report how long they were active and how many operations they ran. Active time is
+     * multiplied by the subsystem current, CONFIG_APP_ENERGY_*_UA, and operations by their charge,
+     * CONFIG_APP_ENERGY_*_NC. Nothing is measured, so the estimate is the same on native_sim as on
+     * the device and the effect of a rate change can be compared before it is flashed. Since
+     * uA * ms is nC, the average current of a subsystem in uA is also its uAh per hour.
+     */
+    class EnergyLedger {
+      public:
+        enum class Subsystem : uint8_t {
+            Base,         // sleep current, always active
+            Bme680Heater, // heater-on time of each gas measurement
+            I2c,          // i2c2 transactions
+            Spi,          // accelerometer bursts
+            Led,          // LED on-time
+            Radio,        // uplink sessions, with the RRC tail as one operation per session
+            Flash,        // sector erases
+            Count,
+        };
+
+        static constexpr uint32_t FULL_DUTY = 1000;
+
+        struct Entry {
+            uint64_t activeMs;
+            uint32_t operations;
+            uint64_t chargeNc;
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        EnergyLedger(const EnergyLedger &)            = delete;
+        EnergyLedger &operator=(const EnergyLedger &) = delete;
+        static EnergyLedger &getInstance() { return instance; }
+        int init();
+
+        /**< Can be called from any context, including interrupts. */
+        void addActive(Subsystem subsystem, uint32_t ms);
+        void addOperations(Subsystem subsystem, uint32_t count = 1);
+        /**< Start or end an active interval, for subsystems that are switched on and off. */
+        void setActive(Subsystem subsystem, bool active) { setDuty(subsystem, active ? FULL_DUTY : 0); }
+        /**< Account the time from now on at a duty cycle in per mille, for subsystems that are
+         * switched by hardware, such as a blinking LED. 0 ends the interval. Several channels of
+         * a subsystem can be on at once, so the duty may exceed FULL_DUTY. */
+        void setDuty(Subsystem subsystem, uint32_t permille);
+
+        Entry entry(Subsystem subsystem) const;
+        /**< Average current since init(), in uA or equivalently uAh per hour. */
+        uint32_t averageMicroAmps(Subsystem subsystem) const;
+        uint32_t totalMicroAmps() const;
+        void logReport() const;
+        static const char *subsystemName(Subsystem subsystem);
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr EnergyLedger() = default;
+        static EnergyLedger instance;
+        static void reportHandler(struct k_work *work);
+        /**< Entry with the running intervals and the base current accounted up to now. */
+        Entry settled(Subsystem subsystem, int64_t now) const;
+
+        static constexpr size_t COUNT = static_cast<size_t>(Subsystem::Count);
+        static struct k_work_delayable reportWork;
+        mutable struct k_spinlock lock {};
+        Entry entries[COUNT]       = {};
+        int64_t activeSince[COUNT] = {}; // k_uptime_get() of the running interval, 0 if none
+        uint32_t duty[COUNT]       = {}; // of the running interval, per mille
+        int64_t start              = 0;
+        bool initialized           = false;
+    };
+} // namespace Services
@@ -0,0 +1,18 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+
+namespace Services {
+    /**< Boot-time benchmark of FeatureExtractor (CONFIG_APP_FEATURES_BENCHMARK).
+     * Runs every available backend on the same synthetic window and logs the cost per window in
+     * cycles along with the features, so the backends can also be checked against each other.
+     */
+    class FeatureBenchmark {
+      public:
+        static constexpr size_t ITERATIONS = 100;
+
+        /**< Run every backend ITERATIONS times and log one line per backend. */
+        static int run();
+    };
+} // namespace Services
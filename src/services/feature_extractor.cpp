@@ -0,0 +1,140 @@
+// Standard modules
+#include <cmath>
+// Zephyr modules
+#include <zephyr/sys/util.h>
+// App modules
+#include "feature_extractor.h"
+
+using Services::FeatureExtractor;
+
+/* Scratch of the scalar implementation. */
+static uint32_t magnitudes[FeatureExtractor::WINDOW];
+static float fftReal[FeatureExtractor::WINDOW];
+static float fftImag[FeatureExtractor::WINDOW];
+static float twiddleCos[FeatureExtractor::WINDOW / 2];
+static float twiddleSin[FeatureExtractor::WINDOW / 2];
+static float binEnergy[FeatureExtractor::WINDOW / 2];
+static bool twiddlesReady;
+
+static uint32_t squareRoot(uint64_t value) {
+    uint64_t root = 0;
+    uint64_t bit  = uint64_t{1} << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(root);
+}
+
+/**< In-place iterative radix-2 FFT of fftReal/fftImag. */
+static void fft() {
+    constexpr size_t N = FeatureExtractor::WINDOW;
+
+    if (!twiddlesReady) {
+        for (size_t i = 0; i < N / 2; i++) {
+            twiddleCos[i] = cosf(2.0f * static_cast<float>(M_PI) * i / N);
+            twiddleSin[i] = -sinf(2.0f * static_cast<float>(M_PI) * i / N);
+        }
+        twiddlesReady = true;
+    }
+
+    for (size_t i = 1, j = 0; i < N; i++) {
+        size_t bit = N >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            float real = fftReal[i];
+            fftReal[i] = fftReal[j];
+            fftReal[j] = real;
+        }
+    }
+
+    for (size_t length = 2; length <= N; length <<= 1) {
+        size_t stride = N / length;
+        for (size_t start = 0; start < N; start += length) {
+            for (size_t k = 0; k < length / 2; k++) {
+                size_t even = start + k;
+                size_t odd  = even + length / 2;
+                float wr    = twiddleCos[k * stride];
+                float wi    = twiddleSin[k * stride];
+                float tr    = fftReal[odd] * wr - fftImag[odd] * wi;
+                float ti    = fftReal[odd] * wi + fftImag[odd] * wr;
+                fftReal[odd]  = fftReal[even] - tr;
+                fftImag[odd]  = fftImag[even] - ti;
+                fftReal[even] += tr;
+                fftImag[even] += ti;
+            }
+        }
+    }
+}
+
+const char *FeatureExtractor::backendName() {
+#ifdef CONFIG_APP_FEATURES_BACKEND_CMSIS_DSP
+    return "cmsis-dsp";
+#else
+    return "scalar";
+#endif
+}
+
+void FeatureExtractor::extract(const int16_t *xyz, Features &features) {
+#ifdef CONFIG_APP_FEATURES_BACKEND_CMSIS_DSP
+    extractCmsis(xyz, features);
+#else
+    extractScalar(xyz, features);
+#endif
+}
+
+void FeatureExtractor::extractScalar(const int16_t *xyz, Features &features) {
+    uint64_t sum = 0;
+
+    features.peakMagnitude = 0;
+    for (size_t i = 0; i < WINDOW; i++) {
+        const int16_t *sample = &xyz[i * AXES];
+        uint32_t squares      = 0;
+        for (size_t axis = 0; axis < AXES; axis++) {
+            squares += static_cast<uint32_t>(sample[axis] * sample[axis]);
+        }
+        magnitudes[i] = squareRoot(squares);
+        sum += magnitudes[i];
+        features.peakMagnitude = MAX(features.peakMagnitude, magnitudes[i]);
+    }
+    features.meanMagnitude = static_cast<uint32_t>(sum / WINDOW);
+
+    uint64_t squares = 0;
+    int previousSign = 0;
+    features.zeroCrossings = 0;
+    for (size_t i = 0; i < WINDOW; i++) {
+        int32_t dynamic = static_cast<int32_t>(magnitudes[i]) - static_cast<int32_t>(features.meanMagnitude);
+        squares += static_cast<uint64_t>(int64_t{dynamic} * dynamic);
+        if (dynamic != 0) {
+            int sign = dynamic > 0 ? 1 : -1;
+            if (previousSign != 0 && sign != previousSign) {
+                features.zeroCrossings++;
+            }
+            previousSign = sign;
+        }
+        fftReal[i] = static_cast<float>(dynamic);
+        fftImag[i] = 0.0f;
+    }
+    features.rms = squareRoot(squares / WINDOW);
+
+    /* Same 1/N amplitude scaling as the fixed-point FFT, the shares do not depend on it. */
+    fft();
+    for (size_t bin = 0; bin < WINDOW / 2; bin++) {
+        float real     = fftReal[bin] / WINDOW;
+        float imag     = fftImag[bin] / WINDOW;
+        binEnergy[bin] = real * real + imag * imag;
+    }
+    bandShares(binEnergy, features);
+}
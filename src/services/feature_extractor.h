@@ -0,0 +1,62 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace Services {
+    /**< Features of fixed-size accelerometer windows, so windows can be classified on the device
+     * instead of uploading raw data.
+     *
+     * A window is CONFIG_APP_FEATURES_WINDOW_SAMPLES interleaved X, Y, Z int16 samples in sensor
+     * LSB. Everything is computed on the magnitude of the acceleration, so the result does not
+     * depend on how the device is oriented. extract() uses the backend chosen with
+     * CONFIG_APP_FEATURES_BACKEND_*. The scalar implementation is always built so the benchmark
+     * can compare it with CMSIS-DSP. The implementations share static scratch buffers and are not
+     * re-entrant.
+     */
+    class FeatureExtractor {
+      public:
+        static constexpr size_t WINDOW = CONFIG_APP_FEATURES_WINDOW_SAMPLES;
+        static constexpr size_t BANDS  = CONFIG_APP_FEATURES_BANDS;
+        static constexpr size_t AXES   = 3;
+        static_assert((WINDOW & (WINDOW - 1)) == 0, "The FFT needs a power of two window");
+        static_assert(BANDS > 0 && (WINDOW / 2) % BANDS == 0, "Bands must split the spectrum evenly");
+
+        struct Features {
+            uint32_t meanMagnitude; // LSB, about 1 g at rest
+            uint32_t rms;           // LSB, RMS of the magnitude around its mean
+            uint32_t peakMagnitude; // LSB
+            uint16_t zeroCrossings; // sign changes of the magnitude around its mean, per window
+            uint16_t bandEnergy[BANDS]; // share of the spectrum energy per band, in 1/65535
+        };
+
+        /**< Compute the features of xyz, WINDOW interleaved samples. */
+        static void extract(const int16_t *xyz, Features &features);
+        static void extractScalar(const int16_t *xyz, Features &features);
+#ifdef CONFIG_APP_FEATURES_BACKEND_CMSIS_DSP
+        static void extractCmsis(const int16_t *xyz, Features &features);
+#endif
+        static const char *backendName();
+
+      private:
+        /**< Turn per-bin energies of bins [0, WINDOW / 2) into the normalized band shares. */
+        template <typename Energy> static void bandShares(const Energy *bins, Features &features);
+    };
+
+    template <typename Energy> void FeatureExtractor::bandShares(const Energy *bins, Features &features) {
+        using Sum                      = std::conditional_t<std::is_floating_point_v<Energy>, float, uint64_t>;
+        constexpr size_t BINS_PER_BAND = WINDOW / 2 / BANDS;
+        Sum bands[BANDS]               = {};
+        Sum total                      = 0;
+
+        /* Bin 0 is the DC left over after removing the mean, it is not part of any band. */
+        for (size_t bin = 1; bin < WINDOW / 2; bin++) {
+            bands[bin / BINS_PER_BAND] += bins[bin];
+            total += bins[bin];
+        }
+        for (size_t band = 0; band < BANDS; band++) {
+            features.bandEnergy[band] = total ? static_cast<uint16_t>(bands[band] * UINT16_MAX / total) : 0;
+        }
+    }
+} // namespace Services
@@ -0,0 +1,74 @@
+// Standard modules
+#include <cstdint>
+// Zephyr modules
+#include <arm_math.h>
+// App modules
+#include "feature_extractor.h"
+
+using Services::FeatureExtractor;
+
+/* Magnitudes are kept as q31 holding the LSB value shifted left by MAGNITUDE_SHIFT, which is what
+ * arm_sqrt_q31 returns for the sum of squares halved into q31 range. */
+static constexpr int MAGNITUDE_SHIFT = 15;
+
+/* Scratch of the CMSIS-DSP implementation. */
+static q31_t magnitudes[FeatureExtractor::WINDOW];
+static q31_t dynamic[FeatureExtractor::WINDOW];
+static q15_t fftInput[FeatureExtractor::WINDOW];
+static q15_t fftOutput[2 * FeatureExtractor::WINDOW];
+static q15_t binEnergy[FeatureExtractor::WINDOW / 2];
+static arm_rfft_instance_q15 rfft;
+static bool rfftReady;
+
+void FeatureExtractor::extractCmsis(const int16_t *xyz, Features &features) {
+    for (size_t i = 0; i < WINDOW; i++) {
+        const int16_t *sample = &xyz[i * AXES];
+        uint32_t squares      = 0;
+        for (size_t axis = 0; axis < AXES; axis++) {
+            squares += static_cast<uint32_t>(sample[axis] * sample[axis]);
+        }
+        /* At most 3 * 2^30, halved it always fits a positive q31. */
+        arm_sqrt_q31(static_cast<q31_t>(squares >> 1), &magnitudes[i]);
+    }
+
+    q31_t mean;
+    q31_t peak;
+    q31_t rms;
+    uint32_t index;
+    arm_mean_q31(magnitudes, WINDOW, &mean);
+    arm_max_q31(magnitudes, WINDOW, &peak, &index);
+    arm_offset_q31(magnitudes, -mean, dynamic, WINDOW);
+    arm_rms_q31(dynamic, WINDOW, &rms);
+    features.meanMagnitude = static_cast<uint32_t>(mean >> MAGNITUDE_SHIFT);
+    features.peakMagnitude = static_cast<uint32_t>(peak >> MAGNITUDE_SHIFT);
+    features.rms           = static_cast<uint32_t>(rms >> MAGNITUDE_SHIFT);
+
+    int previousSign = 0;
+    features.zeroCrossings = 0;
+    for (size_t i = 0; i < WINDOW; i++) {
+        if (dynamic[i] != 0) {
+            int sign = dynamic[i] > 0 ? 1 : -1;
+            if (previousSign != 0 && sign != previousSign) {
+                features.zeroCrossings++;
+            }
+            previousSign = sign;
+        }
+    }
+
+    /* The q15 FFT scales its output down by the length, normalize the window first so small
+     * movements do not vanish in the 16 bit bins. The band shares do not depend on the scale. */
+    q31_t largest;
+    arm_absmax_q31(dynamic, WINDOW, &largest, &index);
+    if (largest > 0) {
+        arm_shift_q31(dynamic, static_cast<int8_t>(__CLZ(static_cast<uint32_t>(largest)) - 1), dynamic, WINDOW);
+    }
+    arm_q31_to_q15(dynamic, fftInput, WINDOW);
+
+    if (!rfftReady) {
+        arm_rfft_init_q15(&rfft, WINDOW, 0, 1);
+        rfftReady = true;
+    }
+    arm_rfft_q15(&rfft, fftInput, fftOutput);
+    arm_cmplx_mag_squared_q15(fftOutput, binEnergy, WINDOW / 2);
+    bandShares(binEnergy, features);
+}
@@ -0,0 +1,120 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+
+namespace Services {
+    /**< Indoor air quality index from the BME680 gas resistance, in fixed point.
+     *
+     * The gas resistance is taken as log2 in Q16, where a ratio of resistances is a difference, and
+     * compensated for humidity: the resistance of the metal oxide falls about 3.5 % per %RH, so
+     * HUMIDITY_SLOPE per %RH above HUMIDITY_REFERENCE is added back. The baseline is the clean air
+     * level of the compensated value: it rises within a few samples when the air gets cleaner and
+     * sinks by 2^-DECAY_SHIFT per sample towards lower values, so it follows the sensor's drift but
+     * not a polluted hour. The index is 25 at the baseline and rises by IAQ_PER_HALVING every time
+     * the compensated resistance halves below it, clamped to 0..500.
+     *
+     * Accuracy follows the samples learned into the baseline, over boots when the State is restored,
+     * and is Unreliable for the first warm-up samples of every boot while the heater plate settles.
+     * Those samples are measured against the baseline but not learned into it.
+     * No kernel calls and O(1) per sample.
+     */
+    class IaqEstimator {
+      public:
+        enum class Accuracy : uint8_t { Unreliable, Low, Medium, High };
+
+        static constexpr unsigned FRACTION_BITS      = 16;
+        static constexpr int32_t HUMIDITY_SLOPE      = 3309;  // log2(e^0.035) in Q16, per %RH
+        static constexpr uint32_t HUMIDITY_REFERENCE = 40000; // 0.001 %RH
+        static constexpr unsigned RISE_SHIFT         = 4;
+        static constexpr unsigned DECAY_SHIFT        = 14;
+        static constexpr int32_t IAQ_BASELINE        = 25;
+        static constexpr int32_t IAQ_PER_HALVING     = 125;
+        static constexpr int32_t IAQ_MAX             = 500;
+        // Samples learned for each accuracy, about 1 h and 24 h at the 2 s period
+        static constexpr uint32_t LEARNED_MEDIUM     = 1800;
+        static constexpr uint32_t LEARNED_HIGH       = 43200;
+
+        /**< What has to survive a reboot. */
+        struct __attribute__((packed)) State {
+            int32_t baseline; // log2 of ohm, Q16
+            uint32_t learned; // samples learned into the baseline
+        };
+
+        struct Result {
+            uint16_t iaq;
+            Accuracy accuracy;
+            int32_t compensated; // log2 of ohm, Q16
+        };
+
+        explicit constexpr IaqEstimator(uint32_t warmupSamples) : warmupSamples(warmupSamples) {}
+
+        void restore(const State &state) { current = state; }
+        const State &state() const { return current; }
+
+        /**< gasResistance in ohm, humidity in 0.001 %RH, as in a Sample. */
+        Result add(uint32_t gasResistance, uint32_t humidity) {
+            int32_t humidityDelta = static_cast<int32_t>(humidity) - static_cast<int32_t>(HUMIDITY_REFERENCE);
+            int32_t compensated   = log2(gasResistance == 0 ? 1 : gasResistance) +
+                                  static_cast<int32_t>(int64_t{HUMIDITY_SLOPE} * humidityDelta / 1000);
+
+            if (sinceBoot != UINT32_MAX) {
+                sinceBoot++;
+            }
+            // The heater plate is still settling, its readings would pull the baseline down
+            if (sinceBoot > warmupSamples) {
+                learn(compensated);
+            }
+
+            int64_t below = current.baseline - compensated;
+            int64_t iaq   = IAQ_BASELINE + (below > 0 ? (below * IAQ_PER_HALVING) >> FRACTION_BITS : 0);
+            return {
+                .iaq         = static_cast<uint16_t>(iaq > IAQ_MAX ? IAQ_MAX : iaq),
+                .accuracy    = accuracy(),
+                .compensated = compensated,
+            };
+        }
+
+        Accuracy accuracy() const {
+            if (sinceBoot <= warmupSamples) {
+                return Accuracy::Unreliable;
+            }
+            if (current.learned < LEARNED_MEDIUM) {
+                return Accuracy::Low;
+            }
+            return current.learned < LEARNED_HIGH ? Accuracy::Medium : Accuracy::High;
+        }
+
+        /**< log2(value) in Q16, value > 0. Sixteen squarings of the mantissa, one per fraction bit. */
+        static int32_t log2(uint32_t value) {
+            int32_t exponent  = 31 - __builtin_clz(value);
+            uint64_t mantissa = static_cast<uint64_t>(value) << (31 - exponent); // [1, 2) in Q31
+            int32_t result    = exponent << FRACTION_BITS;
+            for (int32_t bit = FRACTION_BITS - 1; bit >= 0; bit--) {
+                mantissa = (mantissa * mantissa) >> 31;
+                if (mantissa >= (uint64_t{1} << 32)) {
+                    mantissa >>= 1;
+                    result |= int32_t{1} << bit;
+                }
+            }
+            return result;
+        }
+
+      private:
+        void learn(int32_t compensated) {
+            if (current.learned == 0) {
+                current.baseline = compensated;
+            } else if (compensated > current.baseline) {
+                current.baseline += (compensated - current.baseline) >> RISE_SHIFT;
+            } else {
+                current.baseline -= (current.baseline - compensated) >> DECAY_SHIFT;
+            }
+            if (current.learned != UINT32_MAX) {
+                current.learned++;
+            }
+        }
+
+        uint32_t warmupSamples;
+        State current      = {};
+        uint32_t sinceBoot = 0;
+    };
+} // namespace Services
@@ -0,0 +1,153 @@
+// Standard modules
+#include <cstdlib>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+// App modules
+#include "impact.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+#ifdef CONFIG_APP_FEATURES
+using Services::FeatureExtractor;
+#endif
+using Services::Impact;
+
+LOG_MODULE_REGISTER(impact, LOG_LEVEL_INF);
+
+K_THREAD_STACK_DEFINE(impactStack, CONFIG_APP_IMPACT_STACK_SIZE);
+
+constinit Impact Impact::instance;
+struct k_work_q Impact::workQueue;
+K_WORK_DEFINE(Impact::windowWork, Impact::windowHandler);
+/* One slot per driver capture buffer, so a put never fails while the driver has one to lend. */
+K_MSGQ_DEFINE(windows, sizeof(struct our_adxl372_capture), 2, 8);
+
+int Impact::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    accelerometer = DEVICE_DT_GET_ONE(our_adxl372);
+    if (!device_is_ready(accelerometer)) {
+        LOG_ERR("ADXL372 not ready");
+        return -ENODEV;
+    }
+
+    k_work_queue_start(&workQueue, impactStack, K_THREAD_STACK_SIZEOF(impactStack),
+                       CONFIG_APP_IMPACT_THREAD_PRIORITY, nullptr);
+    k_thread_name_set(&workQueue.thread, "impact");
+
+    callbacks.impact    = impactCallback;
+    callbacks.capture   = captureCallback;
+    callbacks.user_data = this;
+    int error           = our_adxl372_impact_arm(accelerometer, &callbacks);
+    if (error) {
+        LOG_ERR("Failed to arm impact capture: %d", error);
+        return error;
+    }
+
+    initialized = true;
+    LOG_INF("Initialized Impact: %d mg threshold, %d pre-trigger samples",
+            CONFIG_OUR_ADXL372_ACTIVITY_THRESHOLD_MG, CONFIG_OUR_ADXL372_PRE_TRIGGER_SAMPLES);
+    return 0;
+}
+
+int Impact::addListener(Listener listener) {
+    if (listenerCount == ARRAY_SIZE(listeners)) {
+        return -ENOMEM;
+    }
+    listeners[listenerCount++] = listener;
+    return 0;
+}
+
+uint32_t Impact::windowsDropped() const {
+    return accelerometer ? our_adxl372_captures_dropped(accelerometer) : 0;
+}
+
+void Impact::notify(const Event &event) {
+    for (size_t i = 0; i < listenerCount; i++) {
+        listeners[i](event);
+    }
+}
+
+void Impact::impactCallback(const struct device *dev, int64_t time, void *userData) {
+    Impact &self = *static_cast<Impact *>(userData);
+
+    self.detected++;
+    self.notify({.time = time, .peakMg = 0, .window = nullptr});
+}
+
+/**< Runs on the driver thread. The capture descriptor is copied, its buffer stays held until
+ * windowHandler() is done with it.
+ */
+void Impact::captureCallback(const struct device *dev, const struct our_adxl372_capture *capture,
+                             void *userData) {
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::Spi);
+#endif
+
+    if (k_msgq_put(&windows, capture, K_NO_WAIT) != 0) {
+        LOG_WRN("Impact window dropped, queue full");
+        our_adxl372_capture_release(dev, capture);
+        return;
+    }
+    k_work_submit_to_queue(&workQueue, &windowWork);
+}
+
+void Impact::windowHandler(struct k_work *work) {
+    Impact &self = getInstance();
+    struct our_adxl372_capture capture;
+
+    while (k_msgq_get(&windows, &capture, K_NO_WAIT) == 0) {
+        int32_t peakMg = 0;
+        for (size_t i = 0; i < capture.entries; i++) {
+            peakMg = MAX(peakMg, abs(our_adxl372_entry_mg(&capture, i)));
+        }
+        LOG_INF("Impact window: %u samples, peak %d mg, processed %lld ms after the impact",
+                capture.entries / OUR_ADXL372_AXES, peakMg, k_uptime_get() - capture.trigger_time);
+
+#ifdef CONFIG_APP_FEATURES
+        const FeatureExtractor::Features *features = extractFeatures(capture);
+        self.notify({.time = capture.trigger_time, .peakMg = peakMg, .window = &capture, .features = features});
+#else
+        self.notify({.time = capture.trigger_time, .peakMg = peakMg, .window = &capture});
+#endif
+        our_adxl372_capture_release(self.accelerometer, &capture);
+    }
+}
+
+#ifdef CONFIG_APP_FEATURES
+/**< Features of FeatureExtractor::WINDOW samples of the capture, with the impact a quarter into the
+ * window. Returns nullptr if the capture is shorter than the window. Runs on the impact work queue.
+ */
+const FeatureExtractor::Features *Impact::extractFeatures(const struct our_adxl372_capture &capture) {
+    static int16_t xyz[FeatureExtractor::WINDOW * FeatureExtractor::AXES];
+    static FeatureExtractor::Features features;
+    size_t samples = capture.entries / OUR_ADXL372_AXES;
+
+    if (samples < FeatureExtractor::WINDOW) {
+        LOG_DBG("Impact window of %u samples too short for features", static_cast<unsigned int>(samples));
+        return nullptr;
+    }
+
+    size_t trigger = capture.pre_trigger / OUR_ADXL372_AXES;
+    size_t first   = trigger > FeatureExtractor::WINDOW / 4 ? trigger - FeatureExtractor::WINDOW / 4 : 0;
+    first          = MIN(first, samples - FeatureExtractor::WINDOW);
+    for (size_t i = 0; i < ARRAY_SIZE(xyz); i++) {
+        xyz[i] = static_cast<int16_t>(our_adxl372_entry_mg(&capture, first * OUR_ADXL372_AXES + i) /
+                                      OUR_ADXL372_MG_PER_LSB);
+    }
+
+    FeatureExtractor::extract(xyz, features);
+    LOG_INF("Impact features: peak %u, rms %u LSB, %u zero crossings", features.peakMagnitude, features.rms,
+            features.zeroCrossings);
+    return &features;
+}
+#endif
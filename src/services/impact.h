@@ -0,0 +1,73 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+// App modules
+#ifdef CONFIG_APP_FEATURES
+#include "feature_extractor.h"
+#endif
+#include "our_drivers/our_adxl372.h"
+
+namespace Services {
+    /**< Impact detection and capture from the ADXL372.
+     *
+     * The driver records a window around every impact in the accelerometer FIFO and reads it with a
+     * single SPI burst into one of its two capture buffers. Listeners get the impact as soon as the
+     * activity interrupt fires, from the driver thread. The window itself is processed on the
+     * service's own work queue, lent to the listeners without copying and handed back to the driver
+     * once every listener returned, so the driver thread is free for the next impact meanwhile.
+     * With CONFIG_APP_FEATURES the window also comes with its FeatureExtractor features, so
+     * listeners can classify the impact without looking at the raw samples.
+     */
+    class Impact {
+      public:
+        struct Event {
+            int64_t time;                              // k_uptime_get() of the activity interrupt
+            int32_t peakMg;                            // 0 until the window is captured
+            const struct our_adxl372_capture *window;  // nullptr on detection, valid during the call
+#ifdef CONFIG_APP_FEATURES
+            const FeatureExtractor::Features *features; // nullptr on detection or a short window
+#endif
+        };
+        using Listener = void (*)(const Event &event);
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Impact(const Impact &)            = delete;
+        Impact &operator=(const Impact &) = delete;
+        static Impact &getInstance() { return instance; }
+        int init();
+        /**< Detections are reported from the ADXL372 driver thread, keep them short. Windows are
+         * reported from the impact work queue and hold a capture buffer while the listener runs.
+         */
+        int addListener(Listener listener);
+
+        uint32_t impacts() const { return detected; }
+        uint32_t windowsDropped() const;
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr Impact() = default;
+        static Impact instance;
+        static void impactCallback(const struct device *dev, int64_t time, void *userData);
+        static void captureCallback(const struct device *dev, const struct our_adxl372_capture *capture,
+                                    void *userData);
+        static void windowHandler(struct k_work *work);
+#ifdef CONFIG_APP_FEATURES
+        static const FeatureExtractor::Features *extractFeatures(const struct our_adxl372_capture &capture);
+#endif
+        void notify(const Event &event);
+
+        static struct k_work_q workQueue;
+        static struct k_work windowWork;
+
+        const struct device *accelerometer = nullptr;
+        struct our_adxl372_callbacks callbacks {};
+        Listener listeners[CONFIG_APP_IMPACT_MAX_LISTENERS] = {};
+        size_t listenerCount = 0;
+        uint32_t detected    = 0;
+        bool initialized     = false;
+    };
+} // namespace Services
@@ -0,0 +1,350 @@
+// Zephyr modules
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/spinlock.h>
+#include <errno.h>
+#include <hal/nrf_rtc.h>
+#include <helpers/nrfx_gppi.h>
+#include <nrfx_gpiote.h>
+#include <nrfx_pwm.h>
+// App modules
+#include "led.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+using Services::Led;
+
+LOG_MODULE_REGISTER(led, LOG_LEVEL_INF);
+
+#define CHANNELS 3
+
+/* 125 kHz and a top of 1000 give the 8 ms period of the pwm-leds nodes. */
+#define PWM_TOP       1000
+#define PWM_PERIOD_MS 8
+/* Bit 15 of a PWM value selects the polarity, set it for an active-high LED. */
+#define PWM_ACTIVE_HIGH BIT(15)
+
+/* Duty of the pattern in per mille, for the energy estimate. */
+#define FULL_DUTY 1000U
+
+#define BREATHE_STEPS 32
+#define PWM_MAX_STEPS MAX(BREATHE_STEPS, 2 * Led::MAX_STATUS_CODE + 3)
+
+/* RTC0 at 1024 Hz, Zephyr's system clock uses RTC1. */
+#define RTC_PRESCALER 31
+#define RTC_HZ        (32768 / (RTC_PRESCALER + 1))
+
+static const struct gpio_dt_spec pins[CHANNELS] = {
+    GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios),
+    GPIO_DT_SPEC_GET(DT_ALIAS(led1), gpios),
+    GPIO_DT_SPEC_GET(DT_ALIAS(led2), gpios),
+};
+static const uint32_t psels[CHANNELS] = {
+    NRF_DT_GPIOS_TO_PSEL(DT_ALIAS(led0), gpios),
+    NRF_DT_GPIOS_TO_PSEL(DT_ALIAS(led1), gpios),
+    NRF_DT_GPIOS_TO_PSEL(DT_ALIAS(led2), gpios),
+};
+
+static const nrfx_pwm_t pwm         = NRFX_PWM_INSTANCE(0);
+static const nrfx_gpiote_t gpiote   = NRFX_GPIOTE_INSTANCE(NRF_DT_GPIOTE_INST(DT_ALIAS(led0), gpios));
+static NRF_RTC_Type *const rtc      = NRF_RTC0;
+/* Read by the PWM with EasyDMA while the sequence loops. */
+static nrf_pwm_values_individual_t sequence[PWM_MAX_STEPS];
+static uint8_t onChannel;  // RTC COMPARE1, end of the period: pins set, RTC cleared
+static uint8_t offChannel; // RTC COMPARE0, end of the on time: pins cleared
+
+static uint16_t *channelValue(nrf_pwm_values_individual_t &step, size_t channel) {
+    uint16_t *values[] = {&step.channel_0, &step.channel_1, &step.channel_2};
+    return values[channel];
+}
+
+static bool hasChannel(Led::Color color, size_t channel) { return static_cast<uint8_t>(color) & BIT(channel); }
+
+constinit Led Led::instance;
+K_WORK_DELAYABLE_DEFINE(Led::applyWork, Led::applyHandler);
+
+int Led::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    for (const struct gpio_dt_spec &pin : pins) {
+        if (!gpio_is_ready_dt(&pin)) {
+            LOG_ERR("LED GPIO not ready");
+            return -ENODEV;
+        }
+        int error = gpio_pin_configure_dt(&pin, GPIO_OUTPUT_INACTIVE);
+        if (error) {
+            LOG_ERR("Failed to configure LED pin: %d", error);
+            return error;
+        }
+    }
+
+    /* The blink wiring never changes: the GPIOTE channels of all three pins follow the RTC
+     * events, and a colour is picked by enabling the task mode of its pins only.
+     */
+    if (nrfx_gppi_channel_alloc(&onChannel) != NRFX_SUCCESS ||
+        nrfx_gppi_channel_alloc(&offChannel) != NRFX_SUCCESS) {
+        LOG_ERR("No DPPI channel left for the LED");
+        return -ENOMEM;
+    }
+    nrfx_gppi_event_endpoint_setup(onChannel, nrf_rtc_event_address_get(rtc, NRF_RTC_EVENT_COMPARE_1));
+    nrfx_gppi_task_endpoint_setup(onChannel, nrf_rtc_task_address_get(rtc, NRF_RTC_TASK_CLEAR));
+    nrfx_gppi_event_endpoint_setup(offChannel, nrf_rtc_event_address_get(rtc, NRF_RTC_EVENT_COMPARE_0));
+
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+        uint8_t gpioteChannel;
+        if (nrfx_gpiote_channel_alloc(&gpiote, &gpioteChannel) != NRFX_SUCCESS) {
+            LOG_ERR("No GPIOTE channel left for the LED");
+            return -ENOMEM;
+        }
+        nrfx_gpiote_output_config_t output = NRFX_GPIOTE_DEFAULT_OUTPUT_CONFIG;
+        nrfx_gpiote_task_config_t task     = {
+            .task_ch  = gpioteChannel,
+            .polarity = NRF_GPIOTE_POLARITY_TOGGLE,
+            .init_val = NRF_GPIOTE_INITIAL_VALUE_HIGH,
+        };
+        if (nrfx_gpiote_output_configure(&gpiote, psels[channel], &output, &task) != NRFX_SUCCESS) {
+            LOG_ERR("Failed to configure the LED GPIOTE channel");
+            return -EIO;
+        }
+        nrfx_gppi_fork_endpoint_setup(onChannel, nrfx_gpiote_set_task_address_get(&gpiote, psels[channel]));
+        nrfx_gppi_fork_endpoint_setup(offChannel, nrfx_gpiote_clr_task_address_get(&gpiote, psels[channel]));
+    }
+    nrf_rtc_prescaler_set(rtc, RTC_PRESCALER);
+    nrf_rtc_event_enable(rtc, NRF_RTC_INT_COMPARE0_MASK | NRF_RTC_INT_COMPARE1_MASK);
+
+    initialized = true;
+    LOG_INF("Initialized Led");
+    return 0;
+}
+
+int Led::show(Priority priority, const Pattern &pattern, uint32_t durationMs) {
+    if (priority >= Priority::Count) {
+        return -EINVAL;
+    }
+    if (pattern.kind == Pattern::Kind::StatusCode && (pattern.code == 0 || pattern.code > MAX_STATUS_CODE)) {
+        return -EINVAL;
+    }
+    if (pattern.kind == Pattern::Kind::Blink && (pattern.onMs == 0 || pattern.onMs >= pattern.periodMs)) {
+        return -EINVAL;
+    }
+
+    int64_t expiry = durationMs ? k_uptime_get() + durationMs : 0;
+    K_SPINLOCK(&lock) {
+        slots[static_cast<size_t>(priority)] = {.pattern = pattern, .expiry = expiry, .active = true};
+    }
+    (void)k_work_reschedule(&applyWork, K_NO_WAIT);
+    return 0;
+}
+
+void Led::clear(Priority priority) {
+    if (priority >= Priority::Count) {
+        return;
+    }
+    K_SPINLOCK(&lock) {
+        slots[static_cast<size_t>(priority)].active = false;
+    }
+    (void)k_work_reschedule(&applyWork, K_NO_WAIT);
+}
+
+void Led::applyHandler(struct k_work *work) { getInstance().apply(); }
+
+/**< Display the highest priority pattern and wake up again for the next expiry. */
+void Led::apply() {
+    int64_t now        = k_uptime_get();
+    int64_t nextExpiry = 0;
+    Pattern pattern    = Pattern::off();
+    bool found         = false;
+
+    K_SPINLOCK(&lock) {
+        for (size_t i = PRIORITIES; i-- > 0;) {
+            Slot &slot = slots[i];
+            if (slot.active && slot.expiry != 0 && slot.expiry <= now) {
+                slot.active = false;
+            }
+            if (!slot.active) {
+                continue;
+            }
+            if (!found) {
+                pattern = slot.pattern;
+                found   = true;
+            }
+            if (slot.expiry != 0 && (nextExpiry == 0 || slot.expiry < nextExpiry)) {
+                nextExpiry = slot.expiry;
+            }
+        }
+    }
+
+    if (!initialized) {
+        return;
+    }
+    if (!(pattern == shown)) {
+        stop();
+        int error = start(pattern);
+        if (error) {
+            LOG_ERR("Failed to start LED pattern: %d", error);
+            pattern = Pattern::off();
+        }
+        shown = pattern;
+    }
+    if (nextExpiry) {
+        (void)k_work_reschedule(&applyWork, K_MSEC(nextExpiry - now));
+    }
+}
+
+void Led::setPins(Color color, bool on) {
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+        (void)gpio_pin_set_dt(&pins[channel], on && hasChannel(color, channel));
+    }
+}
+
+/**< Hand the pins back to GPIO, driven low. */
+void Led::stop() {
+    setPins(Color::White, false);
+    if (pwmRunning) {
+        (void)nrfx_pwm_stop(&pwm, true);
+        nrfx_pwm_uninit(&pwm);
+        pwmRunning = false;
+    }
+    if (blinkRunning) {
+        nrf_rtc_task_trigger(rtc, NRF_RTC_TASK_STOP);
+        nrfx_gppi_channels_disable(BIT(onChannel) | BIT(offChannel));
+        for (uint32_t psel : psels) {
+            nrfx_gpiote_out_task_disable(&gpiote, psel);
+        }
+        blinkRunning = false;
+    }
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger::getInstance().setDuty(EnergyLedger::Subsystem::Led, 0);
+#endif
+}
+
+int Led::start(const Pattern &pattern) {
+    [[maybe_unused]] uint32_t duty = 0;
+    int error                      = 0;
+
+    switch (pattern.kind) {
+    case Pattern::Kind::Off:
+        break;
+    case Pattern::Kind::Solid:
+        if (pattern.brightness >= 100) {
+            /* Fully on needs no peripheral at all. */
+            setPins(pattern.color, true);
+            duty = FULL_DUTY;
+        } else {
+            error = startPwm(pattern);
+            duty  = pattern.brightness * FULL_DUTY / 100U;
+        }
+        break;
+    case Pattern::Kind::Blink:
+        error = startBlink(pattern);
+        duty  = pattern.onMs * FULL_DUTY / pattern.periodMs;
+        break;
+    case Pattern::Kind::Breathe:
+        error = startPwm(pattern);
+        /* Mean of the quadratic ramp. */
+        duty = pattern.brightness * FULL_DUTY / 100U * 3U / 8U;
+        break;
+    case Pattern::Kind::StatusCode:
+        error = startPwm(pattern);
+        duty  = pattern.code * FULL_DUTY / (2U * pattern.code + 3U);
+        break;
+    }
+
+#ifdef CONFIG_APP_ENERGY
+    if (error == 0) {
+        /* Every lit channel draws the LED current. */
+        uint32_t channels = POPCOUNT(static_cast<uint8_t>(pattern.color));
+        EnergyLedger::getInstance().setDuty(EnergyLedger::Subsystem::Led, duty * channels);
+    }
+#endif
+    return error;
+}
+
+int Led::startPwm(const Pattern &pattern) {
+    uint16_t levels[PWM_MAX_STEPS];
+    size_t steps;
+    uint32_t stepMs;
+
+    switch (pattern.kind) {
+    case Pattern::Kind::Breathe:
+        /* Quadratic ramp up then down, closer to perceived brightness than a linear one. */
+        steps  = BREATHE_STEPS;
+        stepMs = pattern.periodMs / BREATHE_STEPS;
+        for (size_t i = 0; i < steps / 2; i++) {
+            uint32_t level = (i + 1) * (i + 1) * PWM_TOP / ((steps / 2) * (steps / 2));
+            levels[i] = levels[steps - 1 - i] = static_cast<uint16_t>(level * pattern.brightness / 100U);
+        }
+        break;
+    case Pattern::Kind::StatusCode:
+        steps  = 2U * pattern.code + 3U;
+        stepMs = pattern.onMs;
+        for (size_t i = 0; i < steps; i++) {
+            levels[i] = (i < 2U * pattern.code && i % 2 == 0) ? PWM_TOP : 0;
+        }
+        break;
+    default:
+        steps     = 1;
+        stepMs    = PWM_PERIOD_MS;
+        levels[0] = static_cast<uint16_t>(PWM_TOP * pattern.brightness / 100U);
+        break;
+    }
+
+    for (size_t i = 0; i < steps; i++) {
+        for (size_t channel = 0; channel < CHANNELS; channel++) {
+            *channelValue(sequence[i], channel) =
+                PWM_ACTIVE_HIGH | (hasChannel(pattern.color, channel) ? levels[i] : 0);
+        }
+        sequence[i].channel_3 = PWM_ACTIVE_HIGH;
+    }
+
+    nrfx_pwm_config_t config = NRFX_PWM_DEFAULT_CONFIG(psels[0], psels[1], psels[2], NRF_PWM_PIN_NOT_CONNECTED);
+    config.base_clock        = NRF_PWM_CLK_125kHz;
+    config.count_mode        = NRF_PWM_MODE_UP;
+    config.top_value         = PWM_TOP;
+    config.load_mode         = NRF_PWM_LOAD_INDIVIDUAL;
+    config.step_mode         = NRF_PWM_STEP_AUTO;
+    // The pins stay GPIO outputs, nrfx_pwm_uninit() would otherwise leave them disconnected inputs
+    config.skip_gpio_cfg     = true;
+    if (nrfx_pwm_init(&pwm, &config, nullptr, nullptr) != NRFX_SUCCESS) {
+        return -EBUSY;
+    }
+
+    /* Each value is played for 1 + repeats PWM periods, the loop restarts the sequence without the CPU. */
+    nrf_pwm_sequence_t playback = {
+        .values    = {.p_individual = sequence},
+        .length    = static_cast<uint16_t>(steps * NRF_PWM_VALUES_LENGTH(sequence[0])),
+        .repeats   = MAX(stepMs / PWM_PERIOD_MS, 1U) - 1,
+        .end_delay = 0,
+    };
+    pwmRunning = true;
+    (void)nrfx_pwm_simple_playback(&pwm, &playback, 1, NRFX_PWM_FLAG_LOOP);
+    return 0;
+}
+
+int Led::startBlink(const Pattern &pattern) {
+    nrf_rtc_task_trigger(rtc, NRF_RTC_TASK_STOP);
+    nrf_rtc_task_trigger(rtc, NRF_RTC_TASK_CLEAR);
+    nrf_rtc_cc_set(rtc, 0, MAX(pattern.onMs * RTC_HZ / 1000U, 1U));
+    nrf_rtc_cc_set(rtc, 1, pattern.periodMs * RTC_HZ / 1000U);
+    nrf_rtc_event_clear(rtc, NRF_RTC_EVENT_COMPARE_0);
+    nrf_rtc_event_clear(rtc, NRF_RTC_EVENT_COMPARE_1);
+
+    /* Task mode starts the pins high, the first period begins with the LED on. */
+    for (size_t channel = 0; channel < CHANNELS; channel++) {
+        if (hasChannel(pattern.color, channel)) {
+            nrfx_gpiote_out_task_enable(&gpiote, psels[channel]);
+        }
+    }
+    nrfx_gppi_channels_enable(BIT(onChannel) | BIT(offChannel));
+    nrf_rtc_task_trigger(rtc, NRF_RTC_TASK_START);
+    blinkRunning = true;
+    return 0;
+}
@@ -0,0 +1,116 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/util.h>
+
+namespace Services {
+    /**< RGB LED patterns played by hardware.
+     *
+     * Breathe, status codes and dimmed colours are PWM sequences looped by the PWM peripheral.
+     * Blinks toggle the pins through GPIOTE tasks fired over DPPI by RTC0 compare events, so
+     * they run from the 32 kHz clock without the PWM clock. Once a pattern started the CPU is not
+     * woken until the pattern changes or expires.
+     *
+     * Callers show a pattern at a priority and the highest priority pattern is displayed, so a
+     * status indication never has to know what else is using the LED. show() and clear() only
+     * record the request, the hardware is reprogrammed from the system work queue.
+     */
+    class Led {
+      public:
+        enum class Color : uint8_t {
+            Red     = BIT(0),
+            Green   = BIT(1),
+            Blue    = BIT(2),
+            Yellow  = BIT(0) | BIT(1),
+            Magenta = BIT(0) | BIT(2),
+            Cyan    = BIT(1) | BIT(2),
+            White   = BIT(0) | BIT(1) | BIT(2),
+        };
+
+        enum class Priority : uint8_t {
+            Background, // heartbeat
+            Status,     // connection state and the like
+            Alert,      // needs attention
+            Critical,
+            Count,
+        };
+
+        struct Pattern {
+            enum class Kind : uint8_t {
+                Off,
+                Solid,
+                Blink,
+                Breathe,
+                StatusCode,
+            };
+
+            Kind kind;
+            Color color;
+            uint8_t brightness; // percent, Solid and Breathe
+            uint8_t code;       // number of flashes, StatusCode
+            uint16_t onMs;      // Blink on time, StatusCode flash length
+            uint16_t periodMs;  // Blink and Breathe
+
+            bool operator==(const Pattern &other) const = default;
+            static constexpr Pattern off() { return {Kind::Off, Color::White, 0, 0, 0, 0}; }
+            static constexpr Pattern solid(Color color, uint8_t brightness = 100) {
+                return {Kind::Solid, color, brightness, 0, 0, 0};
+            }
+            static constexpr Pattern blink(Color color, uint16_t onMs, uint16_t periodMs) {
+                return {Kind::Blink, color, 100, 0, onMs, periodMs};
+            }
+            static constexpr Pattern breathe(Color color, uint16_t periodMs, uint8_t brightness = 100) {
+                return {Kind::Breathe, color, brightness, 0, 0, periodMs};
+            }
+            /**< code flashes of flashMs, then a pause of three flashes. */
+            static constexpr Pattern statusCode(Color color, uint8_t code, uint16_t flashMs = 200) {
+                return {Kind::StatusCode, color, 100, code, flashMs, 0};
+            }
+        };
+
+        static constexpr uint8_t MAX_STATUS_CODE = 15;
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Led(const Led &)            = delete;
+        Led &operator=(const Led &) = delete;
+        static Led &getInstance() { return instance; }
+        int init();
+
+        /**< Show pattern at priority, replacing the one shown at that priority before. durationMs 0
+         * keeps it until clear(). Never blocks, can be called from interrupts. */
+        int show(Priority priority, const Pattern &pattern, uint32_t durationMs = 0);
+        void clear(Priority priority);
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        static constexpr size_t PRIORITIES = static_cast<size_t>(Priority::Count);
+
+        struct Slot {
+            Pattern pattern;
+            int64_t expiry; // k_uptime_get(), 0 for none
+            bool active;
+        };
+
+        constexpr Led() = default;
+        static Led instance;
+        static void applyHandler(struct k_work *work);
+        void apply();
+        void stop();
+        int start(const Pattern &pattern);
+        int startPwm(const Pattern &pattern);
+        int startBlink(const Pattern &pattern);
+        void setPins(Color color, bool on);
+
+        static struct k_work_delayable applyWork;
+        struct k_spinlock lock {};
+        Slot slots[PRIORITIES] = {};
+        Pattern shown          = Pattern::off();
+        bool pwmRunning        = false;
+        bool blinkRunning      = false;
+        bool initialized       = false;
+    };
+} // namespace Services
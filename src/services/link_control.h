@@ -0,0 +1,49 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+
+namespace Services {
+    /**< Link-control layer used by Services::Connectivity. One backend is linked in, chosen with
+     * CONFIG_APP_CONNECTIVITY_LINK_*: link_control_nrf.cpp drives the modem through lte_lc,
+     * link_control_stub.cpp simulates an attach so the service also runs on native_sim.
+     */
+    namespace LinkControl {
+        enum class Event : uint8_t {
+            Searching,
+            RegisteredHome,
+            RegisteredRoaming,
+            NotRegistered,
+            Failed,
+        };
+        using EventHandler = void (*)(Event event);
+
+        /**< Serving cell signal, QUALITY_UNKNOWN where the modem has no measurement. */
+        struct Quality {
+            int16_t rsrp; // dBm
+            int16_t rsrq; // dB
+        };
+        static constexpr int16_t QUALITY_UNKNOWN = INT16_MIN;
+        using QualityHandler = void (*)(const Quality &quality);
+
+        /**< Boot the modem. May block for the modem start-up time. */
+        int modemInit();
+        /**< Configure the APN of the default PDP context. Only valid while the link is down. */
+        int setApn(const char *apn);
+        /**< Start network attach and return immediately. Progress is reported through handler. */
+        int connectAsync(EventHandler handler);
+        /**< Detach and power the radio down. */
+        int offline();
+        /**< Read the time last received from the network in ms since the Unix epoch, UTC. Returns
+         * -EAGAIN until the network has sent one.
+         */
+        int networkTime(int64_t *utcMs);
+        /**< Report signal changes to handler from the modem's own notifications, no polling. Only valid
+         * once the modem is initialized.
+         */
+        int subscribeQuality(QualityHandler handler);
+#ifdef CONFIG_APP_CONNECTIVITY_LINK_STUB
+        /**< APN last given to setApn(), empty before the first call. Stub only, read by the tests. */
+        const char *stubApn();
+#endif
+    } // namespace LinkControl
+} // namespace Services
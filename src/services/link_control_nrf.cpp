@@ -0,0 +1,116 @@
+// NCS modules
+#include <modem/at_monitor.h>
+#include <modem/lte_lc.h>
+#include <modem/nrf_modem_lib.h>
+#include <nrf_modem_at.h>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/timeutil.h>
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+// App modules
+#include "link_control.h"
+
+namespace LinkControl = Services::LinkControl;
+
+LOG_MODULE_REGISTER(link_control, LOG_LEVEL_INF);
+
+static LinkControl::EventHandler eventHandler;
+static LinkControl::QualityHandler qualityHandler;
+
+static void lteHandler(const struct lte_lc_evt *const evt) {
+    if (eventHandler == nullptr || evt->type != LTE_LC_EVT_NW_REG_STATUS) {
+        return;
+    }
+
+    switch (evt->nw_reg_status) {
+    case LTE_LC_NW_REG_SEARCHING:
+        eventHandler(LinkControl::Event::Searching);
+        break;
+    case LTE_LC_NW_REG_REGISTERED_HOME:
+        eventHandler(LinkControl::Event::RegisteredHome);
+        break;
+    case LTE_LC_NW_REG_REGISTERED_ROAMING:
+        eventHandler(LinkControl::Event::RegisteredRoaming);
+        break;
+    case LTE_LC_NW_REG_REGISTRATION_DENIED:
+    case LTE_LC_NW_REG_UICC_FAIL:
+        eventHandler(LinkControl::Event::Failed);
+        break;
+    default:
+        eventHandler(LinkControl::Event::NotRegistered);
+        break;
+    }
+}
+
+/* "%CESQ: <rsrp>,<rsrp_threshold_index>,<rsrq>,<rsrq_threshold_index>", sent by the modem only
+ * when a value crosses one of its threshold steps, 255 for no measurement.
+ */
+static void cesqHandler(const char *notification) {
+    int rsrp, rsrpIndex, rsrq, rsrqIndex;
+    if (qualityHandler == nullptr ||
+        sscanf(notification, "%%CESQ: %d,%d,%d,%d", &rsrp, &rsrpIndex, &rsrq, &rsrqIndex) != 4) {
+        return;
+    }
+
+    LinkControl::Quality quality = {
+        .rsrp = static_cast<int16_t>(rsrp == 255 ? LinkControl::QUALITY_UNKNOWN : rsrp - 140),
+        .rsrq = static_cast<int16_t>(rsrq == 255 ? LinkControl::QUALITY_UNKNOWN : (rsrq - 40) / 2),
+    };
+    qualityHandler(quality);
+}
+
+AT_MONITOR(cesqMonitor, "%CESQ", cesqHandler);
+
+int LinkControl::modemInit() { return nrf_modem_lib_init(); }
+
+int LinkControl::setApn(const char *apn) {
+    /* CID 0 is the default bearer, it can only be changed while the radio is off. */
+    int error = nrf_modem_at_printf("AT+CGDCONT=0,\"IPV4V6\",\"%s\"", apn);
+    if (error) {
+        LOG_ERR("Failed to set APN: %d", error);
+    }
+    return error;
+}
+
+int LinkControl::connectAsync(EventHandler handler) {
+    eventHandler = handler;
+    return lte_lc_connect_async(lteHandler);
+}
+
+int LinkControl::offline() { return lte_lc_offline(); }
+
+int LinkControl::networkTime(int64_t *utcMs) {
+    /* Local time in quarter hours from UTC, "yy/MM/dd,hh:mm:ss+zz", only valid once the network has
+     * sent NITZ. Before that the modem answers with an error or its own clock from 1980.
+     */
+    int year, month, day, hour, minute, second, quarters;
+    int matched = nrf_modem_at_scanf("AT+CCLK?", "+CCLK: \"%d/%d/%d,%d:%d:%d%d\"", &year, &month, &day, &hour,
+                                     &minute, &second, &quarters);
+    if (matched != 7 || year >= 80) {
+        return -EAGAIN;
+    }
+
+    struct tm local = {
+        .tm_sec  = second,
+        .tm_min  = minute,
+        .tm_hour = hour,
+        .tm_mday = day,
+        .tm_mon  = month - 1,
+        .tm_year = year + 100,
+    };
+    int64_t seconds = timeutil_timegm64(&local) - int64_t{quarters} * 15 * 60;
+    *utcMs          = seconds * MSEC_PER_SEC;
+    return 0;
+}
+
+int LinkControl::subscribeQuality(QualityHandler handler) {
+    qualityHandler = handler;
+    int error      = nrf_modem_at_printf("AT%%CESQ=1");
+    if (error) {
+        LOG_ERR("Failed to subscribe to signal notifications: %d", error);
+    }
+    return error;
+}
@@ -0,0 +1,95 @@
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#ifdef CONFIG_SHELL
+#include <zephyr/shell/shell.h>
+#include <stdlib.h>
+#endif
+#include <errno.h>
+#include <string.h>
+// App modules
+#include "link_control.h"
+
+namespace LinkControl = Services::LinkControl;
+
+LOG_MODULE_REGISTER(link_control, LOG_LEVEL_INF);
+
+/* Stand-in for lte_lc on boards without a modem. The attach completes
+ * CONFIG_APP_CONNECTIVITY_STUB_ATTACH_MS after connectAsync(), and the network time is
+ * CONFIG_APP_CONNECTIVITY_STUB_EPOCH plus the uptime from then on. The signal is unknown until
+ * "link_stub signal <rsrp_dbm> <rsrq_db>" sets it, scripts/replay_signal.py plays recorded traces
+ * through that command.
+ */
+static LinkControl::EventHandler eventHandler;
+static LinkControl::QualityHandler qualityHandler;
+
+static bool attached;
+static char apnSet[32];
+
+static void attachWorkHandler(struct k_work *work) {
+    attached = true;
+    if (eventHandler) {
+        eventHandler(LinkControl::Event::RegisteredHome);
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(attachWork, attachWorkHandler);
+
+int LinkControl::modemInit() { return 0; }
+
+int LinkControl::setApn(const char *apn) {
+    LOG_INF("Stub APN set to %s", apn);
+    strncpy(apnSet, apn, sizeof(apnSet) - 1);
+    return 0;
+}
+
+const char *LinkControl::stubApn() { return apnSet; }
+
+int LinkControl::connectAsync(EventHandler handler) {
+    eventHandler = handler;
+    eventHandler(Event::Searching);
+    k_work_schedule(&attachWork, K_MSEC(CONFIG_APP_CONNECTIVITY_STUB_ATTACH_MS));
+    return 0;
+}
+
+int LinkControl::offline() {
+    k_work_cancel_delayable(&attachWork);
+    attached = false;
+    if (eventHandler) {
+        eventHandler(Event::NotRegistered);
+    }
+    return 0;
+}
+
+int LinkControl::networkTime(int64_t *utcMs) {
+    if (!attached) {
+        return -EAGAIN;
+    }
+    *utcMs = int64_t{CONFIG_APP_CONNECTIVITY_STUB_EPOCH} * MSEC_PER_SEC + k_uptime_get();
+    return 0;
+}
+
+int LinkControl::subscribeQuality(QualityHandler handler) {
+    qualityHandler = handler;
+    return 0;
+}
+
+#ifdef CONFIG_SHELL
+static int signalCommand(const struct shell *sh, size_t argc, char **argv) {
+    LinkControl::Quality quality = {
+        .rsrp = static_cast<int16_t>(strtol(argv[1], nullptr, 10)),
+        .rsrq = static_cast<int16_t>(strtol(argv[2], nullptr, 10)),
+    };
+    if (qualityHandler) {
+        qualityHandler(quality);
+    }
+    shell_print(sh, "RSRP %d dBm, RSRQ %d dB", quality.rsrp, quality.rsrq);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(linkStubCommands,
+                               SHELL_CMD_ARG(signal, NULL, "Set the signal: signal <rsrp_dbm> <rsrq_db>",
+                                             signalCommand, 3, 0),
+                               SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(link_stub, &linkStubCommands, "Stub link control", NULL);
+#endif
@@ -0,0 +1,126 @@
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <errno.h>
+// App modules
+#include "motion.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+using Services::Motion;
+
+LOG_MODULE_REGISTER(motion, LOG_LEVEL_INF);
+
+constinit Motion Motion::instance;
+K_WORK_DELAYABLE_DEFINE(Motion::stillWork, Motion::stillHandler);
+static K_SEM_DEFINE(wake, 0, 1);
+
+const char *Motion::stateName(State state) {
+    switch (state) {
+    case State::Moving:
+        return "moving";
+    case State::Still:
+        return "still";
+    }
+    return "unknown";
+}
+
+int Motion::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    accelerometer = DEVICE_DT_GET_ONE(adi_adxl362);
+    if (!device_is_ready(accelerometer)) {
+        LOG_ERR("ADXL362 not ready");
+        return -ENODEV;
+    }
+
+    /* Thresholds are in LSB, 1 mg at the default 2 g range, and apply to all axes although the
+     * driver takes a single axis channel.
+     */
+    struct sensor_value threshold = {.val1 = CONFIG_APP_MOTION_ACTIVITY_THRESHOLD_MG, .val2 = 0};
+    int error = sensor_attr_set(accelerometer, SENSOR_CHAN_ACCEL_X, SENSOR_ATTR_UPPER_THRESH, &threshold);
+    if (error == 0) {
+        threshold.val1 = CONFIG_APP_MOTION_INACTIVITY_THRESHOLD_MG;
+        error = sensor_attr_set(accelerometer, SENSOR_CHAN_ACCEL_X, SENSOR_ATTR_LOWER_THRESH, &threshold);
+    }
+    if (error) {
+        LOG_ERR("Failed to set motion thresholds: %d", error);
+        return error;
+    }
+
+    error = sensor_trigger_set(accelerometer, &activityTrigger, triggerHandler);
+    if (error == 0) {
+        error = sensor_trigger_set(accelerometer, &inactivityTrigger, triggerHandler);
+    }
+    if (error) {
+        LOG_ERR("Failed to set motion triggers: %d", error);
+        return error;
+    }
+
+    initialized = true;
+    LOG_INF("Initialized Motion: activity %d mg, inactivity %d mg, still after %d s",
+            CONFIG_APP_MOTION_ACTIVITY_THRESHOLD_MG, CONFIG_APP_MOTION_INACTIVITY_THRESHOLD_MG,
+            CONFIG_APP_MOTION_STILL_SECONDS);
+    return 0;
+}
+
+int Motion::addListener(Listener listener) {
+    if (listenerCount == ARRAY_SIZE(listeners)) {
+        return -ENOMEM;
+    }
+    listeners[listenerCount++] = listener;
+    return 0;
+}
+
+k_timeout_t Motion::samplePeriod() const {
+    int32_t seconds = isMoving() ? CONFIG_APP_MOTION_MOVING_SAMPLE_SECONDS : CONFIG_APP_MOTION_STILL_SAMPLE_SECONDS;
+
+    /* The scale is in percent. */
+    return K_MSEC(seconds * 10 * atomic_get(&periodScale));
+}
+
+void Motion::waitNextSample() { (void)k_sem_take(&wake, samplePeriod()); }
+
+void Motion::setState(State state) {
+    if (static_cast<State>(atomic_set(&motionState, static_cast<atomic_val_t>(state))) == state) {
+        return;
+    }
+
+    LOG_INF("Motion state %s", stateName(state));
+    if (state == State::Moving) {
+        /* Cut the slow sampling sleep short. */
+        k_sem_give(&wake);
+    }
+    for (size_t i = 0; i < listenerCount; i++) {
+        listeners[i](state);
+    }
+}
+
+/**< Called by the ADXL362 driver from the system work queue. */
+void Motion::triggerHandler(const struct device *dev, const struct sensor_trigger *trigger) {
+    Motion &self = getInstance();
+
+#ifdef CONFIG_APP_ENERGY
+    /* The driver read the status register to dispatch the interrupt. */
+    EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::Spi);
+#endif
+    if (trigger->type == SENSOR_TRIG_MOTION) {
+        (void)k_work_cancel_delayable(&self.stillWork);
+        self.setState(State::Moving);
+    } else if (trigger->type == SENSOR_TRIG_STATIONARY) {
+        /* The accelerometer only waits CONFIG_ADXL362_INACTIVITY_TIME samples, the rest of the
+         * still time is counted here.
+         */
+        k_work_schedule(&self.stillWork, K_SECONDS(CONFIG_APP_MOTION_STILL_SECONDS));
+    }
+}
+
+void Motion::stillHandler(struct k_work *work) { getInstance().setState(State::Still); }
@@ -0,0 +1,65 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+namespace Services {
+    /**< Motion state from the ADXL362 activity and inactivity interrupts.
+     *
+     * Motion detection runs in the accelerometer: it interrupts once a sample deviates from the
+     * reference by more than CONFIG_APP_MOTION_ACTIVITY_THRESHOLD_MG, and once the deviation stayed
+     * below CONFIG_APP_MOTION_INACTIVITY_THRESHOLD_MG for CONFIG_ADXL362_INACTIVITY_TIME samples.
+     * The device is reported Still when no activity followed an inactivity interrupt for
+     * CONFIG_APP_MOTION_STILL_SECONDS, and Moving again on the first activity interrupt. The CPU is
+     * not woken in between.
+     */
+    class Motion {
+      public:
+        enum class State : uint8_t {
+            Moving,
+            Still,
+        };
+        using Listener = void (*)(State state);
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Motion(const Motion &)            = delete;
+        Motion &operator=(const Motion &) = delete;
+        static Motion &getInstance() { return instance; }
+        int init();
+        /**< Listeners are called from the system work queue on every state change. */
+        int addListener(Listener listener);
+
+        State state() const { return static_cast<State>(atomic_get(&motionState)); }
+        bool isMoving() const { return state() == State::Moving; }
+        /**< Environmental sampling period of the current state. */
+        k_timeout_t samplePeriod() const;
+        /**< Stretch the sampling periods to percent of their configured value. */
+        void setPeriodScale(uint16_t percent) { atomic_set(&periodScale, percent); }
+        /**< Sleep for the sampling period of the current state, returning early when motion starts. */
+        void waitNextSample();
+        static const char *stateName(State state);
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr Motion() = default;
+        static Motion instance;
+        static void triggerHandler(const struct device *dev, const struct sensor_trigger *trigger);
+        static void stillHandler(struct k_work *work);
+        void setState(State state);
+
+        const struct device *accelerometer = nullptr;
+        struct sensor_trigger activityTrigger   = {.type = SENSOR_TRIG_MOTION, .chan = SENSOR_CHAN_ACCEL_XYZ};
+        struct sensor_trigger inactivityTrigger = {.type = SENSOR_TRIG_STATIONARY, .chan = SENSOR_CHAN_ACCEL_XYZ};
+        static struct k_work_delayable stillWork;
+        Listener listeners[CONFIG_APP_MOTION_MAX_LISTENERS] = {};
+        size_t listenerCount = 0;
+        atomic_t motionState = ATOMIC_INIT(static_cast<atomic_val_t>(State::Moving));
+        atomic_t periodScale = ATOMIC_INIT(100);
+        bool initialized     = false;
+    };
+} // namespace Services
@@ -0,0 +1,84 @@
+// Zephyr modules
+#include <zephyr/drivers/emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/timing/timing.h>
+#include <errno.h>
+// App modules
+#include "our_drivers/emul_bme680.h"
+#include "replay_benchmark.h"
+#include "sensor.h"
+#ifdef CONFIG_APP_SAMPLE_CODEC
+#include "sample_codec.h"
+#endif
+
+using Services::Bme680;
+using Services::ReplayBenchmark;
+using Services::Sample;
+#ifdef CONFIG_APP_SAMPLE_CODEC
+using Services::SampleCodec;
+#endif
+
+LOG_MODULE_REGISTER(replay_benchmark, LOG_LEVEL_INF);
+
+int ReplayBenchmark::run(const struct device *sensor) {
+    const struct emul *target = EMUL_DT_GET(DT_INST(0, our_bme680));
+    if (emul_bme680_replay_remaining(target) < 0 || emul_bme680_replay_paced()) {
+        LOG_INF("No capture to replay at full speed");
+        return -ENODATA;
+    }
+    if (!device_is_ready(sensor)) {
+        LOG_ERR("Sensor not ready, capture not replayed");
+        return -ENODEV;
+    }
+
+    const Bme680 bme680(sensor);
+    Result result = {};
+#ifdef CONFIG_APP_SAMPLE_CODEC
+    // The default sample log staging batch
+    static uint8_t batch[1024];
+    SampleCodec::Encoder encoder;
+    encoder.begin(batch, sizeof(batch));
+#endif
+
+    timing_init();
+    timing_start();
+    timing_t start = timing_counter_get();
+    while (emul_bme680_replay_remaining(target) > 0) {
+        Sample sample = {};
+        int error     = bme680.fetch();
+        if (error == 0) {
+            error = bme680.read(sample);
+        }
+        if (error == 0) {
+            error = emul_bme680_replay_timestamp(target, &sample.timestamp);
+        }
+        if (error) {
+            result.errors++;
+            continue;
+        }
+        result.crc = crc32_ieee_update(result.crc, reinterpret_cast<const uint8_t *>(&sample), sizeof(sample));
+#ifdef CONFIG_APP_SAMPLE_CODEC
+        if (!encoder.append(sample)) {
+            result.encodedBytes += encoder.size();
+            encoder.begin(batch, sizeof(batch));
+            (void)encoder.append(sample);
+        }
+#endif
+        result.frames++;
+    }
+#ifdef CONFIG_APP_SAMPLE_CODEC
+    result.encodedBytes += encoder.size();
+#endif
+    timing_t end   = timing_counter_get();
+    result.totalUs = static_cast<uint32_t>(timing_cycles_to_ns(timing_cycles_get(&start, &end)) / 1000U);
+    timing_stop();
+
+    uint32_t framesPerSecond =
+        result.totalUs ? static_cast<uint32_t>(uint64_t{result.frames} * 1000000U / result.totalUs) : 0;
+    LOG_INF("frames,errors,total_us,frames_per_s,encoded_bytes,output_crc32");
+    LOG_INF("%u,%u,%u,%u,%u,%08x", result.frames, result.errors, result.totalUs, framesPerSecond,
+            result.encodedBytes, result.crc);
+    return 0;
+}
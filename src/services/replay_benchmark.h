@@ -0,0 +1,28 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+
+namespace Services {
+    /**< Full speed replay of a BME680 capture on native_sim (CONFIG_APP_REPLAY_BENCHMARK).
+     *
+     * run() fetches until the emulated sensor has replayed every frame of the -bme680_replay file,
+     * each one read through Bme680::read() and, with CONFIG_APP_SAMPLE_CODEC, encoded into batches,
+     * as the main loop does. The samples carry their recorded stamps, so the CRC32 over them only
+     * changes when the compensation or the readout does. One CSV line for
+     * scripts/collect_benchmarks.py, paced replays (-bme680_replay_paced) are left to the main loop.
+     */
+    class ReplayBenchmark {
+      public:
+        struct Result {
+            uint32_t frames;
+            uint32_t errors;
+            uint32_t totalUs;
+            uint32_t encodedBytes; // 0 without CONFIG_APP_SAMPLE_CODEC
+            uint32_t crc;
+        };
+
+        static int run(const struct device *sensor);
+    };
+} // namespace Services
@@ -0,0 +1,79 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/sys/math_extras.h>
+
+namespace Services {
+    /**< Streaming min, max, mean and variance of one channel, Welford's algorithm in integers.
+     *
+     * The mean is kept with FRACTION_BITS fractional bits, so a reading that flips by one unit still
+     * has a variance. The squared distances are summed as uint64_t: Welford's two distances always
+     * have the same sign, their product is never negative, and a sum that would overflow saturates
+     * instead of wrapping. That takes a spread of around 2^27 units within one window, which only the
+     * gas resistance can reach. O(1) per value, no allocation.
+     */
+    class RunningStats {
+      public:
+        static constexpr unsigned FRACTION_BITS = 8;
+
+        void reset() { *this = RunningStats(); }
+
+        void add(int64_t value) {
+            if (samples == 0) {
+                low  = value;
+                high = value;
+            } else {
+                low  = value < low ? value : low;
+                high = value > high ? value : high;
+            }
+            latest = value;
+            samples++;
+
+            int64_t scaled = value * (int64_t{1} << FRACTION_BITS);
+            int64_t delta  = scaled - meanScaled;
+            meanScaled += delta / static_cast<int64_t>(samples);
+            int64_t delta2 = scaled - meanScaled;
+
+            // Both distances carry FRACTION_BITS, half of the scale comes off each before the product
+            uint64_t product;
+            if (u64_mul_overflow(magnitude(delta) >> (FRACTION_BITS / 2), magnitude(delta2) >> (FRACTION_BITS / 2),
+                                 &product) ||
+                u64_add_overflow(m2Scaled, product, &m2Scaled)) {
+                m2Scaled = UINT64_MAX;
+            }
+        }
+
+        uint32_t count() const { return samples; }
+        int64_t min() const { return low; }
+        int64_t max() const { return high; }
+        int64_t last() const { return latest; }
+        /**< Rounded to the nearest unit. */
+        int64_t mean() const {
+            int64_t half = int64_t{1} << (FRACTION_BITS - 1);
+            return (meanScaled >= 0 ? meanScaled + half : meanScaled - half) / (int64_t{1} << FRACTION_BITS);
+        }
+        /**< Population variance in units squared, UINT64_MAX once saturated. */
+        uint64_t variance() const {
+            if (samples == 0) {
+                return 0;
+            }
+            if (m2Scaled == UINT64_MAX) {
+                return UINT64_MAX;
+            }
+            return (m2Scaled / samples) >> FRACTION_BITS;
+        }
+
+      private:
+        static uint64_t magnitude(int64_t value) {
+            return value < 0 ? static_cast<uint64_t>(-value) : static_cast<uint64_t>(value);
+        }
+
+        int64_t meanScaled = 0; // mean << FRACTION_BITS
+        uint64_t m2Scaled  = 0; // sum of squared distances << FRACTION_BITS
+        int64_t low        = 0;
+        int64_t high       = 0;
+        int64_t latest     = 0;
+        uint32_t samples   = 0;
+    };
+} // namespace Services
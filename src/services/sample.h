@@ -0,0 +1,14 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+
+namespace Services {
+    /**< One environmental sample in the native fixed-point resolution of the BME680 driver. */
+    struct Sample {
+        uint32_t timestamp;     // TimeService::stamp(), ms since boot
+        int32_t temperature;    // 0.01 degC
+        uint32_t pressure;      // Pa
+        uint32_t humidity;      // 0.001 %RH
+        uint32_t gasResistance; // ohm
+    };
+} // namespace Services
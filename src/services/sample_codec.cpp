@@ -0,0 +1,219 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/sys/util.h>
+// App modules
+#include "sample_codec.h"
+
+using Services::Sample;
+using Services::SampleCodec;
+
+/**< Short/medium widths in bits per field, sized for the typical sample-to-sample change at 2 s. */
+#define TIMESTAMP_SHORT_BITS    6  // +-32 ms jitter
+#define TIMESTAMP_MEDIUM_BITS   14 // interval changes up to 8 s
+#define TEMPERATURE_SHORT_BITS  4  // +-0.08 degC
+#define TEMPERATURE_MEDIUM_BITS 10
+#define PRESSURE_SHORT_BITS     5 // +-16 Pa
+#define PRESSURE_MEDIUM_BITS    12
+#define HUMIDITY_SHORT_BITS     7 // +-0.064 %RH
+#define HUMIDITY_MEDIUM_BITS    14
+#define GAS_SHORT_BITS          10 // +-512 ohm
+#define GAS_MEDIUM_BITS         18
+
+static inline uint32_t zigzagEncode(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static inline int32_t zigzagDecode(uint32_t value) {
+    return static_cast<int32_t>((value >> 1) ^ (0U - (value & 1U)));
+}
+
+static inline uint32_t lowMask(uint8_t bits) { return bits >= 32 ? UINT32_MAX : (1U << bits) - 1U; }
+
+/* --- Encoder --- */
+
+void SampleCodec::Encoder::begin(uint8_t *buffer, size_t size) {
+    this->buffer     = buffer;
+    capacityBits     = (size - sizeof(BatchHeader)) * 8;
+    bitPosition      = 0;
+    previousInterval = 0;
+    memset(buffer, 0, sizeof(BatchHeader));
+    header()->version = VERSION;
+}
+
+size_t SampleCodec::Encoder::size() const { return sizeof(BatchHeader) + (bitPosition + 7) / 8; }
+
+bool SampleCodec::Encoder::writeBits(uint32_t value, uint8_t bits) {
+    if (bitPosition + bits > capacityBits) {
+        return false;
+    }
+    uint8_t *payload = buffer + sizeof(BatchHeader);
+    while (bits) {
+        size_t index   = bitPosition / 8;
+        uint8_t offset = bitPosition % 8;
+        uint8_t take   = MIN(static_cast<uint8_t>(8 - offset), bits);
+        uint8_t mask   = static_cast<uint8_t>(lowMask(take) << offset);
+
+        payload[index] = (payload[index] & ~mask) | (static_cast<uint8_t>(value << offset) & mask);
+        value >>= take;
+        bits -= take;
+        bitPosition += take;
+    }
+    return true;
+}
+
+bool SampleCodec::Encoder::writeValue(int32_t delta, uint8_t shortBits, uint8_t mediumBits) {
+    uint32_t zigzag = zigzagEncode(delta);
+
+    if (zigzag == 0) {
+        return writeBits(0b0, 1);
+    }
+    if (zigzag <= lowMask(shortBits)) {
+        return writeBits(0b01, 2) && writeBits(zigzag, shortBits);
+    }
+    if (zigzag <= lowMask(mediumBits)) {
+        return writeBits(0b011, 3) && writeBits(zigzag, mediumBits);
+    }
+    return writeBits(0b111, 3) && writeBits(zigzag, 32);
+}
+
+bool SampleCodec::Encoder::append(const Sample &sample) {
+    BatchHeader *batch = header();
+
+    if (batch->count == 0) {
+        batch->count          = 1;
+        batch->firstTimestamp = sample.timestamp;
+        batch->lastTimestamp  = sample.timestamp;
+        batch->temperature    = sample.temperature;
+        batch->pressure       = sample.pressure;
+        batch->humidity       = sample.humidity;
+        batch->gasResistance  = sample.gasResistance;
+        previous              = sample;
+        return true;
+    }
+    if (batch->count == UINT16_MAX) {
+        return false;
+    }
+
+    size_t rollback  = bitPosition;
+    int32_t interval = static_cast<int32_t>(sample.timestamp - previous.timestamp);
+    bool fits =
+        writeValue(interval - previousInterval, TIMESTAMP_SHORT_BITS, TIMESTAMP_MEDIUM_BITS) &&
+        writeValue(sample.temperature - previous.temperature, TEMPERATURE_SHORT_BITS,
+                   TEMPERATURE_MEDIUM_BITS) &&
+        writeValue(static_cast<int32_t>(sample.pressure - previous.pressure), PRESSURE_SHORT_BITS,
+                   PRESSURE_MEDIUM_BITS) &&
+        writeValue(static_cast<int32_t>(sample.humidity - previous.humidity), HUMIDITY_SHORT_BITS,
+                   HUMIDITY_MEDIUM_BITS) &&
+        writeValue(static_cast<int32_t>(sample.gasResistance - previous.gasResistance), GAS_SHORT_BITS,
+                   GAS_MEDIUM_BITS);
+    if (!fits) {
+        bitPosition = rollback;
+        return false;
+    }
+
+    batch->count++;
+    batch->lastTimestamp = sample.timestamp;
+    previous             = sample;
+    previousInterval     = interval;
+    return true;
+}
+
+/* --- Decoder --- */
+
+bool SampleCodec::Decoder::begin(const uint8_t *buffer, size_t size) {
+    if (size < sizeof(BatchHeader)) {
+        return false;
+    }
+    this->buffer = buffer;
+    if (header().version != VERSION || header().count == 0) {
+        this->buffer = nullptr;
+        return false;
+    }
+    sizeBits         = (size - sizeof(BatchHeader)) * 8;
+    bitPosition      = 0;
+    decoded          = 0;
+    previousInterval = 0;
+    return true;
+}
+
+bool SampleCodec::Decoder::readBits(uint8_t bits, uint32_t &value) {
+    if (bitPosition + bits > sizeBits) {
+        return false;
+    }
+    const uint8_t *payload = buffer + sizeof(BatchHeader);
+    uint8_t shift          = 0;
+    value                  = 0;
+    while (bits) {
+        size_t index   = bitPosition / 8;
+        uint8_t offset = bitPosition % 8;
+        uint8_t take   = MIN(static_cast<uint8_t>(8 - offset), bits);
+
+        value |= ((static_cast<uint32_t>(payload[index]) >> offset) & lowMask(take)) << shift;
+        shift += take;
+        bits -= take;
+        bitPosition += take;
+    }
+    return true;
+}
+
+bool SampleCodec::Decoder::readValue(uint8_t shortBits, uint8_t mediumBits, int32_t &delta) {
+    uint32_t prefix;
+    uint32_t zigzag;
+    uint8_t width;
+
+    if (!readBits(1, prefix)) {
+        return false;
+    }
+    if (prefix == 0) {
+        delta = 0;
+        return true;
+    }
+    if (!readBits(1, prefix)) {
+        return false;
+    }
+    if (prefix == 0) {
+        width = shortBits;
+    } else {
+        if (!readBits(1, prefix)) {
+            return false;
+        }
+        width = prefix ? 32 : mediumBits;
+    }
+    if (!readBits(width, zigzag)) {
+        return false;
+    }
+    delta = zigzagDecode(zigzag);
+    return true;
+}
+
+bool SampleCodec::Decoder::next(Sample &sample) {
+    if (buffer == nullptr || decoded == header().count) {
+        return false;
+    }
+
+    if (decoded == 0) {
+        previous = {header().firstTimestamp, header().temperature, header().pressure, header().humidity,
+                    header().gasResistance};
+    } else {
+        int32_t dod, temperature, pressure, humidity, gas;
+        if (!readValue(TIMESTAMP_SHORT_BITS, TIMESTAMP_MEDIUM_BITS, dod) ||
+            !readValue(TEMPERATURE_SHORT_BITS, TEMPERATURE_MEDIUM_BITS, temperature) ||
+            !readValue(PRESSURE_SHORT_BITS, PRESSURE_MEDIUM_BITS, pressure) ||
+            !readValue(HUMIDITY_SHORT_BITS, HUMIDITY_MEDIUM_BITS, humidity) ||
+            !readValue(GAS_SHORT_BITS, GAS_MEDIUM_BITS, gas)) {
+            buffer = nullptr;
+            return false;
+        }
+        previousInterval += dod;
+        previous.timestamp += static_cast<uint32_t>(previousInterval);
+        previous.temperature += temperature;
+        previous.pressure += static_cast<uint32_t>(pressure);
+        previous.humidity += static_cast<uint32_t>(humidity);
+        previous.gasResistance += static_cast<uint32_t>(gas);
+    }
+
+    decoded++;
+    sample = previous;
+    return true;
+}
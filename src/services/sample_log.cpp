@@ -0,0 +1,226 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#if defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#include <pm_config.h>
+#endif
+#include <errno.h>
+// App modules
+#include "sample_log.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+using Services::Sample;
+using Services::SampleCodec;
+using Services::SampleLog;
+using Services::TimeService;
+
+LOG_MODULE_REGISTER(sample_log, LOG_LEVEL_INF);
+
+/* The partition is named sample_log in the babbies_tracker_pm_static*.yml layouts and
+ * sample_log_partition in the DTS for builds without the partition manager. The factory and LwM2M
+ * carrier layouts have no room for it.
+ */
+#if defined(PM_SAMPLE_LOG_ID)
+#define SAMPLE_LOG_PARTITION_ID PM_SAMPLE_LOG_ID
+#elif !defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#define SAMPLE_LOG_PARTITION_ID FIXED_PARTITION_ID(sample_log_partition)
+#endif
+
+#define SAMPLE_LOG_MAGIC 0x534c4f47 /* "SLOG" */
+
+constinit SampleLog SampleLog::instance;
+static K_MUTEX_DEFINE(lock);
+
+int SampleLog::init() {
+#ifndef SAMPLE_LOG_PARTITION_ID
+    LOG_ERR("No sample_log partition in this flash layout");
+    return -ENODEV;
+#else
+    uint32_t sectorCount = ARRAY_SIZE(sectors);
+    int error = flash_area_get_sectors(SAMPLE_LOG_PARTITION_ID, &sectorCount, sectors);
+    if (error) {
+        LOG_ERR("Failed to get sample log sectors: %d", error);
+        return error;
+    }
+
+    fcb.f_magic       = SAMPLE_LOG_MAGIC;
+    fcb.f_version     = ENTRY_VERSION;
+    fcb.f_sector_cnt  = static_cast<uint8_t>(sectorCount);
+    fcb.f_scratch_cnt = 0;
+    fcb.f_sectors     = sectors;
+
+    error = fcb_init(SAMPLE_LOG_PARTITION_ID, &fcb);
+    if (error == -ENOMSG) {
+        /* Written by an older image in another entry format, which this one cannot read. */
+        LOG_WRN("Sample log has an older entry format, erasing it");
+        const struct flash_area *area;
+        error = flash_area_open(SAMPLE_LOG_PARTITION_ID, &area);
+        if (error == 0) {
+            error = flash_area_erase(area, 0, area->fa_size);
+            flash_area_close(area);
+        }
+        if (error == 0) {
+            error = fcb_init(SAMPLE_LOG_PARTITION_ID, &fcb);
+        }
+    }
+    if (error) {
+        LOG_ERR("Failed to initialize sample log FCB: %d", error);
+        return error;
+    }
+
+    encoder.begin(staging + TIME_BASE_SIZE, BATCH_SIZE - TIME_BASE_SIZE);
+    initialized = true;
+    LOG_INF("Initialized SampleLog: %u sectors of %u bytes, %u byte batches", sectorCount,
+            static_cast<unsigned int>(sectors[0].fs_size), static_cast<unsigned int>(BATCH_SIZE));
+    return 0;
+#endif
+}
+
+/**< Append the staging batch as one FCB entry, erasing the oldest sector if the log is full.
+ * Called with the lock held.
+ */
+int SampleLog::writeBatch() {
+    struct fcb_entry location;
+    /* Every sample of the staging batch is from this boot, the correction is the latest one. */
+    TimeService::TimeBase base = TimeService::getInstance().timeBase();
+    memcpy(staging, &base, sizeof(base));
+
+    /* Flash writes must cover whole write blocks, the decoder ignores the padding. */
+    size_t encoded  = TIME_BASE_SIZE + encoder.size();
+    uint16_t length = static_cast<uint16_t>(ROUND_UP(encoded, fcb.f_align));
+    memset(&staging[encoded], 0, length - encoded);
+
+    int error = fcb_append(&fcb, length, &location);
+    if (error == -ENOSPC) {
+        error = fcb_rotate(&fcb);
+        if (error) {
+            LOG_ERR("Failed to rotate sample log: %d", error);
+            return error;
+        }
+        erases++;
+#ifdef CONFIG_APP_ENERGY
+        EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::Flash);
+#endif
+        error = fcb_append(&fcb, length, &location);
+    }
+    if (error) {
+        LOG_ERR("Failed to reserve %u bytes in sample log: %d", length, error);
+        return error;
+    }
+
+    error = flash_area_write(fcb.fap, FCB_ENTRY_FA_DATA_OFF(location), staging, length);
+    if (error) {
+        LOG_ERR("Failed to write sample log batch: %d", error);
+        return error;
+    }
+
+    error = fcb_append_finish(&fcb, &location);
+    if (error) {
+        LOG_ERR("Failed to finish sample log batch: %d", error);
+        return error;
+    }
+
+    writes++;
+    LOG_DBG("Wrote batch of %u samples in %u bytes", encoder.count(), length);
+    encoder.begin(staging + TIME_BASE_SIZE, BATCH_SIZE - TIME_BASE_SIZE);
+    return 0;
+}
+
+int SampleLog::append(const Sample &sample) {
+    if (!initialized) {
+        return -EACCES;
+    }
+
+    k_mutex_lock(&lock, K_FOREVER);
+    int error = 0;
+    if (!encoder.append(sample)) {
+        error = writeBatch();
+        if (error == 0) {
+            (void)encoder.append(sample);
+        }
+    }
+    k_mutex_unlock(&lock);
+    return error;
+}
+
+int SampleLog::flush() {
+    if (!initialized) {
+        return -EACCES;
+    }
+
+    k_mutex_lock(&lock, K_FOREVER);
+    int error = encoder.empty() ? 0 : writeBatch();
+    k_mutex_unlock(&lock);
+    return error;
+}
+
+int SampleLog::readEntry(struct fcb_entry &location, uint8_t *buffer, size_t size) {
+    size_t length = MIN(size, static_cast<size_t>(location.fe_data_len));
+    return flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(location), buffer, length);
+}
+
+int SampleLog::Cursor::next(Sample &sample) {
+    SampleLog &log = SampleLog::getInstance();
+
+    if (!log.initialized) {
+        return -EACCES;
+    }
+
+    while (true) {
+        while (decoder.next(sample)) {
+            if (sample.timestamp > to) {
+                break;
+            }
+            if (sample.timestamp >= from) {
+                return 0;
+            }
+        }
+
+        k_mutex_lock(&lock, K_FOREVER);
+        int error = flashDone ? -ENOENT : fcb_getnext(&log.fcb, &location);
+        if (error == 0) {
+            /* Look at the headers first, most batches are of another boot or fall outside the range. */
+            struct __attribute__((packed)) {
+                TimeService::TimeBase time;
+                SampleCodec::BatchHeader batch;
+            } header;
+            error = log.readEntry(location, reinterpret_cast<uint8_t *>(&header), sizeof(header));
+            if (error == 0 && header.time.boot == boot && header.batch.lastTimestamp >= from &&
+                header.batch.firstTimestamp <= to) {
+                error = log.readEntry(location, batch, sizeof(batch));
+                size_t length = MIN(sizeof(batch), location.fe_data_len);
+                if (error == 0 && (length < TIME_BASE_SIZE ||
+                                   !decoder.begin(batch + TIME_BASE_SIZE, length - TIME_BASE_SIZE))) {
+                    LOG_WRN("Skipping corrupt batch at sector offset 0x%x", location.fe_elem_off);
+                }
+            }
+            k_mutex_unlock(&lock);
+            if (error) {
+                return error;
+            }
+            continue;
+        }
+        flashDone = true;
+
+        /* Samples still in the staging batch are newer than anything in flash, and of this boot. */
+        if (!stagingDone && !log.encoder.empty() && boot == TimeService::getInstance().boot()) {
+            size_t length = log.encoder.size();
+            memcpy(batch, log.staging + TIME_BASE_SIZE, length);
+            decoder.begin(batch, length);
+            stagingDone = true;
+            k_mutex_unlock(&lock);
+            continue;
+        }
+        k_mutex_unlock(&lock);
+        return -ENOENT;
+    }
+}
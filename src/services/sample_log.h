@@ -0,0 +1,83 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+// App modules
+#include "sample.h"
+#include "sample_codec.h"
+#include "time_service.h"
+
+namespace Services {
+    /**< Persistent circular log of samples on the sample_log flash partition.
+     *
+     * Samples are delta encoded into a RAM staging batch of CONFIG_APP_SAMPLE_LOG_BATCH_SIZE bytes
+     * and the batch is appended to an FCB as one entry when it is full, so flash is only written
+     * sequentially and in batch-sized chunks. When the FCB is full the oldest sector is erased.
+     *
+     * The log outlives the boot its stamps count from, so every entry starts with the
+     * TimeService::TimeBase of its batch: the boot, which range queries match, and the correction
+     * the host converts the stamps to UTC with.
+     */
+    class SampleLog {
+      public:
+        static constexpr size_t BATCH_SIZE     = CONFIG_APP_SAMPLE_LOG_BATCH_SIZE;
+        static constexpr uint8_t ENTRY_VERSION = 2; // TimeBase and batch, 1 was the batch alone
+        static constexpr size_t TIME_BASE_SIZE = sizeof(TimeService::TimeBase);
+
+        /**< Range query over the log, oldest sample first. Only the batches of one boot are read, and
+         * of those only the ones whose timestamp range overlaps [from, to], after reading only their
+         * headers. Boot 0 takes in every boot the settings could not count.
+         */
+        class Cursor {
+          public:
+            /**< Stamps of the current boot. */
+            Cursor(uint32_t from, uint32_t to) : Cursor(TimeService::getInstance().boot(), from, to) {}
+            Cursor(uint16_t boot, uint32_t from, uint32_t to) : boot(boot), from(from), to(to) {}
+            /**< Returns 0 and fills sample, -ENOENT at the end of the log or a negative errno. */
+            int next(Sample &sample);
+
+          private:
+            friend class SampleLog;
+            uint16_t boot;
+            uint32_t from;
+            uint32_t to;
+            struct fcb_entry location {};
+            bool flashDone = false;
+            bool stagingDone = false;
+            SampleCodec::Decoder decoder;
+            uint8_t batch[BATCH_SIZE];
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        SampleLog(const SampleLog &)            = delete;
+        SampleLog &operator=(const SampleLog &) = delete;
+        static SampleLog &getInstance() { return instance; }
+        int init();
+
+        /**< Add a sample to the staging batch, writing the batch to flash when it is full. */
+        int append(const Sample &sample);
+        /**< Write the staging batch to flash even if it is not full. */
+        int flush();
+        const bool isInitialized() const { return initialized; }
+
+        uint32_t batchesWritten() const { return writes; }
+        uint32_t sectorsErased() const { return erases; }
+
+      private:
+        constexpr SampleLog() = default;
+        static SampleLog instance;
+        int writeBatch();
+        int readEntry(struct fcb_entry &location, uint8_t *buffer, size_t size);
+
+        struct fcb fcb {};
+        struct flash_sector sectors[CONFIG_APP_SAMPLE_LOG_MAX_SECTORS] = {};
+        SampleCodec::Encoder encoder;
+        uint8_t staging[BATCH_SIZE + 8] = {}; // TimeBase and batch, room to pad to the write block size
+        uint32_t writes  = 0;
+        uint32_t erases  = 0;
+        bool initialized = false;
+    };
+} // namespace Services
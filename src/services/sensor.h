@@ -0,0 +1,87 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <errno.h>
+// App modules
+#include "our_drivers/our_bme680.h"
+#include "sample.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+
+namespace Services {
+    /**< BME680 channels, each kept in the driver's native resolution. */
+    enum class Channel : uint8_t {
+        Temperature,   // 0.01 degC
+        Pressure,      // Pa
+        Humidity,      // 0.001 %RH
+        GasResistance, // ohm
+    };
+
+    /**< Trigger a forced BME680 measurement. Every measurement of the app starts here, the blocking
+     * Sensor::fetch() and the BusScheduler window alike, so the heater-on time and the register write
+     * it costs are accounted once per measurement.
+     */
+    inline int startBme680Measurement(const struct device *dev) {
+#ifdef CONFIG_APP_ENERGY
+        EnergyLedger &ledger = EnergyLedger::getInstance();
+        ledger.addOperations(EnergyLedger::Subsystem::I2c);
+        ledger.addActive(EnergyLedger::Subsystem::Bme680Heater, BME680_HEATR_DUR_MS);
+#endif
+        return our_bme680_start_measurement(dev);
+    }
+
+    /**< Typed reads of a compile-time set of BME680 channels.
+     *
+     * read() takes every value of the last fetch with one our_bme680_get_all() call instead of one
+     * sensor_channel_get() per channel, each going through the API dispatch and the split into
+     * val1/val2. Only the selected channels are copied into the Sample, the other fields are left as
+     * they were, and no code is generated for them.
+     */
+    template <Channel... Channels> class Sensor {
+      public:
+        static_assert(sizeof...(Channels) > 0, "Select at least one channel");
+
+        explicit constexpr Sensor(const struct device *dev) : dev(dev) {}
+
+        static constexpr bool has(Channel channel) { return ((channel == Channels) || ...); }
+
+        bool isReady() const { return device_is_ready(dev); }
+        /**< sensor_sample_fetch() split in two, as the driver does it, with the start accounted. */
+        int fetch() const {
+            int error = startBme680Measurement(dev);
+            return error ? error : our_bme680_finish_measurement(dev);
+        }
+
+        /**< Copy the selected channels of the last fetch into sample. */
+        int read(Sample &sample) const {
+            struct our_bme680_readings readings;
+            int error = our_bme680_get_all(dev, &readings);
+            if (error) {
+                return error;
+            }
+            if constexpr (has(Channel::Temperature)) {
+                sample.temperature = readings.calc_temp;
+            }
+            if constexpr (has(Channel::Pressure)) {
+                sample.pressure = readings.calc_press;
+            }
+            if constexpr (has(Channel::Humidity)) {
+                sample.humidity = readings.calc_humidity;
+            }
+            if constexpr (has(Channel::GasResistance)) {
+                sample.gasResistance = readings.calc_gas_resistance;
+            }
+            return 0;
+        }
+
+      private:
+        const struct device *dev;
+    };
+
+    /**< Every channel, as stored by the sample log and sent by the uplink. */
+    using Bme680 = Sensor<Channel::Temperature, Channel::Pressure, Channel::Humidity, Channel::GasResistance>;
+} // namespace Services
@@ -0,0 +1,38 @@
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <errno.h>
+// App modules
+#include "sensor_capture.h"
+#include "time_service.h"
+
+using Services::SensorCapture;
+using Services::TimeService;
+
+LOG_MODULE_REGISTER(sensor_capture, LOG_LEVEL_INF);
+
+int SensorCapture::start(const struct device *sensor) {
+    if (!device_is_ready(sensor)) {
+        return -ENODEV;
+    }
+
+    uint8_t calibration[BME680_LEN_COEFF_ALL];
+    int error = our_bme680_get_calibration(sensor, calibration);
+    if (error) {
+        LOG_ERR("Failed to read calibration: %d", error);
+        return error;
+    }
+    char hex[2 * sizeof(calibration) + 1];
+    bin2hex(calibration, sizeof(calibration), hex, sizeof(hex));
+    LOG_INF("calibration,%s", hex);
+
+    return our_bme680_set_capture(sensor, frameCaptured, nullptr);
+}
+
+void SensorCapture::frameCaptured(const struct device *dev, const struct our_bme680_data_regs *regs,
+                                  void *userData) {
+    char hex[2 * sizeof(*regs) + 1];
+    bin2hex(reinterpret_cast<const uint8_t *>(regs), sizeof(*regs), hex, sizeof(hex));
+    LOG_INF("frame,%u,%s", TimeService::stamp(), hex);
+}
@@ -0,0 +1,26 @@
+#pragma once
+// Zephyr modules
+#include <zephyr/device.h>
+// App modules
+#include "our_drivers/our_bme680.h"
+
+namespace Services {
+    /**< Capture of the raw BME680 frames (CONFIG_APP_SENSOR_CAPTURE).
+     *
+     * start() logs the calibration block of the sensor, then every fetch logs its data registers,
+     * before compensation, with the TimeService stamp of the fetch. Lines are CSV on the console:
+     *   calibration,<84 hex digits>
+     *   frame,<stamp ms>,<26 hex digits>
+     * scripts/sensor_capture.py turns such a log into a capture file, which the emulated BME680
+     * replays through the driver and the application on native_sim (CONFIG_EMUL_BME680_REPLAY).
+     */
+    class SensorCapture {
+      public:
+        /**< Log the calibration and capture every following fetch of sensor. */
+        static int start(const struct device *sensor);
+
+      private:
+        static void frameCaptured(const struct device *dev, const struct our_bme680_data_regs *regs,
+                                  void *userData);
+    };
+} // namespace Services
@@ -0,0 +1,160 @@
+// Standard modules
+#include <cstdio>
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/timing/timing.h>
+#if defined(CONFIG_SETTINGS_NVS)
+#include <zephyr/fs/nvs.h>
+#elif defined(CONFIG_SETTINGS_ZMS)
+#include <zephyr/fs/zms.h>
+#endif
+// App modules
+#include "settings_benchmark.h"
+#include "settings_storage.h"
+
+using Services::SettingsBenchmark;
+using Services::SettingsStorage;
+
+LOG_MODULE_REGISTER(settings_benchmark, LOG_LEVEL_INF);
+
+#define BENCH_ROOT       "bench"
+#define BENCH_NAME_LEN   sizeof(BENCH_ROOT "/0000")
+#define BENCH_VALUE_SIZE CONFIG_APP_SETTINGS_BENCHMARK_VALUE_SIZE
+
+static size_t benchLoadedKeys;
+
+/**< Counts every "bench/<n>" entry replayed by settings_load(). The value is read so the
+ * backend pays the same cost it would for a real handler.
+ */
+static int benchRootHandleSet(const char *name, size_t length, settings_read_cb readCallBack,
+                              void *callBackArguments) {
+    uint8_t value[BENCH_VALUE_SIZE];
+
+    if (length > sizeof(value)) {
+        return -EINVAL;
+    }
+    int rc = readCallBack(callBackArguments, value, length);
+    if (rc < 0) {
+        return rc;
+    }
+    benchLoadedKeys++;
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(benchRootHandle, BENCH_ROOT, nullptr, benchRootHandleSet, nullptr, nullptr);
+
+/**< Free space left in the backend, or a negative errno. */
+static ssize_t backendFreeSpace() {
+    void *storage;
+    int error = settings_storage_get(&storage);
+    if (error) {
+        return error;
+    }
+#if defined(CONFIG_SETTINGS_NVS)
+    return nvs_calc_free_space(static_cast<struct nvs_fs *>(storage));
+#elif defined(CONFIG_SETTINGS_ZMS)
+    return zms_calc_free_space(static_cast<struct zms_fs *>(storage));
+#else
+    return -ENOTSUP;
+#endif
+}
+
+static uint32_t elapsedUs(timing_t start, timing_t end) {
+    return static_cast<uint32_t>(timing_cycles_to_ns(timing_cycles_get(&start, &end)) / 1000U);
+}
+
+static uint32_t timedLoad() {
+    benchLoadedKeys = 0;
+    timing_t start  = timing_counter_get();
+    int error       = settings_load();
+    timing_t end    = timing_counter_get();
+    if (error) {
+        LOG_WRN("settings_load failed: %d", error);
+    }
+    return elapsedUs(start, end);
+}
+
+int SettingsBenchmark::runRound(size_t keyCount, Result &result) {
+    char name[BENCH_NAME_LEN];
+    uint8_t value[BENCH_VALUE_SIZE];
+    uint64_t writeTotalUs = 0;
+    int error             = 0;
+
+    result            = {};
+    result.keyCount   = keyCount;
+    result.writeMinUs = UINT32_MAX;
+
+    ssize_t freeBefore = backendFreeSpace();
+
+    for (size_t i = 0; i < keyCount; i++) {
+        snprintf(name, sizeof(name), BENCH_ROOT "/%u", static_cast<unsigned int>(i));
+        memset(value, static_cast<int>(i), sizeof(value));
+
+        timing_t start = timing_counter_get();
+        error          = settings_save_one(name, value, sizeof(value));
+        timing_t end   = timing_counter_get();
+        if (error) {
+            LOG_ERR("Write of %s failed after %u keys: %d", name, static_cast<unsigned int>(i), error);
+            keyCount = i;
+            break;
+        }
+
+        uint32_t us = elapsedUs(start, end);
+        writeTotalUs += us;
+        result.writeMinUs = MIN(result.writeMinUs, us);
+        result.writeMaxUs = MAX(result.writeMaxUs, us);
+        result.payloadBytes += strlen(name) + sizeof(value);
+    }
+
+    ssize_t freeAfter = backendFreeSpace();
+    if (freeBefore >= 0 && freeAfter >= 0 && freeBefore > freeAfter) {
+        result.flashBytes = static_cast<size_t>(freeBefore - freeAfter);
+    }
+    result.writeAvgUs = keyCount ? static_cast<uint32_t>(writeTotalUs / keyCount) : 0;
+
+    result.loadUs     = timedLoad();
+    result.loadedKeys = benchLoadedKeys;
+
+    for (size_t i = 0; i < keyCount; i++) {
+        snprintf(name, sizeof(name), BENCH_ROOT "/%u", static_cast<unsigned int>(i));
+        (void)settings_delete(name);
+    }
+    result.loadDeletedUs = timedLoad();
+
+    return error;
+}
+
+int SettingsBenchmark::run() {
+    if (!SettingsStorage::getInstance().isInitialized()) {
+        return -EAGAIN;
+    }
+
+    timing_init();
+    timing_start();
+
+    LOG_INF("Settings benchmark, backend %s, value size %d", SettingsStorage::backendName(),
+            BENCH_VALUE_SIZE);
+    LOG_INF("keys,write_min_us,write_avg_us,write_max_us,load_us,load_deleted_us,loaded,"
+            "payload_bytes,flash_bytes,write_amp_x100");
+
+    int error = 0;
+    for (size_t keyCount : ROUNDS) {
+        Result result;
+        error = runRound(keyCount, result);
+        uint32_t amplification =
+            result.payloadBytes ? static_cast<uint32_t>(result.flashBytes * 100U / result.payloadBytes) : 0;
+        LOG_INF("%u,%u,%u,%u,%u,%u,%u,%u,%u,%u", static_cast<unsigned int>(result.keyCount),
+                result.writeMinUs, result.writeAvgUs, result.writeMaxUs, result.loadUs, result.loadDeletedUs,
+                static_cast<unsigned int>(result.loadedKeys), static_cast<unsigned int>(result.payloadBytes),
+                static_cast<unsigned int>(result.flashBytes), amplification);
+        if (error) {
+            break;
+        }
+    }
+
+    timing_stop();
+    return error;
+}
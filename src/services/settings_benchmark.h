@@ -0,0 +1,33 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+
+namespace Services {
+    /**< Boot-time benchmark of the SettingsStorage backend (CONFIG_APP_SETTINGS_BENCHMARK).
+     * Each round writes a number of keys, times settings_load() and deletes the keys again,
+     * so later rounds also see the write history left by the earlier ones.
+     */
+    class SettingsBenchmark {
+      public:
+        struct Result {
+            size_t keyCount;
+            uint32_t writeMinUs;
+            uint32_t writeAvgUs;
+            uint32_t writeMaxUs;
+            uint32_t loadUs;        // settings_load() with all keys present
+            uint32_t loadDeletedUs; // settings_load() after the keys were deleted
+            size_t loadedKeys;      // keys seen by the bench handler during settings_load()
+            size_t payloadBytes;    // name + value bytes handed to the backend
+            size_t flashBytes;      // backend free space consumed by the writes
+        };
+
+        static constexpr size_t ROUNDS[] = {10, 100, 500};
+
+        /**< Run every round in ROUNDS and log one line per round. SettingsStorage must be initialized. */
+        static int run();
+
+      private:
+        static int runRound(size_t keyCount, Result &result);
+    };
+} // namespace Services
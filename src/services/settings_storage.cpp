@@ -9,7 +9,8 @@
 using Services::SettingsStorage;
 
 /* This module will show an example of how to use Zephyr's Settings Subsystem
- * with the NVS (Non-Volatile Storage) backend to store and retrieve
+ * with the NVS (Non-Volatile Storage) or ZMS (Zephyr Memory Storage) backend,
+ * selected with CONFIG_APP_SETTINGS_BACKEND_*, to store and retrieve
  * configuration data such as cellular APN and credentials.
  */
 // Storage partition defined in the DTS
@@ -96,7 +97,11 @@ SETTINGS_STATIC_HANDLER_DEFINE(cellRootHandle, "cell", nullptr,
 			       cellRootHandleExport);
 
 
-SettingsStorage::SettingsStorage() {}
+#define EVENT_INITIALIZED BIT(0)
+
+constinit SettingsStorage SettingsStorage::instance;
+/* Defined statically, Connectivity waits on it before init() may have run. */
+static K_EVENT_DEFINE(events);
 
 /**< Initialize the settings subsystem */
 int SettingsStorage::init() 
@@ -112,13 +117,21 @@ int SettingsStorage::init()
 		LOG_ERR("Failed to load settings: %d", error);
 		return error;
 	}
-	LOG_INF("Initialized SettingsStorage");
+	LOG_INF("Initialized SettingsStorage (%s backend)", backendName());
 	LOG_INF("cell/apn = %s", apn);
 	LOG_INF("cell/pass = %s", pass);
 	initialized = true;
+	k_event_post(&events, EVENT_INITIALIZED);
     return 0;
 }
 
+int SettingsStorage::waitInitialized(k_timeout_t timeout) {
+	if (k_event_wait(&events, EVENT_INITIALIZED, false, timeout) == 0) {
+		return -EAGAIN;
+	}
+	return 0;
+}
+
 int SettingsStorage::SetKey(key_t key, void* data, size_t size) {
 	int error = settings_save_one(key.data(), data, size);
 	if (error) {
@@ -30,18 +30,28 @@ namespace Services {
         // Delete copy constructor and assignment operator to enforce singleton pattern
         SettingsStorage(const SettingsStorage &)            = delete;
         SettingsStorage &operator=(const SettingsStorage &) = delete;
-        static SettingsStorage &getInstance() {
-            static SettingsStorage instance;
-            return instance;
-        };
+        static SettingsStorage &getInstance() { return instance; }
         int init();
 
         int SetKey(key_t key, void *data, size_t size);
         int GetKey(key_t key, void *data, size_t size);
         const bool isInitialized() const { return initialized; }
+        /**< Block until init() has loaded the settings. Returns 0, or -EAGAIN on timeout. */
+        int waitInitialized(k_timeout_t timeout);
+        /**< Name of the flash backend selected with CONFIG_APP_SETTINGS_BACKEND_* */
+        static constexpr const char *backendName() {
+#if defined(CONFIG_SETTINGS_ZMS)
+            return "zms";
+#elif defined(CONFIG_SETTINGS_NVS)
+            return "nvs";
+#else
+            return "none";
+#endif
+        }
 
       private:
-        SettingsStorage();
+        constexpr SettingsStorage() = default;
+        static SettingsStorage instance;
         bool initialized = false;
     };
 } // namespace Services
\ No newline at end of file
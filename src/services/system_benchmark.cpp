@@ -0,0 +1,120 @@
+// Zephyr modules
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/timing/timing.h>
+// App modules
+#include "sensor.h"
+#include "system_benchmark.h"
+#ifdef CONFIG_APP_BUS_SCHEDULER
+#include "bus_scheduler.h"
+#endif
+
+#ifdef CONFIG_APP_BUS_SCHEDULER
+using Services::BusScheduler;
+#endif
+using Services::Bme680;
+using Services::SystemBenchmark;
+
+LOG_MODULE_REGISTER(system_benchmark, LOG_LEVEL_INF);
+
+/**< Running min/avg/max of timed calls. */
+class Samples {
+  public:
+    void add(timing_t start, timing_t end, int error) {
+        uint32_t us = static_cast<uint32_t>(timing_cycles_to_ns(timing_cycles_get(&start, &end)) / 1000U);
+        count++;
+        totalUs += us;
+        minUs = MIN(minUs, us);
+        maxUs = MAX(maxUs, us);
+        if (error) {
+            errors++;
+        }
+    }
+
+    SystemBenchmark::Result result() const {
+        return {
+            .count  = count,
+            .errors = errors,
+            .minUs  = count ? minUs : 0,
+            .avgUs  = count ? static_cast<uint32_t>(totalUs / count) : 0,
+            .maxUs  = maxUs,
+        };
+    }
+
+    void reset() { *this = Samples(); }
+    uint32_t size() const { return count; }
+
+  private:
+    uint64_t totalUs = 0;
+    uint32_t count   = 0;
+    uint32_t errors  = 0;
+    uint32_t minUs   = UINT32_MAX;
+    uint32_t maxUs   = 0;
+};
+
+static Samples loopSamples;
+static timing_t loopStart;
+static bool timingStarted;
+
+void SystemBenchmark::log(const char *name, const Result &result) {
+    LOG_INF("%s,%u,%u,%u,%u,%u", name, result.count, result.errors, result.minUs, result.avgUs, result.maxUs);
+}
+
+int SystemBenchmark::run(const struct device *sensor) {
+    timing_init();
+    timing_start();
+    timingStarted = true;
+
+    LOG_INF("System benchmark, %u fetches, loop reported every %u iterations",
+            static_cast<unsigned int>(FETCHES), static_cast<unsigned int>(LOOP_ITERATIONS));
+    LOG_INF("name,count,errors,min_us,avg_us,max_us");
+
+    if (!device_is_ready(sensor)) {
+        LOG_ERR("Sensor not ready, fetches not timed");
+        return -ENODEV;
+    }
+
+    // The same fetch as the main loop, heater energy included
+    const Bme680 bme680(sensor);
+    Samples fetches;
+    for (size_t i = 0; i < FETCHES; i++) {
+        timing_t start = timing_counter_get();
+        int error      = bme680.fetch();
+        timing_t end   = timing_counter_get();
+        fetches.add(start, end, error);
+    }
+    log("fetch", fetches.result());
+
+#ifdef CONFIG_APP_BUS_SCHEDULER
+    BusScheduler &busScheduler = BusScheduler::getInstance();
+    if (busScheduler.isInitialized()) {
+        Samples windows;
+        for (size_t i = 0; i < FETCHES; i++) {
+            timing_t start = timing_counter_get();
+            int error      = busScheduler.runWindow();
+            timing_t end   = timing_counter_get();
+            windows.add(start, end, error);
+        }
+        log("bus_window", windows.result());
+    }
+#endif
+    return 0;
+}
+
+void SystemBenchmark::loopBegin() {
+    if (timingStarted) {
+        loopStart = timing_counter_get();
+    }
+}
+
+void SystemBenchmark::loopEnd() {
+    if (!timingStarted) {
+        return;
+    }
+    loopSamples.add(loopStart, timing_counter_get(), 0);
+    if (loopSamples.size() == LOOP_ITERATIONS) {
+        log("loop", loopSamples.result());
+        loopSamples.reset();
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/device.h>
+
+namespace Services {
+    /**< Benchmark of the sampling path (CONFIG_APP_SYSTEM_BENCHMARK).
+     * run() times BME680 fetches at boot, straight through the driver and, when it is enabled, as
+     * BusScheduler windows. loopBegin() and loopEnd() bracket the work of every main loop iteration,
+     * without the wait for the next sample, and a line is logged every LOOP_ITERATIONS iterations.
+     * Every line has the same CSV columns so scripts/collect_benchmarks.py can pick them up.
+     */
+    class SystemBenchmark {
+      public:
+        static constexpr size_t FETCHES         = CONFIG_APP_SYSTEM_BENCHMARK_FETCHES;
+        static constexpr size_t LOOP_ITERATIONS = CONFIG_APP_SYSTEM_BENCHMARK_LOOP_ITERATIONS;
+
+        struct Result {
+            uint32_t count;
+            uint32_t errors; // calls that returned an error, still timed
+            uint32_t minUs;
+            uint32_t avgUs;
+            uint32_t maxUs;
+        };
+
+        /**< Time FETCHES fetches of sensor and log one line per path. Starts the timing functions
+         * used by loopBegin() and loopEnd(), so it must run before the main loop.
+         */
+        static int run(const struct device *sensor);
+        static void loopBegin();
+        static void loopEnd();
+
+      private:
+        static void log(const char *name, const Result &result);
+    };
+} // namespace Services
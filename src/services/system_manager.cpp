@@ -3,19 +3,110 @@
 // Zephyr modules
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <errno.h>
 
 LOG_MODULE_REGISTER(system_manager, LOG_LEVEL_INF);
 
 using Services::SystemManager;
 
-SystemManager::SystemManager() {}
+#define INIT_THREADS CONFIG_APP_SYSTEM_INIT_THREADS
 
-SystemManager& SystemManager::getInstance() {
-    static SystemManager instance;
-    return instance;
+#if INIT_THREADS > 0
+K_THREAD_STACK_ARRAY_DEFINE(initStacks, INIT_THREADS, CONFIG_APP_SYSTEM_INIT_STACK_SIZE);
+static struct k_thread initThreads[INIT_THREADS];
+#endif
+static K_MUTEX_DEFINE(lock);
+static K_CONDVAR_DEFINE(progress);
+
+constinit SystemManager SystemManager::instance;
+
+int SystemManager::init(const Service *list, size_t count) {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    services     = list;
+    serviceCount = count;
+    startCycles  = k_cycle_get_32();
+    for (size_t i = 0; i < count; i++) {
+        listed |= after(list[i].id);
+    }
+    for (Record &record : records) {
+        record.result = -EINPROGRESS;
+    }
+
+#if INIT_THREADS > 0
+    int priority = k_thread_priority_get(k_current_get());
+    for (size_t i = 0; i < INIT_THREADS; i++) {
+        k_thread_create(&initThreads[i], initStacks[i], K_THREAD_STACK_SIZEOF(initStacks[i]), workerEntry, this,
+                        nullptr, nullptr, priority, 0, K_NO_WAIT);
+        k_thread_name_set(&initThreads[i], "service_init");
+    }
+#endif
+    work();
+#if INIT_THREADS > 0
+    for (size_t i = 0; i < INIT_THREADS; i++) {
+        k_thread_join(&initThreads[i], K_FOREVER);
+    }
+#endif
+    initialized = true;
+
+    int failures = 0;
+    for (size_t i = 0; i < count; i++) {
+        const Record &entry = record(list[i].id);
+        if (entry.result) {
+            failures++;
+            LOG_WRN("%s failed: %d", list[i].name, entry.result);
+        }
+        LOG_INF("%-14s start %6u us, took %6u us", list[i].name, entry.startUs, entry.durationUs);
+    }
+    LOG_INF("SystemManager initialized %u services in %u ms, %d failed", static_cast<unsigned int>(count),
+            k_cyc_to_ms_floor32(k_cycle_get_32() - startCycles), failures);
+    return failures;
 }
 
-int SystemManager::init() {
-    LOG_INF("SystemManager initialized.");
-    return 0;
-}
\ No newline at end of file
+void SystemManager::workerEntry(void *p1, void *p2, void *p3) { static_cast<SystemManager *>(p1)->work(); }
+
+/**< Run ready inits until all are done. Runs on the main thread and on every helper thread. */
+void SystemManager::work() {
+    k_mutex_lock(&lock, K_FOREVER);
+    while (done != listed) {
+        const Service *next = nullptr;
+        for (size_t i = 0; i < serviceCount && next == nullptr; i++) {
+            uint32_t needed = services[i].dependencies & listed;
+            if (!(started & after(services[i].id)) && (done & needed) == needed) {
+                next = &services[i];
+            }
+        }
+
+        if (next == nullptr) {
+            if (started == done) {
+                // Nothing running that could unblock the rest, they depend on each other
+                LOG_ERR("Dependency cycle between services 0x%08x", listed & ~done);
+                done = listed;
+                k_condvar_broadcast(&progress);
+                break;
+            }
+            k_condvar_wait(&progress, &lock, K_FOREVER);
+            continue;
+        }
+
+        uint32_t bit = after(next->id);
+        started |= bit;
+        k_mutex_unlock(&lock);
+
+        uint32_t begin = k_cycle_get_32();
+        int result     = next->init();
+        uint32_t end   = k_cycle_get_32();
+
+        k_mutex_lock(&lock, K_FOREVER);
+        records[static_cast<size_t>(next->id)] = {
+            .result     = result,
+            .startUs    = k_cyc_to_us_floor32(begin - startCycles),
+            .durationUs = k_cyc_to_us_floor32(end - begin),
+        };
+        done |= bit;
+        k_condvar_broadcast(&progress);
+    }
+    k_mutex_unlock(&lock);
+}
@@ -1,15 +1,86 @@
 #pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/kernel.h>
 
 namespace Services {
+    /**< Dependency-ordered service start-up.
+     *
+     * main() lists the services it builds in, each with its init function and the services to init
+     * before it. init() hands every service whose dependencies are done to the next free thread, the
+     * main thread or one of CONFIG_APP_SYSTEM_INIT_THREADS helpers, so inits that block on hardware
+     * (settings load, modem start, sensor power-up, PMIC readout) overlap instead of adding up. A
+     * dependency only orders the inits: a service still starts when one it depends on failed, as it
+     * did when main() started them one by one. The result and duration of every init are recorded.
+     *
+     * The services are constinit objects with their kernel objects defined statically, so nothing is
+     * constructed at run time and getInstance() has no guard variable to check.
+     */
     class SystemManager {
       public:
+        enum class ServiceId : uint8_t {
+            Energy,
+            Led,
+            Connectivity,
+            Settings,
+            Time,
+            Sensor,
+            BusScheduler,
+            Battery,
+            Motion,
+            Impact,
+            SampleLog,
+            UplinkQueue,
+            Uplink,
+            DeltaDfu,
+            BulkTransfer,
+            Count,
+        };
+        static constexpr size_t SERVICE_COUNT = static_cast<size_t>(ServiceId::Count);
+
+        struct Service {
+            ServiceId id;
+            const char *name;
+            int (*init)();
+            uint32_t dependencies; // after() the services to init first, ignored if not listed
+        };
+
+        struct Record {
+            int result;          // of init(), -EINPROGRESS if it was not run
+            uint32_t startUs;    // since SystemManager::init() was called
+            uint32_t durationUs;
+        };
+
+        template <typename... Ids> static constexpr uint32_t after(Ids... ids) {
+            return (0U | ... | (1U << static_cast<uint8_t>(ids)));
+        }
+
         // Delete copy constructor and assignment operator to enforce singleton pattern
         SystemManager(const SystemManager &)            = delete;
         SystemManager &operator=(const SystemManager &) = delete;
-        static SystemManager &getInstance();
-        int init();
+        static SystemManager &getInstance() { return instance; }
+        /**< Init the services, blocking until every init returned. Returns the number that failed. */
+        int init(const Service *services, size_t count);
+        template <size_t N> int init(const Service (&services)[N]) { return init(services, N); }
+
+        const Record &record(ServiceId id) const { return records[static_cast<size_t>(id)]; }
+        const bool isInitialized() const { return initialized; }
 
       private:
-        SystemManager();
+        constexpr SystemManager() = default;
+        static SystemManager instance;
+        static void workerEntry(void *p1, void *p2, void *p3);
+        void work();
+
+        const Service *services = nullptr;
+        size_t serviceCount     = 0;
+        uint32_t listed         = 0; // bit per ServiceId
+        uint32_t started        = 0;
+        uint32_t done           = 0;
+        uint32_t startCycles    = 0;
+        Record records[SERVICE_COUNT] = {};
+        bool initialized = false;
     };
-} // namespace Services
\ No newline at end of file
+} // namespace Services
@@ -0,0 +1,144 @@
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <errno.h>
+// App modules
+#include "link_control.h"
+#include "settings_storage.h"
+#include "time_service.h"
+
+using Services::SettingsStorage;
+using Services::TimeService;
+#ifdef CONFIG_APP_CONNECTIVITY
+using Services::Connectivity;
+namespace LinkControl = Services::LinkControl;
+#endif
+
+LOG_MODULE_REGISTER(time_service, LOG_LEVEL_INF);
+
+constinit TimeService TimeService::instance;
+K_WORK_DELAYABLE_DEFINE(TimeService::syncWork, TimeService::syncHandler);
+
+/**< Reads the stored boot counter, left as it was if there is none. */
+static int bootLoad(const char *key, size_t length, settings_read_cb readCallBack, void *callBackArguments,
+                    void *param) {
+    if (length != sizeof(uint16_t)) {
+        return -EINVAL;
+    }
+    int rc = readCallBack(callBackArguments, param, sizeof(uint16_t));
+    return rc < 0 ? rc : 0;
+}
+
+int TimeService::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    SettingsStorage &settings = SettingsStorage::getInstance();
+    if (settings.isInitialized()) {
+        uint16_t stored = 0;
+        (void)settings_load_subtree_direct(KEY_BOOT.data(), bootLoad, &stored);
+        // 0 stands for an uncounted boot, the counter skips it when it wraps
+        uint16_t next = stored == UINT16_MAX ? 1 : stored + 1;
+        if (settings.SetKey(KEY_BOOT, &next, sizeof(next)) == 0) {
+            bootCount = next;
+        }
+    }
+
+#ifdef CONFIG_APP_CONNECTIVITY
+    int error = Connectivity::getInstance().addListener(linkStateListener);
+    if (error) {
+        LOG_ERR("Failed to add link listener: %d", error);
+        return error;
+    }
+#endif
+
+    initialized = true;
+    LOG_INF("Initialized TimeService, boot %u", bootCount);
+    return 0;
+}
+
+int TimeService::correction(Correction &result) const {
+    atomic_val_t current = atomic_get(&published);
+    if (current == 0) {
+        return -EAGAIN;
+    }
+    result = corrections[current - 1];
+    return 0;
+}
+
+TimeService::TimeBase TimeService::timeBase() const {
+    TimeBase base = {.boot = bootCount};
+    Correction current;
+    if (correction(current) == 0) {
+        base.syncStamp = current.stamp;
+        base.syncUtcMs = current.utcMs;
+    }
+    return base;
+}
+
+int TimeService::toUtc(uint32_t stamp, int64_t &utcMs) const {
+    Correction current;
+    int error = correction(current);
+    if (error) {
+        return error;
+    }
+    // Signed, so stamps taken before the sync and across the 32-bit wrap convert too
+    utcMs = current.utcMs + static_cast<int32_t>(stamp - current.stamp);
+    return 0;
+}
+
+int TimeService::sync() {
+#ifdef CONFIG_APP_CONNECTIVITY
+    int64_t utcMs;
+    int error = LinkControl::networkTime(&utcMs);
+    if (error) {
+        return error;
+    }
+    uint32_t now = stamp();
+
+    // Only sync() writes, from the system work queue: fill the unused slot, then publish it
+    atomic_val_t current = atomic_get(&published);
+    size_t next          = current == 1 ? 1 : 0;
+    int64_t step         = 0;
+    if (current != 0) {
+        int64_t previous;
+        toUtc(now, previous);
+        step = utcMs - previous;
+    }
+    corrections[next] = {.stamp = now, .utcMs = utcMs};
+    atomic_set(&published, static_cast<atomic_val_t>(next + 1));
+
+    LOG_INF("Synced to network time %lld ms, stepped by %lld ms", utcMs, step);
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+void TimeService::syncHandler(struct k_work *work) {
+    TimeService &self = getInstance();
+
+    int error = self.sync();
+    if (error == -ENOTSUP) {
+        return;
+    }
+#ifdef CONFIG_APP_CONNECTIVITY
+    if (!Connectivity::getInstance().isConnected()) {
+        return;
+    }
+    // The network may send its time a while after the attach, retry sooner until it has
+    k_work_reschedule(&self.syncWork, error ? K_SECONDS(30) : K_MINUTES(CONFIG_APP_TIME_SYNC_MINUTES));
+#endif
+}
+
+#ifdef CONFIG_APP_CONNECTIVITY
+void TimeService::linkStateListener(Connectivity::LinkState state) {
+    TimeService &self = getInstance();
+
+    if (Connectivity::getInstance().isConnected() && self.initialized) {
+        k_work_reschedule(&self.syncWork, K_NO_WAIT);
+    }
+}
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+#include <string_view>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+// App modules
+#ifdef CONFIG_APP_CONNECTIVITY
+#include "connectivity.h"
+#endif
+
+namespace Services {
+    /**< Sample timestamps and their mapping to UTC.
+     *
+     * stamp() is the uptime in ms, truncated to 32 bits, from the kernel cycle counter. On the nRF
+     * RTC it is read without the timeout spinlock k_uptime_get_32() takes, so it is cheap enough for
+     * ISRs and work items. It wraps after 49.7 days and differences stay correct across the wrap.
+     *
+     * The correction to UTC is a pair of a stamp and the network time read at that stamp, refreshed
+     * every CONFIG_APP_TIME_SYNC_MINUTES while the link is up. Its error is the 1 s resolution of the
+     * network time plus the RTC drift since the last refresh. Stamps are only converted with toUtc()
+     * when data is exported. The correction is double-buffered and published with one atomic store,
+     * so readers never take a lock.
+     *
+     * Stamps restart at 0 every boot, so data that outlives the boot carries a TimeBase: the boot
+     * counter, persisted under KEY_BOOT, and the correction of that boot. Exported data is converted
+     * to UTC from it on the host.
+     */
+    class TimeService {
+      public:
+        using key_t                     = std::string_view;
+        constexpr static key_t KEY_BOOT = "time/boot";
+
+        struct Correction {
+            uint32_t stamp; // stamp() when the network time was read
+            int64_t utcMs;  // UTC at stamp, ms since the Unix epoch
+        };
+
+        /**< Boot and correction of the stamps in a stored or sent batch. Little endian. */
+        struct __attribute__((packed)) TimeBase {
+            uint16_t boot;      // 0 when the settings could not count the boot
+            uint32_t syncStamp; // both 0 before the first sync of that boot
+            int64_t syncUtcMs;
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        TimeService(const TimeService &)            = delete;
+        TimeService &operator=(const TimeService &) = delete;
+        static TimeService &getInstance() { return instance; }
+        /**< Count the boot and start syncing to the network time once the link is up. Call after the
+         * settings are loaded.
+         */
+        int init();
+
+        static uint32_t stamp() {
+#ifdef CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER
+            return static_cast<uint32_t>(k_cyc_to_ms_floor64(k_cycle_get_64()));
+#else
+            return k_uptime_get_32();
+#endif
+        }
+
+        /**< Returns -EAGAIN until the first sync. */
+        int correction(Correction &result) const;
+        /**< UTC in ms since the Unix epoch of a stamp from this boot, within 24 days of the last sync. */
+        int toUtc(uint32_t stamp, int64_t &utcMs) const;
+        bool isSynced() const { return atomic_get(&published) != 0; }
+        /**< Boots counted since the settings were erased, from 1. 0 until init() counted this one. */
+        uint16_t boot() const { return bootCount; }
+        /**< The TimeBase of stamps taken now. */
+        TimeBase timeBase() const;
+
+        /**< Read the network time now and publish the new correction. */
+        int sync();
+        const bool isInitialized() const { return initialized; }
+
+      private:
+        constexpr TimeService() = default;
+        static TimeService instance;
+        static void syncHandler(struct k_work *work);
+#ifdef CONFIG_APP_CONNECTIVITY
+        static void linkStateListener(Connectivity::LinkState state);
+#endif
+
+        static struct k_work_delayable syncWork;
+        Correction corrections[2] = {};
+        atomic_t published        = ATOMIC_INIT(0); // 1 + index of the current correction, 0 for none
+        uint16_t bootCount        = 0;
+        bool initialized          = false;
+    };
+} // namespace Services
@@ -0,0 +1,357 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/coap.h>
+#include <zephyr/net/socket.h>
+#include <errno.h>
+// App modules
+#include "uplink.h"
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+#ifdef CONFIG_APP_UPLINK_QUEUE
+#include "uplink_queue.h"
+#endif
+
+using Services::Connectivity;
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+using Services::Sample;
+using Services::SampleCodec;
+using Services::TimeService;
+using Services::Uplink;
+
+LOG_MODULE_REGISTER(uplink, LOG_LEVEL_INF);
+
+#define COAP_HEADER_RESERVE 32
+#define COAP_REPLY_SIZE     64
+
+K_THREAD_STACK_DEFINE(uplinkStack, CONFIG_APP_UPLINK_STACK_SIZE);
+
+constinit Uplink Uplink::instance;
+struct k_work_q Uplink::workQueue;
+K_WORK_DELAYABLE_DEFINE(Uplink::flushWork, Uplink::flushHandler);
+K_WORK_DELAYABLE_DEFINE(Uplink::sendWork, Uplink::sendHandler);
+static K_MUTEX_DEFINE(lock);
+
+int Uplink::init() {
+    if (initialized) {
+        return -EALREADY;
+    }
+
+    k_work_queue_start(&workQueue, uplinkStack, K_THREAD_STACK_SIZEOF(uplinkStack),
+                       CONFIG_APP_UPLINK_THREAD_PRIORITY, nullptr);
+    k_thread_name_set(&workQueue.thread, "uplink");
+
+    encoder.begin(building + sizeof(PayloadHeader), PAYLOAD_SIZE - sizeof(PayloadHeader));
+    int error = Connectivity::getInstance().addListener(linkStateListener);
+    if (error) {
+        return error;
+    }
+#ifdef CONFIG_APP_UPLINK_SIGNAL_AWARE
+    error = Connectivity::getInstance().addQualityListener(qualityListener);
+    if (error) {
+        return error;
+    }
+#endif
+
+    initialized = true;
+    LOG_INF("Initialized Uplink: %d samples or %d s per batch, coap://%s:%d/%s",
+            CONFIG_APP_UPLINK_BATCH_SAMPLES, CONFIG_APP_UPLINK_FLUSH_SECONDS, CONFIG_APP_UPLINK_SERVER_ADDR,
+            CONFIG_APP_UPLINK_SERVER_PORT, CONFIG_APP_UPLINK_RESOURCE);
+    return 0;
+}
+
+/**< Move the current batch to the sending buffer and start a new one. Returns false if the previous
+ * batch is still being sent. Called with the lock held.
+ */
+bool Uplink::seal(bool urgent) {
+    if (encoder.empty()) {
+        return true;
+    }
+    if (sendingLength != 0) {
+        // Sealed by the send work once the sending buffer is free
+        sealDeferred = true;
+#ifdef CONFIG_APP_UPLINK_SIGNAL_AWARE
+        /* Only one batch waits in the sending buffer. Holding it back would keep an urgent batch
+         * behind it and drop the samples that no longer fit, so it is released and this one is
+         * sealed once it went out.
+         */
+        if (policy.isDeferring()) {
+            atomic_set(&urgentQueued, 1);
+            k_work_reschedule_for_queue(&workQueue, &sendWork, K_NO_WAIT);
+        }
+#endif
+        return false;
+    }
+
+    PayloadHeader header = {
+        .version  = PAYLOAD_VERSION,
+        .flags    = static_cast<uint8_t>(urgent ? FLAG_URGENT : 0),
+        .sequence = sequence++,
+        .time     = TimeService::getInstance().timeBase(),
+    };
+    memcpy(building, &header, sizeof(header));
+    sealDeferred = false;
+
+#ifdef CONFIG_APP_UPLINK_QUEUE
+    /* Persist the batch, the send work drains the queue whenever the link is up. */
+    if (UplinkQueue::getInstance().push(building, sizeof(header) + encoder.size()) != 0) {
+        counters.dropped += encoder.count();
+    }
+#else
+    sendingLength = sizeof(header) + encoder.size();
+
+    uint8_t *sealed = building;
+    building        = sending;
+    sending         = sealed;
+#endif
+    encoder.begin(building + sizeof(PayloadHeader), PAYLOAD_SIZE - sizeof(PayloadHeader));
+
+    if (urgent) {
+        atomic_set(&urgentQueued, 1);
+    }
+    (void)k_work_cancel_delayable(&flushWork);
+    k_work_reschedule_for_queue(&workQueue, &sendWork, K_NO_WAIT);
+    return true;
+}
+
+int Uplink::add(const Sample &sample) {
+    if (!initialized) {
+        return -EACCES;
+    }
+
+    int error = 0;
+    k_mutex_lock(&lock, K_FOREVER);
+    if (!encoder.append(sample)) {
+        if (seal(false)) {
+            (void)encoder.append(sample);
+        } else {
+            counters.dropped++;
+            error = -ENOBUFS;
+        }
+    }
+    if (error == 0) {
+        if (encoder.count() == 1) {
+            k_work_schedule_for_queue(&workQueue, &flushWork,
+                                      K_MSEC(CONFIG_APP_UPLINK_FLUSH_SECONDS * 10 * atomic_get(&periodScale)));
+        } else if (encoder.count() >= CONFIG_APP_UPLINK_BATCH_SAMPLES) {
+            (void)seal(false);
+        }
+    }
+    k_mutex_unlock(&lock);
+    return error;
+}
+
+void Uplink::flushNow() {
+    k_mutex_lock(&lock, K_FOREVER);
+    urgentPending = true;
+    k_mutex_unlock(&lock);
+    k_work_reschedule_for_queue(&workQueue, &flushWork, K_NO_WAIT);
+}
+
+void Uplink::flushHandler(struct k_work *work) {
+    Uplink &self = getInstance();
+
+    k_mutex_lock(&lock, K_FOREVER);
+    if (self.seal(self.urgentPending)) {
+        self.urgentPending = false;
+    }
+    k_mutex_unlock(&lock);
+}
+
+void Uplink::linkStateListener(Connectivity::LinkState state) {
+    Uplink &self = getInstance();
+
+    if (Connectivity::getInstance().isConnected() && self.initialized) {
+        k_work_reschedule_for_queue(&self.workQueue, &self.sendWork, K_NO_WAIT);
+    }
+}
+
+void Uplink::qualityListener(const LinkControl::Quality &quality) {
+    Uplink &self = getInstance();
+
+#ifdef CONFIG_APP_UPLINK_SIGNAL_AWARE
+    // Held back batches go as soon as the signal recovered, not at their deadline
+    if (self.initialized && self.policy.isDeferring()) {
+        k_work_reschedule_for_queue(&self.workQueue, &self.sendWork, K_NO_WAIT);
+    }
+#endif
+}
+
+/**< Whether to keep the pending batches for a better signal, in which case the send is rescheduled
+ * for the policy's deadline. Runs on the uplink work queue.
+ */
+bool Uplink::holdBack() {
+#ifdef CONFIG_APP_UPLINK_SIGNAL_AWARE
+    LinkControl::Quality quality = Connectivity::getInstance().quality();
+    bool wasDeferring            = policy.isDeferring();
+    uint32_t remainingMs         = policy.evaluate(k_uptime_get_32(), quality, atomic_clear(&urgentQueued));
+    if (remainingMs == 0) {
+        if (wasDeferring) {
+            LOG_INF("Uplink released: RSRP %d dBm, RSRQ %d dB", quality.rsrp, quality.rsrq);
+        }
+        return false;
+    }
+
+    if (!wasDeferring) {
+        counters.deferred++;
+        LOG_INF("Uplink held back: RSRP %d dBm, RSRQ %d dB, sent within %u s", quality.rsrp, quality.rsrq,
+                remainingMs / MSEC_PER_SEC);
+    }
+    k_work_schedule_for_queue(&workQueue, &sendWork, K_MSEC(remainingMs));
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**< Send one payload as a confirmable CoAP POST and wait for the ACK. */
+int Uplink::send(const uint8_t *payload, size_t length) {
+    static uint8_t packet[PAYLOAD_SIZE + COAP_HEADER_RESERVE];
+    static uint8_t reply[COAP_REPLY_SIZE];
+    struct coap_packet request;
+    struct sockaddr_in server = {};
+
+    server.sin_family = AF_INET;
+    server.sin_port   = htons(CONFIG_APP_UPLINK_SERVER_PORT);
+    if (zsock_inet_pton(AF_INET, CONFIG_APP_UPLINK_SERVER_ADDR, &server.sin_addr) != 1) {
+        return -EINVAL;
+    }
+
+    uint16_t messageId = coap_next_id();
+    int error = coap_packet_init(&request, packet, sizeof(packet), COAP_VERSION_1, COAP_TYPE_CON,
+                                 COAP_TOKEN_MAX_LEN, coap_next_token(), COAP_METHOD_POST, messageId);
+    if (error == 0) {
+        error = coap_packet_append_option(&request, COAP_OPTION_URI_PATH,
+                                          reinterpret_cast<const uint8_t *>(CONFIG_APP_UPLINK_RESOURCE),
+                                          strlen(CONFIG_APP_UPLINK_RESOURCE));
+    }
+    if (error == 0) {
+        error = coap_append_option_int(&request, COAP_OPTION_CONTENT_FORMAT,
+                                       COAP_CONTENT_FORMAT_APP_OCTET_STREAM);
+    }
+    if (error == 0) {
+        error = coap_packet_append_payload_marker(&request);
+    }
+    if (error == 0) {
+        error = coap_packet_append_payload(&request, payload, length);
+    }
+    if (error) {
+        LOG_ERR("Failed to build CoAP request: %d", error);
+        return error;
+    }
+
+    int sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return -errno;
+    }
+
+    struct zsock_timeval timeout = {.tv_sec = CONFIG_APP_UPLINK_ACK_TIMEOUT_SECONDS, .tv_usec = 0};
+    (void)zsock_setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    error = zsock_connect(sock, reinterpret_cast<struct sockaddr *>(&server), sizeof(server));
+    for (int attempt = 0; error == 0 && attempt <= CONFIG_APP_UPLINK_RETRIES; attempt++) {
+        if (zsock_send(sock, request.data, request.offset, 0) < 0) {
+            error = -errno;
+            break;
+        }
+        counters.bytes += request.offset;
+
+        ssize_t received = zsock_recv(sock, reply, sizeof(reply), 0);
+        if (received < 0) {
+            continue;
+        }
+
+        struct coap_packet response;
+        if (coap_packet_parse(&response, reply, received, nullptr, 0) == 0 &&
+            coap_header_get_type(&response) == COAP_TYPE_ACK && coap_header_get_id(&response) == messageId) {
+            uint8_t code = coap_header_get_code(&response);
+            zsock_close(sock);
+            return (code >> 5) == 2 ? 0 : -EBADMSG;
+        }
+    }
+
+    zsock_close(sock);
+    return error ? error : -ETIMEDOUT;
+}
+
+/**< Send one payload and account it in the statistics. */
+int Uplink::deliver(const uint8_t *payload, size_t length) {
+    const SampleCodec::BatchHeader *batch =
+        reinterpret_cast<const SampleCodec::BatchHeader *>(payload + sizeof(PayloadHeader));
+    uint16_t samples = batch->count;
+
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger &ledger = EnergyLedger::getInstance();
+    ledger.setActive(EnergyLedger::Subsystem::Radio, true);
+    int error = send(payload, length);
+    ledger.setActive(EnergyLedger::Subsystem::Radio, false);
+    ledger.addOperations(EnergyLedger::Subsystem::Radio);
+#else
+    int error = send(payload, length);
+#endif
+    if (error) {
+        counters.failures++;
+        LOG_WRN("Uplink of %u samples failed: %d", samples, error);
+    } else {
+        counters.samples += samples;
+    }
+
+    uint32_t uptimeMs        = MAX(k_uptime_get_32(), 1U);
+    uint32_t bytesPer100     = counters.samples ? counters.bytes * 100U / counters.samples : 0;
+    uint32_t sessionsPerHour = static_cast<uint32_t>(uint64_t{counters.sessions} * 3600000U / uptimeMs);
+    LOG_INF("Uplink session %u: %u samples in %u bytes, %u.%02u B/sample, %u sessions/h", counters.sessions,
+            samples, static_cast<unsigned int>(length), bytesPer100 / 100, bytesPer100 % 100, sessionsPerHour);
+    return error;
+}
+
+int Uplink::queueSink(const uint8_t *payload, size_t length, void *context) {
+    return getInstance().deliver(payload, length);
+}
+
+void Uplink::sendHandler(struct k_work *work) {
+    Uplink &self = getInstance();
+
+#ifdef CONFIG_APP_UPLINK_QUEUE
+    UplinkQueue &queue = UplinkQueue::getInstance();
+    if (queue.pending() == 0 || !Connectivity::getInstance().isConnected()) {
+        /* Retried from linkStateListener once the link is up. */
+        return;
+    }
+    if (self.holdBack()) {
+        return;
+    }
+
+    /* One radio session per drain, the rest of a long backlog follows with the next batch. */
+    self.counters.sessions++;
+    int delivered = queue.drain(CONFIG_APP_UPLINK_QUEUE_SESSION_BUDGET, queueSink, nullptr);
+    if (delivered < 0) {
+        LOG_WRN("Uplink queue drain stopped: %d, %u payloads pending", delivered, queue.pending());
+    }
+#else
+    if (self.sendingLength == 0 || !Connectivity::getInstance().isConnected()) {
+        /* Retried from linkStateListener once the link is up. */
+        return;
+    }
+    if (self.holdBack()) {
+        return;
+    }
+
+    self.counters.sessions++;
+    (void)self.deliver(self.sending, self.sendingLength);
+
+    k_mutex_lock(&lock, K_FOREVER);
+    self.sendingLength = 0;
+    /* A flush, a full batch or its deadline that came while this batch was in flight could not
+     * seal, that batch goes now. Samples that merely arrived meanwhile wait for their own.
+     */
+    if (self.sealDeferred && self.seal(self.urgentPending)) {
+        self.urgentPending = false;
+    }
+    k_mutex_unlock(&lock);
+#endif
+}
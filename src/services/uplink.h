@@ -0,0 +1,108 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+// App modules
+#include "connectivity.h"
+#include "sample.h"
+#include "sample_codec.h"
+#include "time_service.h"
+#ifdef CONFIG_APP_UPLINK_SIGNAL_AWARE
+#include "uplink_policy.h"
+#endif
+
+namespace Services {
+    /**< Batched uplink of samples.
+     *
+     * Samples are encoded with SampleCodec into one payload that is sent as a single confirmable
+     * CoAP POST once CONFIG_APP_UPLINK_BATCH_SAMPLES samples are collected or
+     * CONFIG_APP_UPLINK_FLUSH_SECONDS have passed since the first sample of the batch, whichever
+     * comes first. flushNow() sends the pending batch immediately, for alerts. Batches are built in
+     * one buffer while the previous one is sent from the other. With CONFIG_APP_UPLINK_QUEUE sealed
+     * batches go through UplinkQueue instead and are kept until the server acknowledges them. With
+     * CONFIG_APP_UPLINK_SIGNAL_AWARE batches that are not urgent wait for a better signal, see
+     * UplinkPolicy.
+     */
+    class Uplink {
+      public:
+        static constexpr size_t PAYLOAD_SIZE = CONFIG_APP_UPLINK_PAYLOAD_SIZE;
+
+        /**< Ahead of every payload. time places its sample stamps in UTC on the server, also for
+         * batches replayed from UplinkQueue after a reboot.
+         */
+        struct __attribute__((packed)) PayloadHeader {
+            uint8_t version;
+            uint8_t flags;
+            uint16_t sequence;
+            TimeService::TimeBase time; // when the batch was sealed
+        };
+        static constexpr uint8_t PAYLOAD_VERSION  = 2;
+        static constexpr uint8_t FLAG_URGENT      = BIT(0);
+        static constexpr uint8_t FLAG_DOWNSAMPLED = BIT(1); // rewritten by UplinkQueue when it was full
+
+        struct Stats {
+            uint32_t sessions; // radio sessions, one per payload
+            uint32_t samples;  // samples delivered
+            uint32_t bytes;    // CoAP bytes sent, header and retransmissions included
+            uint32_t failures; // payloads that were not acknowledged
+            uint32_t dropped;  // samples dropped because both buffers, or the queue, were full
+            uint32_t deferred; // times sending was held back for a better signal
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        Uplink(const Uplink &)            = delete;
+        Uplink &operator=(const Uplink &) = delete;
+        static Uplink &getInstance() { return instance; }
+        int init();
+
+        /**< Add a sample to the current batch. Never blocks on the network. */
+        int add(const Sample &sample);
+        /**< Send the current batch now, flagged as urgent. */
+        void flushNow();
+        /**< Stretch the flush period to percent of CONFIG_APP_UPLINK_FLUSH_SECONDS, from the next batch. */
+        void setPeriodScale(uint16_t percent) { atomic_set(&periodScale, percent); }
+
+        Stats stats() const { return counters; }
+
+      private:
+        constexpr Uplink() = default;
+        static Uplink instance;
+        static void flushHandler(struct k_work *work);
+        static void sendHandler(struct k_work *work);
+        static void linkStateListener(Connectivity::LinkState state);
+        static void qualityListener(const LinkControl::Quality &quality);
+        bool seal(bool urgent);
+        bool holdBack();
+        int send(const uint8_t *payload, size_t length);
+        int deliver(const uint8_t *payload, size_t length);
+        static int queueSink(const uint8_t *payload, size_t length, void *context);
+
+        static struct k_work_q workQueue;
+        static struct k_work_delayable flushWork;
+        static struct k_work_delayable sendWork;
+        SampleCodec::Encoder encoder;
+        uint8_t buffers[2][PAYLOAD_SIZE] = {};
+        uint8_t *building    = buffers[0];
+        uint8_t *sending     = buffers[1];
+        size_t sendingLength = 0; // 0 while the sending buffer is free
+        uint16_t sequence    = 0;
+        bool urgentPending   = false;
+        bool sealDeferred    = false; // a seal found the sending buffer busy
+        atomic_t periodScale = ATOMIC_INIT(100);
+        atomic_t urgentQueued = ATOMIC_INIT(0); // the next send must not be held back
+#ifdef CONFIG_APP_UPLINK_SIGNAL_AWARE
+        UplinkPolicy policy{{
+            .rsrpMin    = CONFIG_APP_UPLINK_RSRP_MIN,
+            .rsrqMin    = CONFIG_APP_UPLINK_RSRQ_MIN,
+            .hysteresis = CONFIG_APP_UPLINK_SIGNAL_HYSTERESIS,
+            .maxDeferMs = CONFIG_APP_UPLINK_MAX_DEFER_SECONDS * MSEC_PER_SEC,
+        }};
+#endif
+        Stats counters{};
+        bool initialized = false;
+    };
+} // namespace Services
@@ -0,0 +1,65 @@
+#pragma once
+// Standard modules
+#include <cstdint>
+// App modules
+#include "link_control.h"
+
+namespace Services {
+    /**< When Uplink sends a batch, given the signal of the serving cell.
+     *
+     * Under poor coverage the modem transmits at higher power and retransmits more, so each byte
+     * costs several times the energy it does under good coverage. A batch that is not urgent is held
+     * back while RSRP or RSRQ is below its threshold, until the signal recovers by the hysteresis or
+     * maxDeferMs passed since it was first held back. Urgent batches and unknown signal never wait.
+     *
+     * No kernel calls, time is passed in, so the decisions can be replayed from a recorded signal
+     * trace on any host.
+     */
+    class UplinkPolicy {
+      public:
+        struct Config {
+            int16_t rsrpMin;     // dBm
+            int16_t rsrqMin;     // dB
+            int16_t hysteresis;  // dB above the thresholds the signal has to recover to
+            uint32_t maxDeferMs; // latest a batch is sent after it was first held back
+        };
+
+        explicit constexpr UplinkPolicy(const Config &config) : config(config) {}
+
+        /**< Returns 0 to send now, or how many ms a batch may still be held back. */
+        uint32_t evaluate(uint32_t nowMs, const LinkControl::Quality &quality, bool urgent) {
+            if (urgent || isGood(quality)) {
+                deferring = false;
+                return 0;
+            }
+            if (!deferring) {
+                deferring     = true;
+                deferredSince = nowMs;
+            }
+            uint32_t waited = nowMs - deferredSince;
+            if (waited >= config.maxDeferMs) {
+                deferring = false;
+                return 0;
+            }
+            return config.maxDeferMs - waited;
+        }
+
+        bool isDeferring() const { return deferring; }
+
+      private:
+        bool isGood(const LinkControl::Quality &quality) const {
+            int16_t margin = deferring ? config.hysteresis : 0;
+            if (quality.rsrp == LinkControl::QUALITY_UNKNOWN) {
+                return true;
+            }
+            if (quality.rsrp < config.rsrpMin + margin) {
+                return false;
+            }
+            return quality.rsrq == LinkControl::QUALITY_UNKNOWN || quality.rsrq >= config.rsrqMin + margin;
+        }
+
+        Config config;
+        uint32_t deferredSince = 0;
+        bool deferring         = false;
+    };
+} // namespace Services
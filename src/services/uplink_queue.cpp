@@ -0,0 +1,429 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/storage/flash_map.h>
+#if defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#include <pm_config.h>
+#endif
+#include <errno.h>
+// App modules
+#ifdef CONFIG_APP_ENERGY
+#include "energy_ledger.h"
+#endif
+#include "sample_codec.h"
+#include "settings_storage.h"
+#include "uplink.h"
+#include "uplink_queue.h"
+
+#ifdef CONFIG_APP_ENERGY
+using Services::EnergyLedger;
+#endif
+using Services::SampleCodec;
+using Services::SettingsStorage;
+using Services::TimeService;
+using Services::Uplink;
+using Services::UplinkQueue;
+
+LOG_MODULE_REGISTER(uplink_queue, LOG_LEVEL_INF);
+
+/* The partition is named uplink_queue in the babbies_tracker_pm_static*.yml layouts and
+ * uplink_queue_partition in the DTS for builds without the partition manager. The LwM2M carrier
+ * layout has no room for it.
+ */
+#if defined(PM_UPLINK_QUEUE_ID)
+#define UPLINK_QUEUE_PARTITION_ID PM_UPLINK_QUEUE_ID
+#elif !defined(CONFIG_PARTITION_MANAGER_ENABLED)
+#define UPLINK_QUEUE_PARTITION_ID FIXED_PARTITION_ID(uplink_queue_partition)
+#endif
+
+#define UPLINK_QUEUE_MAGIC   0x55514551 /* "UQEQ" */
+#define UPLINK_QUEUE_VERSION 1
+#define MAX_WRITE_BLOCK      8
+
+/**< Restores the head marker when settings_load() runs. */
+static int uplinkqRootHandleSet(const char *name, size_t length, settings_read_cb readCallBack,
+                                void *callBackArguments) {
+    const char *next;
+    uint32_t acked;
+
+    if (settings_name_steq(name, "acked", &next) && !next) {
+        if (length != sizeof(acked)) {
+            return -EINVAL;
+        }
+        int rc = readCallBack(callBackArguments, &acked, sizeof(acked));
+        if (rc < 0) {
+            return rc;
+        }
+        UplinkQueue::getInstance().setAcked(acked);
+        return 0;
+    }
+    return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(uplinkqRootHandle, "uplinkq", nullptr, uplinkqRootHandleSet, nullptr, nullptr);
+
+constinit UplinkQueue UplinkQueue::instance;
+static K_MUTEX_DEFINE(lock);
+
+int UplinkQueue::init() {
+#ifndef UPLINK_QUEUE_PARTITION_ID
+    LOG_ERR("No uplink_queue partition in this flash layout");
+    return -ENODEV;
+#else
+    uint32_t sectorCount = ARRAY_SIZE(sectors);
+    int error = flash_area_get_sectors(UPLINK_QUEUE_PARTITION_ID, &sectorCount, sectors);
+    if (error) {
+        LOG_ERR("Failed to get uplink queue sectors: %d", error);
+        return error;
+    }
+
+    fcb.f_magic      = UPLINK_QUEUE_MAGIC;
+    fcb.f_version    = UPLINK_QUEUE_VERSION;
+    fcb.f_sector_cnt = static_cast<uint8_t>(sectorCount);
+    /* Downsampling rewrites the oldest sector into a spare one before erasing it. */
+    fcb.f_scratch_cnt = IS_ENABLED(CONFIG_APP_UPLINK_QUEUE_FULL_DOWNSAMPLE) ? 1 : 0;
+    fcb.f_sectors     = sectors;
+
+    error = fcb_init(UPLINK_QUEUE_PARTITION_ID, &fcb);
+    if (error) {
+        LOG_ERR("Failed to initialize uplink queue FCB: %d", error);
+        return error;
+    }
+    if (fcb.f_align > MAX_WRITE_BLOCK) {
+        return -ENOTSUP;
+    }
+
+    /* Continue the sequence after the newest record that survived the reboot. */
+    struct fcb_entry location = {};
+    RecordHeader header;
+    k_mutex_lock(&lock, K_FOREVER);
+    while (fcb_getnext(&fcb, &location) == 0) {
+        if (readHeader(location, header) == 0 && header.sequence >= nextSequence) {
+            nextSequence = header.sequence + 1;
+        }
+    }
+    initialized = true;
+    k_mutex_unlock(&lock);
+
+    LOG_INF("Initialized UplinkQueue: %u sectors, next sequence %u", sectorCount, nextSequence);
+    return 0;
+#endif
+}
+
+void UplinkQueue::setAcked(uint32_t sequence) {
+    k_mutex_lock(&lock, K_FOREVER);
+    acked = sequence;
+    if (nextSequence <= acked) {
+        nextSequence = acked + 1;
+    }
+    k_mutex_unlock(&lock);
+}
+
+int UplinkQueue::readHeader(const struct fcb_entry &location, RecordHeader &header) {
+    if (location.fe_data_len < sizeof(header)) {
+        return -EBADMSG;
+    }
+    return flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(location), &header, sizeof(header));
+}
+
+int UplinkQueue::readPayload(const struct fcb_entry &location, const RecordHeader &header, uint8_t *buffer) {
+    if (header.length > MAX_PAYLOAD || sizeof(header) + header.length > location.fe_data_len) {
+        return -EBADMSG;
+    }
+    return flash_area_read(fcb.fap, FCB_ENTRY_FA_DATA_OFF(location) + sizeof(header), buffer, header.length);
+}
+
+/**< Write one record. The payload is written in place and only its last partial write block is
+ * copied, so no record-sized bounce buffer is needed. Called with the lock held.
+ */
+int UplinkQueue::append(const uint8_t *data, size_t length, uint32_t sequence) {
+    RecordHeader header = {
+        .sequence = sequence,
+        .length   = static_cast<uint16_t>(length),
+        .reserved = 0,
+    };
+    size_t aligned = ROUND_DOWN(length, fcb.f_align);
+    size_t padded  = ROUND_UP(length, fcb.f_align);
+    struct fcb_entry location;
+
+    int error = fcb_append(&fcb, static_cast<uint16_t>(sizeof(header) + padded), &location);
+    if (error) {
+        return error;
+    }
+
+    off_t offset = FCB_ENTRY_FA_DATA_OFF(location);
+    error        = flash_area_write(fcb.fap, offset, &header, sizeof(header));
+    if (error == 0 && aligned) {
+        error = flash_area_write(fcb.fap, offset + sizeof(header), data, aligned);
+    }
+    if (error == 0 && padded != aligned) {
+        uint8_t tail[MAX_WRITE_BLOCK] = {};
+        memcpy(tail, &data[aligned], length - aligned);
+        error = flash_area_write(fcb.fap, offset + sizeof(header) + aligned, tail, padded - aligned);
+    }
+    if (error) {
+        LOG_ERR("Failed to write uplink queue record: %d", error);
+        return error;
+    }
+    return fcb_append_finish(&fcb, &location);
+}
+
+int UplinkQueue::countUnsentHandler(struct fcb_entry_ctx *entry, void *arg) {
+    UplinkQueue &self = getInstance();
+    uint32_t *unsent  = static_cast<uint32_t *>(arg);
+    RecordHeader header;
+
+    if (self.readHeader(entry->loc, header) == 0 && header.sequence > self.acked) {
+        (*unsent)++;
+    }
+    return 0;
+}
+
+/**< Count records in sector that were not acknowledged yet. Called with the lock held. */
+uint32_t UplinkQueue::unsentInSector(struct flash_sector *sector) {
+    uint32_t unsent = 0;
+
+    (void)fcb_walk(&fcb, sector, countUnsentHandler, &unsent);
+    return unsent;
+}
+
+int UplinkQueue::dropOldest() {
+    uint32_t unsent = unsentInSector(fcb.f_oldest);
+
+    int error = fcb_rotate(&fcb);
+    if (error) {
+        return error;
+    }
+    rotations++;
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::Flash);
+#endif
+    dropped += unsent;
+    if (unsent) {
+        LOG_WRN("Uplink queue full, dropped %u unsent payloads", unsent);
+    }
+    return 0;
+}
+
+struct UplinkQueue::DownsampleState {
+    SampleCodec::Encoder encoder;
+    TimeService::TimeBase time{}; // of the samples in encoder
+    uint32_t kept    = 0;
+    uint32_t seen    = 0;
+    uint32_t sources = 0;
+    int error        = 0;
+};
+
+/**< Write the resampled batch as a new record. Called with the lock held. */
+int UplinkQueue::flushResampled(DownsampleState &state) {
+    if (state.encoder.empty()) {
+        return 0;
+    }
+    Uplink::PayloadHeader payloadHeader = {
+        .version  = Uplink::PAYLOAD_VERSION,
+        .flags    = Uplink::FLAG_DOWNSAMPLED,
+        .sequence = static_cast<uint16_t>(nextSequence),
+        .time     = state.time,
+    };
+    memcpy(resampled, &payloadHeader, sizeof(payloadHeader));
+    int error = append(resampled, sizeof(payloadHeader) + state.encoder.size(), nextSequence++);
+    state.encoder.begin(resampled + sizeof(Uplink::PayloadHeader), MAX_PAYLOAD - sizeof(Uplink::PayloadHeader));
+    return error;
+}
+
+/**< Keep every CONFIG_APP_UPLINK_QUEUE_DOWNSAMPLE_FACTOR-th sample of an unsent record. */
+int UplinkQueue::downsampleHandler(struct fcb_entry_ctx *entry, void *arg) {
+    UplinkQueue &self      = getInstance();
+    DownsampleState &state = *static_cast<DownsampleState *>(arg);
+    SampleCodec::Decoder decoder;
+    RecordHeader header;
+    Services::Sample sample;
+
+    if (self.readHeader(entry->loc, header) != 0 || header.sequence <= self.acked ||
+        self.readPayload(entry->loc, header, self.readBuffer) != 0 ||
+        header.length < sizeof(Uplink::PayloadHeader) ||
+        !decoder.begin(self.readBuffer + sizeof(Uplink::PayloadHeader),
+                       header.length - sizeof(Uplink::PayloadHeader))) {
+        return 0;
+    }
+
+    /* Stamps only compare within one boot and correction, a source with another one starts a batch.
+     * Payloads queued by an older image keep their format and are sent as they are.
+     */
+    Uplink::PayloadHeader source;
+    memcpy(&source, self.readBuffer, sizeof(source));
+    if (source.version != Uplink::PAYLOAD_VERSION) {
+        return 0;
+    }
+    if (memcmp(&source.time, &state.time, sizeof(state.time)) != 0) {
+        state.error = self.flushResampled(state);
+        if (state.error) {
+            return 1;
+        }
+        state.time = source.time;
+    }
+
+    state.sources++;
+    while (decoder.next(sample)) {
+        if (state.seen++ % CONFIG_APP_UPLINK_QUEUE_DOWNSAMPLE_FACTOR != 0) {
+            continue;
+        }
+        if (!state.encoder.append(sample)) {
+            state.error = self.flushResampled(state);
+            if (state.error) {
+                /* Scratch sector is full as well, the rest of the sector is dropped. */
+                return 1;
+            }
+            (void)state.encoder.append(sample);
+        }
+        state.kept++;
+    }
+    return 0;
+}
+
+/**< Decimate the unsent samples of the oldest sector into the scratch sector, then erase it.
+ * Called with the lock held.
+ */
+int UplinkQueue::downsampleOldest() {
+    if (fcb_append_to_scratch(&fcb) != 0) {
+        return dropOldest();
+    }
+
+    DownsampleState state;
+    state.encoder.begin(resampled + sizeof(Uplink::PayloadHeader), MAX_PAYLOAD - sizeof(Uplink::PayloadHeader));
+    (void)fcb_walk(&fcb, fcb.f_oldest, downsampleHandler, &state);
+    if (state.error == 0) {
+        (void)flushResampled(state);
+    }
+
+    int error = fcb_rotate(&fcb);
+    if (error) {
+        return error;
+    }
+    rotations++;
+#ifdef CONFIG_APP_ENERGY
+    EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::Flash);
+#endif
+    downsampled += state.sources;
+    LOG_WRN("Uplink queue full, downsampled %u payloads to %u of %u samples", state.sources, state.kept,
+            state.seen);
+    return 0;
+}
+
+int UplinkQueue::makeRoom() {
+    if (IS_ENABLED(CONFIG_APP_UPLINK_QUEUE_FULL_DOWNSAMPLE)) {
+        return downsampleOldest();
+    }
+    return dropOldest();
+}
+
+int UplinkQueue::push(const uint8_t *data, size_t length) {
+    if (!initialized) {
+        return -EACCES;
+    }
+    if (length > MAX_PAYLOAD) {
+        return -EMSGSIZE;
+    }
+
+    /* The sequence is only taken once the record is written: makeRoom() may append resampled
+     * records first, and a lower sequence behind them would be skipped as acknowledged.
+     */
+    k_mutex_lock(&lock, K_FOREVER);
+    uint32_t sequence = nextSequence;
+    int error         = append(data, length, sequence);
+    if (error == -ENOSPC) {
+        error = makeRoom();
+        if (error == 0) {
+            sequence = nextSequence;
+            error    = append(data, length, sequence);
+        }
+    }
+    if (error == 0) {
+        nextSequence++;
+    }
+    k_mutex_unlock(&lock);
+
+    if (error) {
+        LOG_ERR("Failed to queue payload %u: %d", sequence, error);
+    }
+    return error;
+}
+
+/**< Erase leading sectors whose records are all acknowledged. Called with the lock held. */
+void UplinkQueue::reclaim() {
+    while (fcb.f_oldest != fcb.f_active.fe_sector && unsentInSector(fcb.f_oldest) == 0) {
+        if (fcb_rotate(&fcb) != 0) {
+            return;
+        }
+        rotations++;
+#ifdef CONFIG_APP_ENERGY
+        EnergyLedger::getInstance().addOperations(EnergyLedger::Subsystem::Flash);
+#endif
+    }
+}
+
+int UplinkQueue::drain(size_t byteBudget, Sink sink, void *context) {
+    if (!initialized) {
+        return -EACCES;
+    }
+    /* The head marker is restored by settings_load(), draining before it would resend everything. */
+    if (!SettingsStorage::getInstance().isInitialized()) {
+        return -EAGAIN;
+    }
+
+    struct fcb_entry location = {};
+    RecordHeader header;
+    size_t sentBytes = 0;
+    int delivered    = 0;
+    int error        = 0;
+
+    k_mutex_lock(&lock, K_FOREVER);
+    uint32_t startAcked = acked;
+    while (sentBytes < byteBudget) {
+        uint32_t seenRotations = rotations;
+        if (fcb_getnext(&fcb, &location) != 0) {
+            break;
+        }
+        if (readHeader(location, header) != 0 || header.sequence <= acked) {
+            continue;
+        }
+        error = readPayload(location, header, readBuffer);
+        if (error) {
+            LOG_WRN("Skipping unreadable payload %u: %d", header.sequence, error);
+            error = 0;
+            continue;
+        }
+
+        /* Do not hold the lock over the network, push() may run meanwhile. */
+        k_mutex_unlock(&lock);
+        error = sink(readBuffer, header.length, context);
+        k_mutex_lock(&lock, K_FOREVER);
+        if (error) {
+            break;
+        }
+
+        acked = MAX(acked, header.sequence);
+        sentBytes += header.length;
+        delivered++;
+
+        if (rotations != seenRotations) {
+            /* push() erased a sector, restart from the oldest record, acked ones are skipped. */
+            location = {};
+        }
+    }
+
+    if (acked != startAcked) {
+        uint32_t marker = acked;
+        (void)SettingsStorage::getInstance().SetKey(KEY_ACKED, &marker, sizeof(marker));
+        reclaim();
+    }
+    k_mutex_unlock(&lock);
+
+    LOG_INF("Drained %d payloads, %u bytes, %u pending", delivered, static_cast<unsigned int>(sentBytes),
+            pending());
+    return error ? error : delivered;
+}
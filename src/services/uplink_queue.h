@@ -0,0 +1,82 @@
+#pragma once
+// Standard modules
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+// Zephyr modules
+#include <zephyr/fs/fcb.h>
+#include <zephyr/kernel.h>
+
+namespace Services {
+    /**< Persistent store-and-forward FIFO of Uplink payloads on the uplink_queue flash partition.
+     *
+     * The tail is the FCB append position, every record carries a 32-bit sequence number and is
+     * CRC protected by the FCB. The head is the sequence number of the last payload the server
+     * acknowledged, persisted through SettingsStorage once per drain session. A reboot between an
+     * acknowledge and the marker update resends at most one session, never loses a payload.
+     * Sectors are erased once every record in them is acknowledged.
+     *
+     * When the partition is full CONFIG_APP_UPLINK_QUEUE_FULL_* decides whether the oldest sector
+     * is dropped, or whether its unsent samples are decimated into the reserved scratch sector
+     * before it is erased.
+     */
+    class UplinkQueue {
+      public:
+        using key_t                            = std::string_view;
+        constexpr static key_t KEY_ACKED       = "uplinkq/acked";
+        static constexpr size_t MAX_PAYLOAD    = CONFIG_APP_UPLINK_PAYLOAD_SIZE;
+        /**< Delivers one payload. Returns 0 once the server acknowledged it. */
+        using Sink = int (*)(const uint8_t *payload, size_t length, void *context);
+
+        struct __attribute__((packed)) RecordHeader {
+            uint32_t sequence;
+            uint16_t length; // payload bytes, the FCB entry is padded to the write block size
+            uint16_t reserved;
+        };
+
+        // Delete copy constructor and assignment operator to enforce singleton pattern
+        UplinkQueue(const UplinkQueue &)            = delete;
+        UplinkQueue &operator=(const UplinkQueue &) = delete;
+        static UplinkQueue &getInstance() { return instance; }
+        int init();
+
+        /**< Append a payload at the tail. */
+        int push(const uint8_t *payload, size_t length);
+        /**< Send unacknowledged payloads oldest first until byteBudget bytes were delivered, the queue
+         * is empty or the sink fails. Returns the number of payloads delivered or a negative errno.
+         */
+        int drain(size_t byteBudget, Sink sink, void *context);
+
+        uint32_t pending() const { return nextSequence - 1 - acked; }
+        uint32_t droppedPayloads() const { return dropped; }
+        uint32_t downsampledPayloads() const { return downsampled; }
+        void setAcked(uint32_t sequence);
+
+      private:
+        constexpr UplinkQueue() = default;
+        static UplinkQueue instance;
+        int makeRoom();
+        int downsampleOldest();
+        int dropOldest();
+        int append(const uint8_t *payload, size_t length, uint32_t sequence);
+        void reclaim();
+        int readHeader(const struct fcb_entry &location, RecordHeader &header);
+        int readPayload(const struct fcb_entry &location, const RecordHeader &header, uint8_t *payload);
+        uint32_t unsentInSector(struct flash_sector *sector);
+        struct DownsampleState;
+        int flushResampled(DownsampleState &state);
+        static int countUnsentHandler(struct fcb_entry_ctx *entry, void *arg);
+        static int downsampleHandler(struct fcb_entry_ctx *entry, void *arg);
+
+        struct fcb fcb {};
+        struct flash_sector sectors[CONFIG_APP_UPLINK_QUEUE_MAX_SECTORS] = {};
+        uint8_t readBuffer[MAX_PAYLOAD] = {}; // drain and downsample read buffer
+        uint8_t resampled[MAX_PAYLOAD]  = {}; // downsample write buffer
+        uint32_t rotations    = 0;
+        uint32_t nextSequence = 1;
+        uint32_t acked        = 0;
+        uint32_t dropped      = 0;
+        uint32_t downsampled  = 0;
+        bool initialized      = false;
+    };
+} // namespace Services
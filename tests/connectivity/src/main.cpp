@@ -0,0 +1,59 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/ztest.h>
+// App modules
+#include "connectivity.h"
+#include "link_control.h"
+#include "settings_storage.h"
+
+using Services::Connectivity;
+using Services::SettingsStorage;
+namespace LinkControl = Services::LinkControl;
+
+/* Connectivity against the stub link control: start() must not wait for the modem, the bring-up
+ * waits for the settings and applies the stored APN, and the listeners see the attach.
+ */
+
+K_MSGQ_DEFINE(states, sizeof(Connectivity::LinkState), 8, 1);
+
+static void stateListener(Connectivity::LinkState state) { (void)k_msgq_put(&states, &state, K_NO_WAIT); }
+
+static Connectivity::LinkState nextState() {
+    Connectivity::LinkState state = Connectivity::LinkState::Offline;
+    zassert_ok(k_msgq_get(&states, &state, K_MSEC(CONFIG_APP_CONNECTIVITY_STUB_ATTACH_MS * 10)),
+               "No link-state change");
+    return state;
+}
+
+ZTEST(connectivity, test_bring_up_with_stored_apn) {
+    Connectivity &connectivity = Connectivity::getInstance();
+    SettingsStorage &settings  = SettingsStorage::getInstance();
+    char apn[]                 = "test_apn";
+
+    zassert_ok(settings_subsys_init());
+    zassert_ok(settings.SetKey(SettingsStorage::KEY_CELL_APN, apn, sizeof(apn)));
+    zassert_ok(connectivity.addListener(stateListener));
+
+    // The bring-up runs on the connectivity work queue, nothing has happened when start() returns
+    int64_t startTime = k_uptime_get();
+    zassert_ok(connectivity.start());
+    zassert_true(k_uptime_get() - startTime < 10, "start() blocked");
+    zassert_equal(connectivity.state(), Connectivity::LinkState::Offline);
+    zassert_equal(connectivity.start(), -EALREADY);
+
+    // Attach waits for the settings, so the stored APN is set before it
+    k_sleep(K_MSEC(CONFIG_APP_CONNECTIVITY_SETTINGS_TIMEOUT_MS / 4));
+    zassert_equal(connectivity.state(), Connectivity::LinkState::Offline);
+    zassert_equal(LinkControl::stubApn()[0], '\0');
+    zassert_ok(settings.init());
+
+    zassert_equal(nextState(), Connectivity::LinkState::Searching);
+    zassert_str_equal(LinkControl::stubApn(), apn);
+    zassert_equal(nextState(), Connectivity::LinkState::Registered);
+    zassert_true(connectivity.isConnected());
+}
+
+ZTEST_SUITE(connectivity, NULL, NULL, NULL, NULL, NULL);
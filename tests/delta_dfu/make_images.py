@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+"""Write the old and new images the delta_dfu test patches between.
+
+The new image is the old one with the edits a rebuild makes: changed bytes, a
+block moved, code inserted and removed, and a longer tail. new.sha256 holds the
+digest the test checks the secondary slot against.
+"""
+import hashlib
+import os
+import random
+import sys
+
+OLD_SIZE = 12 * 1024
+
+
+def main():
+    directory = sys.argv[1]
+    generator = random.Random(0xB7DF)
+    old = generator.randbytes(OLD_SIZE)
+
+    new = bytearray(old)
+    new[1000:1064] = generator.randbytes(64)
+    new[2048:2048] = generator.randbytes(300)
+    del new[6000:6512]
+    new[8192:9216], new[9216:10240] = new[9216:10240], new[8192:9216]
+    new += generator.randbytes(1500)
+
+    os.makedirs(directory, exist_ok=True)
+    for name, content in (("old.bin", old), ("new.bin", new), ("new.sha256", hashlib.sha256(new).digest())):
+        with open(os.path.join(directory, name), "wb") as file:
+            file.write(content)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,135 @@
+// Standard modules
+#include <algorithm>
+#include <cstring>
+// Zephyr modules
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/littlefs.h>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/ztest.h>
+// App modules
+#include "delta_dfu.h"
+
+using Services::DeltaDfu;
+
+/* DeltaDfu on the simulated MCUboot slots. The build writes an old and a new image with
+ * make_images.py and the patch between them with scripts/make_delta.py, the test puts the old image
+ * in the primary slot, applies the patch streamed in chunks or from a file, the local stand-in for
+ * the download, and checks what lands in the secondary slot.
+ */
+
+static const uint8_t oldImage[] = {
+#include "old.bin.inc"
+};
+static const uint8_t newImage[] = {
+#include "new.bin.inc"
+};
+static const uint8_t newHash[] = {
+#include "new.sha256.inc"
+};
+static const uint8_t patch[] = {
+#include "patch.bin.inc"
+};
+
+// Not a divisor of the header or of any operation, so every part of the patch is split somewhere
+static constexpr size_t CHUNK_SIZE = 37;
+
+static const struct flash_area *primary;
+static const struct flash_area *secondary;
+
+static constexpr char PATCH_FILE[] = "/patch/patch.bin";
+FS_LITTLEFS_DECLARE_DEFAULT_CONFIG(patchStorage);
+static struct fs_mount_t patchMount = {
+    .type        = FS_LITTLEFS,
+    .mnt_point   = "/patch",
+    .fs_data     = &patchStorage,
+    .storage_dev = reinterpret_cast<void *>(static_cast<uintptr_t>(FIXED_PARTITION_ID(scratch_partition))),
+};
+
+static int streamPatch(size_t length) {
+    DeltaDfu &dfu = DeltaDfu::getInstance();
+
+    int error = dfu.begin();
+    for (size_t offset = 0; error == 0 && offset < length; offset += CHUNK_SIZE) {
+        error = dfu.write(patch + offset, std::min(CHUNK_SIZE, length - offset));
+    }
+    return error;
+}
+
+static void checkSecondary() {
+    static uint8_t buffer[256];
+
+    struct flash_area_check check = {
+        .match = newHash,
+        .clen  = sizeof(newImage),
+        .off   = 0,
+        .rbuf  = buffer,
+        .rblen = sizeof(buffer),
+    };
+    zassert_ok(flash_area_check_int_sha256(secondary, &check));
+
+    for (size_t offset = 0; offset < sizeof(newImage); offset += sizeof(buffer)) {
+        size_t length = std::min(sizeof(buffer), sizeof(newImage) - offset);
+        zassert_ok(flash_area_read(secondary, offset, buffer, length));
+        zassert_mem_equal(buffer, newImage + offset, length, "differs at %u", static_cast<unsigned int>(offset));
+    }
+}
+
+static void *setup(void) {
+    zassert_ok(flash_area_open(FIXED_PARTITION_ID(slot0_partition), &primary));
+    zassert_ok(flash_area_open(FIXED_PARTITION_ID(slot1_partition), &secondary));
+    zassert_ok(DeltaDfu::getInstance().init());
+    zassert_ok(fs_mount(&patchMount));
+    return NULL;
+}
+
+/**< The flash file outlives the run, every test starts from the old image and an empty secondary. */
+static void before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    zassert_ok(flash_area_erase(primary, 0, primary->fa_size));
+    zassert_ok(flash_area_erase(secondary, 0, secondary->fa_size));
+    zassert_ok(flash_area_write(primary, 0, oldImage, sizeof(oldImage)));
+}
+
+ZTEST(delta_dfu, test_apply_file) {
+    struct fs_file_t file;
+
+    // Written the way an mcumgr fs upload would leave it
+    fs_file_t_init(&file);
+    zassert_ok(fs_open(&file, PATCH_FILE, FS_O_CREATE | FS_O_WRITE));
+    zassert_ok(fs_truncate(&file, 0));
+    zassert_equal(fs_write(&file, patch, sizeof(patch)), static_cast<ssize_t>(sizeof(patch)));
+    zassert_ok(fs_close(&file));
+
+    zassert_ok(DeltaDfu::getInstance().applyFile(PATCH_FILE));
+    checkSecondary();
+}
+
+ZTEST(delta_dfu, test_apply_patch) {
+    zassert_ok(streamPatch(sizeof(patch)));
+    zassert_ok(DeltaDfu::getInstance().finish());
+    checkSecondary();
+}
+
+ZTEST(delta_dfu, test_stale_image) {
+    uint8_t tail[16];
+
+    // Another image in the primary slot, one bit off in its last byte
+    memcpy(tail, oldImage + sizeof(oldImage) - sizeof(tail), sizeof(tail));
+    tail[sizeof(tail) - 1] ^= 0x01;
+    zassert_ok(flash_area_erase(primary, 0, primary->fa_size));
+    zassert_ok(flash_area_write(primary, 0, oldImage, sizeof(oldImage) - sizeof(tail)));
+    zassert_ok(flash_area_write(primary, sizeof(oldImage) - sizeof(tail), tail, sizeof(tail)));
+
+    zassert_equal(streamPatch(sizeof(DeltaDfu::PatchHeader)), -ESTALE);
+    // Nothing more is taken after a failure
+    zassert_equal(DeltaDfu::getInstance().write(patch + sizeof(DeltaDfu::PatchHeader), 1), -EINVAL);
+}
+
+ZTEST(delta_dfu, test_truncated_patch) {
+    zassert_ok(streamPatch(sizeof(patch) - 1));
+    zassert_equal(DeltaDfu::getInstance().finish(), -ENODATA);
+}
+
+ZTEST_SUITE(delta_dfu, NULL, setup, before, NULL, NULL);
@@ -0,0 +1,84 @@
+// Standard modules
+#include <cstdlib>
+// Zephyr modules
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+// Custom drivers
+#include "our_drivers/emul_bme680.h"
+#include "our_drivers/our_bme680.h"
+
+/* The our,bme680 driver against the emulator on the native_sim i2c2. The emulator encodes the
+ * environment with its own calibration, the driver has to compensate it back within the resolution
+ * emul_bme680_set_env() documents.
+ */
+
+static const struct device *const bme680 = DEVICE_DT_GET(DT_NODELABEL(bme680));
+static const struct emul *const target   = EMUL_DT_GET(DT_NODELABEL(bme680));
+
+static int beforeFetch;
+
+static void checkReadings(int32_t temperature, uint32_t humidity, uint32_t pressure, uint32_t gas) {
+    struct our_bme680_readings readings;
+
+    zassert_ok(our_bme680_get_all(bme680, &readings));
+    zassert_within(readings.calc_temp, temperature, 1);
+    zassert_within(readings.calc_humidity, humidity, 4);
+    zassert_within(readings.calc_press, pressure, 2);
+    // The gas ADC has 10 bits per range
+    zassert_within(readings.calc_gas_resistance, gas, gas / 1000);
+}
+
+static void *setup(void) {
+    struct our_bme680_readings readings;
+
+    zassert_true(device_is_ready(bme680));
+    beforeFetch = our_bme680_get_all(bme680, &readings);
+    return NULL;
+}
+
+ZTEST(our_bme680, test_no_data_before_fetch) { zassert_equal(beforeFetch, -ENODATA); }
+
+ZTEST(our_bme680, test_chip_id) {
+    uint8_t chipId = 0;
+
+    zassert_ok(our_bme680_get_chip_id(bme680, &chipId));
+    zassert_equal(chipId, BME680_CHIP_ID);
+}
+
+ZTEST(our_bme680, test_compensated_readings) {
+    const struct {
+        int32_t temperature;
+        uint32_t humidity;
+        uint32_t pressure;
+        uint32_t gas;
+    } environments[] = {
+        {2150, 45000, 101325, 50000},
+        {-1500, 80000, 98000, 5000},
+        {3725, 12500, 110000, 300000},
+    };
+
+    for (const auto &env : environments) {
+        zassert_ok(emul_bme680_set_env(target, env.temperature, env.humidity, env.pressure, env.gas));
+        zassert_ok(sensor_sample_fetch(bme680));
+        checkReadings(env.temperature, env.humidity, env.pressure, env.gas);
+    }
+
+    // The standard channels carry the same values
+    struct sensor_value value;
+    zassert_ok(sensor_channel_get(bme680, SENSOR_CHAN_AMBIENT_TEMP, &value));
+    zassert_equal(value.val1, 37);
+    zassert_within(value.val2, 250000, 10000);
+}
+
+ZTEST(our_bme680, test_split_measurement) {
+    zassert_ok(emul_bme680_set_env(target, 2600, 55000, 100000, 120000));
+    zassert_ok(our_bme680_start_measurement(bme680));
+    k_msleep(BME680_MEAS_DUR_MS);
+    zassert_ok(our_bme680_finish_measurement(bme680));
+    checkReadings(2600, 55000, 100000, 120000);
+}
+
+ZTEST_SUITE(our_bme680, NULL, setup, NULL, NULL, NULL);
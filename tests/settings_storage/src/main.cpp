@@ -0,0 +1,63 @@
+// Standard modules
+#include <cstring>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/ztest.h>
+// App modules
+#include "settings_storage.h"
+
+using Services::SettingsStorage;
+
+/* SettingsStorage on the simulated flash, once per backend. The flash file may keep values from an
+ * earlier run, so every check writes its own values first.
+ */
+
+ZTEST(settings_storage, test_init_signals_waiters) {
+    SettingsStorage &settings = SettingsStorage::getInstance();
+
+    zassert_false(settings.isInitialized());
+    zassert_equal(settings.waitInitialized(K_NO_WAIT), -EAGAIN);
+
+    zassert_ok(settings.init());
+    zassert_true(settings.isInitialized());
+    zassert_ok(settings.waitInitialized(K_NO_WAIT));
+    zassert_str_equal(SettingsStorage::backendName(),
+                      IS_ENABLED(CONFIG_APP_SETTINGS_BACKEND_ZMS) ? "zms" : "nvs");
+}
+
+ZTEST(settings_storage, test_round_trip) {
+    SettingsStorage &settings = SettingsStorage::getInstance();
+    char first[]              = "apn_first";
+    char second[]             = "apn_second";
+    char pass[]               = "pass_round_trip";
+    char value[32];
+
+    if (!settings.isInitialized()) {
+        zassert_ok(settings.init());
+    }
+
+    zassert_ok(settings.SetKey(SettingsStorage::KEY_CELL_APN, first, sizeof(first)));
+    zassert_ok(settings.SetKey(SettingsStorage::KEY_CELL_PASS, pass, sizeof(pass)));
+    zassert_ok(settings_load());
+    zassert_ok(settings.GetKey(SettingsStorage::KEY_CELL_APN, value, sizeof(value)));
+    zassert_str_equal(value, first);
+    zassert_ok(settings.GetKey(SettingsStorage::KEY_CELL_PASS, value, sizeof(value)));
+    zassert_str_equal(value, pass);
+
+    // SetKey() only writes the flash, the value in use changes with the next load
+    zassert_ok(settings.SetKey(SettingsStorage::KEY_CELL_APN, second, sizeof(second)));
+    zassert_ok(settings.GetKey(SettingsStorage::KEY_CELL_APN, value, sizeof(value)));
+    zassert_str_equal(value, first);
+    zassert_ok(settings_load());
+    zassert_ok(settings.GetKey(SettingsStorage::KEY_CELL_APN, value, sizeof(value)));
+    zassert_str_equal(value, second);
+}
+
+ZTEST(settings_storage, test_unknown_key) {
+    char value[8];
+
+    zassert_equal(SettingsStorage::getInstance().GetKey("cell/imsi", value, sizeof(value)), -ENOENT);
+}
+
+ZTEST_SUITE(settings_storage, NULL, NULL, NULL, NULL, NULL);
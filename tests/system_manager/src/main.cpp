@@ -0,0 +1,100 @@
+// Standard modules
+#include <initializer_list>
+// Zephyr modules
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/ztest.h>
+// App modules
+#include "system_manager.h"
+
+using Services::SystemManager;
+using ServiceId = SystemManager::ServiceId;
+
+/* SystemManager with stand-in services that sleep, so helper threads can overlap them. Every init
+ * takes a tick when it starts and one when it returns, the ticks give the order the inits ran in.
+ */
+
+static constexpr int32_t INIT_MS = 20;
+
+static atomic_t ticks;
+static atomic_t startTick[SystemManager::SERVICE_COUNT];
+static atomic_t endTick[SystemManager::SERVICE_COUNT];
+
+template <ServiceId ID, int RESULT> static int fakeInit() {
+    atomic_set(&startTick[static_cast<size_t>(ID)], atomic_inc(&ticks) + 1);
+    k_msleep(INIT_MS);
+    atomic_set(&endTick[static_cast<size_t>(ID)], atomic_inc(&ticks) + 1);
+    return RESULT;
+}
+
+static atomic_val_t started(ServiceId id) { return atomic_get(&startTick[static_cast<size_t>(id)]); }
+static atomic_val_t ended(ServiceId id) { return atomic_get(&endTick[static_cast<size_t>(id)]); }
+
+/* Energy first, Led and Connectivity both after it, Settings after the failing Connectivity, Time
+ * after Led and Settings. Sensor depends on Uplink, which is not listed.
+ */
+static const SystemManager::Service services[] = {
+    {ServiceId::Time, "time", fakeInit<ServiceId::Time, 0>, SystemManager::after(ServiceId::Led, ServiceId::Settings)},
+    {ServiceId::Settings, "settings", fakeInit<ServiceId::Settings, 0>, SystemManager::after(ServiceId::Connectivity)},
+    {ServiceId::Connectivity, "connectivity", fakeInit<ServiceId::Connectivity, -EIO>,
+     SystemManager::after(ServiceId::Energy)},
+    {ServiceId::Led, "led", fakeInit<ServiceId::Led, 0>, SystemManager::after(ServiceId::Energy)},
+    {ServiceId::Energy, "energy", fakeInit<ServiceId::Energy, 0>, 0},
+    {ServiceId::Sensor, "sensor", fakeInit<ServiceId::Sensor, 0>, SystemManager::after(ServiceId::Uplink)},
+};
+
+static int failures;
+
+static void *initServices(void) {
+    failures = SystemManager::getInstance().init(services);
+    return NULL;
+}
+
+ZTEST(system_manager, test_results) {
+    const SystemManager &system = SystemManager::getInstance();
+
+    zassert_true(system.isInitialized());
+    zassert_equal(failures, 1);
+    zassert_equal(system.record(ServiceId::Connectivity).result, -EIO);
+    for (ServiceId id : {ServiceId::Energy, ServiceId::Led, ServiceId::Settings, ServiceId::Time, ServiceId::Sensor}) {
+        zassert_ok(system.record(id).result, "service %u", static_cast<unsigned int>(id));
+        zassert_true(system.record(id).durationUs >= (INIT_MS - 1) * USEC_PER_MSEC);
+    }
+    // Not listed, never run
+    zassert_equal(system.record(ServiceId::Uplink).result, -EINPROGRESS);
+    zassert_equal(started(ServiceId::Uplink), 0);
+}
+
+ZTEST(system_manager, test_dependency_order) {
+    zassert_true(started(ServiceId::Led) > ended(ServiceId::Energy));
+    zassert_true(started(ServiceId::Connectivity) > ended(ServiceId::Energy));
+    // A failed dependency still orders, it does not block
+    zassert_true(started(ServiceId::Settings) > ended(ServiceId::Connectivity));
+    zassert_true(started(ServiceId::Time) > ended(ServiceId::Led));
+    zassert_true(started(ServiceId::Time) > ended(ServiceId::Settings));
+
+    const SystemManager &system = SystemManager::getInstance();
+    zassert_true(system.record(ServiceId::Time).startUs >=
+                 system.record(ServiceId::Settings).startUs + system.record(ServiceId::Settings).durationUs);
+}
+
+ZTEST(system_manager, test_overlap) {
+#if CONFIG_APP_SYSTEM_INIT_THREADS > 0
+    // Led and Connectivity only wait for Energy, two threads run them side by side
+    zassert_true(started(ServiceId::Led) < ended(ServiceId::Connectivity));
+    zassert_true(started(ServiceId::Connectivity) < ended(ServiceId::Led));
+#else
+    // One at a time on the main thread
+    for (size_t i = 0; i < SystemManager::SERVICE_COUNT; i++) {
+        if (atomic_get(&startTick[i])) {
+            zassert_equal(atomic_get(&endTick[i]), atomic_get(&startTick[i]) + 1);
+        }
+    }
+#endif
+}
+
+ZTEST(system_manager, test_init_once) {
+    zassert_equal(SystemManager::getInstance().init(services), -EALREADY);
+}
+
+ZTEST_SUITE(system_manager, NULL, initServices, NULL, NULL, NULL);
@@ -0,0 +1,80 @@
+// Standard modules
+#include <cstdint>
+// Zephyr modules
+#include <zephyr/ztest.h>
+// App modules
+#include "uplink_policy.h"
+
+using Services::UplinkPolicy;
+using Services::LinkControl::QUALITY_UNKNOWN;
+
+/* UplinkPolicy fed signal traces with made-up timestamps, so the hold and release decisions are
+ * checked step by step without a modem and without waiting for the deadlines.
+ */
+
+static constexpr UplinkPolicy::Config CONFIG = {
+    .rsrpMin    = -110,
+    .rsrqMin    = -15,
+    .hysteresis = 3,
+    .maxDeferMs = 60000,
+};
+
+struct Step {
+    uint32_t nowMs;
+    int16_t rsrp;
+    int16_t rsrq;
+    bool urgent;
+    uint32_t remainingMs; // what evaluate() has to return
+};
+
+static void replay(UplinkPolicy &policy, const Step *trace, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const Step &step = trace[i];
+        uint32_t remainingMs = policy.evaluate(step.nowMs, {.rsrp = step.rsrp, .rsrq = step.rsrq}, step.urgent);
+
+        zassert_equal(remainingMs, step.remainingMs, "step %u at %u ms: %u ms", static_cast<unsigned int>(i),
+                      step.nowMs, remainingMs);
+        zassert_equal(policy.isDeferring(), step.remainingMs != 0, "step %u", static_cast<unsigned int>(i));
+    }
+}
+
+ZTEST(uplink_policy, test_trace) {
+    UplinkPolicy policy(CONFIG);
+    const Step trace[] = {
+        {0, -100, -10, false, 0},
+        // Weak RSRP, held back until 61 s
+        {1000, -115, -10, false, 60000},
+        {11000, -120, -18, false, 50000},
+        // Above the threshold but not by the hysteresis
+        {21000, -108, -10, false, 40000},
+        // Recovered by the hysteresis on both
+        {31000, -107, -12, false, 0},
+        // An urgent batch ends a new hold at once
+        {32000, -112, -10, false, 60000},
+        {33000, -112, -10, true, 0},
+        // Never past the deadline, however poor the signal stays
+        {34000, -112, QUALITY_UNKNOWN, false, 60000},
+        {64000, -125, -19, false, 30000},
+        {94000, -125, -19, false, 0},
+        // No measurement, nothing to wait for
+        {95000, QUALITY_UNKNOWN, QUALITY_UNKNOWN, false, 0},
+        // Weak RSRQ alone holds back, RSRP alone releases when RSRQ is unknown
+        {96000, -100, -17, false, 60000},
+        {97000, -100, QUALITY_UNKNOWN, false, 0},
+    };
+
+    replay(policy, trace, ARRAY_SIZE(trace));
+}
+
+ZTEST(uplink_policy, test_uptime_wrap) {
+    UplinkPolicy policy(CONFIG);
+    const Step trace[] = {
+        {UINT32_MAX - 999, -115, -10, false, 60000},
+        {9000, -115, -10, false, 50000},
+        {59000, -115, -10, false, 0},
+    };
+
+    replay(policy, trace, ARRAY_SIZE(trace));
+}
+
+ZTEST_SUITE(uplink_policy, NULL, NULL, NULL, NULL, NULL);